@@ -0,0 +1,55 @@
+#version 330 core
+
+// Caminho sem geometry shader: cada draw grava uma única face (uFaceIndex) do cubemap.
+layout (location = 0) in vec3 aPos;
+layout (location = 3) in mat4 aInstanceModel;
+// Decodificação do formato do mesh (GeometryPool::ApplyDecode): valores correntes, nunca arrays.
+layout (location = 8) in vec4 aPositionScale;
+layout (location = 9) in vec3 aPositionBias;
+layout (location = 7) in uint aInstanceIndex;
+
+layout (std140) uniform PointShadowData
+{
+    mat4 shadowMatrices[6];
+    vec3 lightPos;
+    float far_plane;
+};
+
+uniform mat4 model;
+// 0: uniform model, 1: atributo aInstanceModel, 2: aInstanceIndex no texture buffer estático.
+uniform int uUseInstanceTransform = 0;
+uniform samplerBuffer instanceTransforms;
+uniform int uFaceIndex = 0;
+
+out vec4 FragPos;
+
+// Matriz da instância no texture buffer estático: quatro colunas RGBA32F a partir de aInstanceIndex * 4.
+mat4 FetchInstanceTransform()
+{
+    int base = int(aInstanceIndex) * 4;
+    return mat4(texelFetch(instanceTransforms, base),
+                texelFetch(instanceTransforms, base + 1),
+                texelFetch(instanceTransforms, base + 2),
+                texelFetch(instanceTransforms, base + 3));
+}
+
+// Posição quantizada (SNORM16 na AABB do mesh) ou float com escala 1 e bias 0.
+vec3 DecodePosition()
+{
+    return aPos * aPositionScale.xyz + aPositionBias;
+}
+
+void main()
+{
+    mat4 finalModel = model;
+    if (uUseInstanceTransform == 1)
+    {
+        finalModel = aInstanceModel;
+    }
+    else if (uUseInstanceTransform == 2)
+    {
+        finalModel = FetchInstanceTransform();
+    }
+    FragPos = finalModel * vec4(DecodePosition(), 1.0);
+    gl_Position = shadowMatrices[uFaceIndex] * FragPos;
+}
@@ -2,8 +2,12 @@
 
 in vec4 FragPos;
 
-uniform vec3 lightPos;
-uniform float far_plane;
+layout (std140) uniform PointShadowData
+{
+    mat4 shadowMatrices[6];
+    vec3 lightPos;
+    float far_plane;
+};
 
 void main()
 {
@@ -3,7 +3,12 @@
 layout (triangles) in;
 layout (triangle_strip, max_vertices = 18) out;
 
-uniform mat4 shadowMatrices[6];
+layout (std140) uniform PointShadowData
+{
+    mat4 shadowMatrices[6];
+    vec3 lightPos;
+    float far_plane;
+};
 
 out vec4 FragPos;
 
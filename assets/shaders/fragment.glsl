@@ -1,12 +1,29 @@
 #version 330 core
 
+// Especialização por variante (ShaderVariantCache). Os padrões reproduzem o shader genérico:
+// número de luzes direcionais lido do UBO e todos os caminhos de luz/sombra ativos.
+#ifndef DIRECTIONAL_LIGHT_COUNT
+#define DIRECTIONAL_LIGHT_COUNT directionalCount
+#endif
+#ifndef DIRECTIONAL_SHADOWS
+#define DIRECTIONAL_SHADOWS 1
+#endif
+#ifndef POINT_LIGHTS
+#define POINT_LIGHTS 1
+#endif
+#ifndef POINT_SHADOW
+#define POINT_SHADOW 1
+#endif
+#ifndef GPU_DRIVEN
+#define GPU_DRIVEN 0
+#endif
+
 const int MAX_DIRECTIONAL_LIGHTS = 4;
-const int MAX_POINT_LIGHTS = 4;
+const int MAX_SHADOW_CASCADES = 4;
 
 in vec3 fragPos;
 in vec3 normal;
 in vec2 texCoord;
-in vec4 fragPosLightSpace;
 
 struct DirectionalLight {
     vec3 direction;
@@ -15,42 +32,100 @@ struct DirectionalLight {
     vec3 specular;
 };
 
+// Lida do texture buffer pointLightData: quatro texels RGBA por luz (PointLightStd140 no C++).
 struct PointLight {
     vec3 position;
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
     float constant;
+    vec3 ambient;
     float linear;
+    vec3 diffuse;
     float quadratic;
+    vec3 specular;
     float range;
 };
 
-struct Material {
+// Layouts espelhados em FrameUniformBlock, LightUniformBlock e MaterialUniformBlock (C++).
+layout (std140) uniform FrameData
+{
+    mat4 view;
+    mat4 projection;
+    mat4 cascadeMatrices[MAX_SHADOW_CASCADES];
+    vec4 cascadeSplits;
+    vec4 cascadeDepthScales;
+    vec3 viewPos;
+    int cascadeCount;
+};
+
+layout (std140) uniform LightData
+{
+    DirectionalLight dirLights[MAX_DIRECTIONAL_LIGHTS];
+    vec3 pointShadowLightPos;
+    float shadowFarPlane;
+    int directionalCount;
+    int pointCount;
+    int shadowPointIndex;
+    ivec4 clusterGrid;
+    vec4 clusterDepthParams;
+    vec2 clusterTileSize;
+};
+
+#if GPU_DRIVEN
+// Um multi-draw cobre vários materiais: os parâmetros chegam do SSBO via gpu_scene_vertex.glsl.
+flat in vec3 materialAmbient;
+flat in vec3 materialDiffuse;
+flat in vec4 materialSpecular;
+
+struct MaterialParams
+{
     vec3 ambient;
     vec3 diffuse;
     vec3 specular;
     float shininess;
 };
+// Mesmo acesso material.x do bloco MaterialData; o compilador descarta os campos não usados.
+#define material MaterialParams(materialAmbient, materialDiffuse, materialSpecular.xyz, materialSpecular.w)
+#else
+layout (std140) uniform MaterialData
+{
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+    float shininess;
+} material;
+#endif
 
-uniform int directionalCount;
-uniform int pointCount;
-uniform DirectionalLight dirLights[MAX_DIRECTIONAL_LIGHTS];
-uniform PointLight pointLights[MAX_POINT_LIGHTS];
-uniform Material material;
-uniform vec3 viewPos;
 uniform sampler2D textureSampler;
-uniform sampler2D shadowMap;
+uniform sampler2DArray shadowMap;
 uniform samplerCube pointShadowMap;
-uniform vec3 pointShadowLightPos;
-uniform float shadowFarPlane;
-uniform int shadowPointIndex;
+
+// Clustered forward (LightClusterGrid): dados das luzes, (offset, count) por cluster e lista de índices.
+uniform samplerBuffer pointLightData;
+uniform usamplerBuffer clusterRanges;
+uniform usamplerBuffer clusterLightIndices;
 
 layout (location = 0) out vec4 SceneColor;
 layout (location = 1) out vec4 HighlightColor;
 
-float CalculateDirectionalShadow(vec4 fragPosLS, vec3 norm, vec3 lightDir)
+// Primeira cascata cujo split (profundidade de vista) contém o fragmento; -1 além da última.
+int SelectShadowCascade(vec3 fragPosition)
 {
+    float viewDepth = -(view * vec4(fragPosition, 1.0)).z;
+    for (int i = 0; i < cascadeCount; ++i) {
+        if (viewDepth < cascadeSplits[i]) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+float CalculateDirectionalShadow(vec3 fragPosition, vec3 norm, vec3 lightDir)
+{
+    int cascade = SelectShadowCascade(fragPosition);
+    if (cascade < 0) {
+        return 0.0;
+    }
+
+    vec4 fragPosLS = cascadeMatrices[cascade] * vec4(fragPosition, 1.0);
     vec3 projCoords = fragPosLS.xyz / fragPosLS.w;
     projCoords = projCoords * 0.5 + 0.5;
 
@@ -58,12 +133,15 @@ float CalculateDirectionalShadow(vec4 fragPosLS, vec3 norm, vec3 lightDir)
         return 0.0;
     }
 
-    float bias = max(0.0005 * (1.0 - dot(norm, lightDir)), 0.00005);
+    // Bias definido em unidades de mundo; cada cascata tem seu próprio intervalo de depth.
+    float worldBias = max(0.03 * (1.0 - dot(norm, lightDir)), 0.003);
+    float bias = worldBias * cascadeDepthScales[cascade];
     float shadow = 0.0;
-    vec2 texelSize = 1.0 / textureSize(shadowMap, 0);
+    vec2 texelSize = 1.0 / vec2(textureSize(shadowMap, 0).xy);
+    float layer = float(cascade);
     for (int x = -1; x <= 1; ++x) {
         for (int y = -1; y <= 1; ++y) {
-            float closestDepth = texture(shadowMap, projCoords.xy + vec2(x, y) * texelSize).r;
+            float closestDepth = texture(shadowMap, vec3(projCoords.xy + vec2(x, y) * texelSize, layer)).r;
             float currentDepth = projCoords.z - bias;
             shadow += currentDepth > closestDepth ? 1.0 : 0.0;
         }
@@ -104,6 +182,36 @@ float CalculatePointShadow(vec3 fragPosition)
     return shadow;
 }
 
+PointLight FetchPointLight(int index)
+{
+    int base = index * 4;
+    vec4 texel0 = texelFetch(pointLightData, base);
+    vec4 texel1 = texelFetch(pointLightData, base + 1);
+    vec4 texel2 = texelFetch(pointLightData, base + 2);
+    vec4 texel3 = texelFetch(pointLightData, base + 3);
+
+    PointLight light;
+    light.position = texel0.xyz;
+    light.constant = texel0.w;
+    light.ambient = texel1.xyz;
+    light.linear = texel1.w;
+    light.diffuse = texel2.xyz;
+    light.quadratic = texel2.w;
+    light.specular = texel3.xyz;
+    light.range = texel3.w;
+    return light;
+}
+
+// Tile pela posição na tela, fatia pelo log da profundidade de vista (mesma divisão da CPU).
+int ComputeClusterIndex(vec3 fragPosition)
+{
+    float viewDepth = max(-(view * vec4(fragPosition, 1.0)).z, clusterDepthParams.z);
+    int slice = int(floor(log(viewDepth) * clusterDepthParams.x - clusterDepthParams.y));
+    slice = clamp(slice, 0, clusterGrid.z - 1);
+    ivec2 tile = clamp(ivec2(gl_FragCoord.xy / clusterTileSize), ivec2(0), clusterGrid.xy - 1);
+    return tile.x + clusterGrid.x * (tile.y + clusterGrid.y * slice);
+}
+
 vec3 EvaluateDirectionalLight(const DirectionalLight light, vec3 norm, vec3 viewDir, vec3 albedo, float visibility)
 {
     vec3 lightDir = normalize(-light.direction);
@@ -153,20 +261,31 @@ void main()
     albedo = pow(albedo, vec3(gamma));
 
     vec3 result = vec3(0.0f);
-    for (int i = 0; i < directionalCount; ++i) {
+    // Com contagem constante o laço é desenrolado e o teste i == 0 some.
+    for (int i = 0; i < DIRECTIONAL_LIGHT_COUNT; ++i) {
+#if DIRECTIONAL_SHADOWS
         vec3 lightDir = normalize(-dirLights[i].direction);
-        float visibility = (i == 0) ? (1.0f - CalculateDirectionalShadow(fragPosLightSpace, norm, lightDir)) : 1.0f;
+        float visibility = (i == 0) ? (1.0f - CalculateDirectionalShadow(fragPos, norm, lightDir)) : 1.0f;
+#else
+        float visibility = 1.0f;
+#endif
         result += EvaluateDirectionalLight(dirLights[i], norm, viewDir, albedo, visibility);
     }
 
-    for (int i = 0; i < pointCount; ++i) {
-        vec3 pointContribution = EvaluatePointLight(pointLights[i], norm, viewDir, fragPos, albedo);
-        if (shadowPointIndex >= 0 && i == shadowPointIndex) {
+#if POINT_LIGHTS
+    uvec2 range = texelFetch(clusterRanges, ComputeClusterIndex(fragPos)).xy;
+    for (uint i = 0u; i < range.y; ++i) {
+        int lightIndex = int(texelFetch(clusterLightIndices, int(range.x + i)).r);
+        vec3 pointContribution = EvaluatePointLight(FetchPointLight(lightIndex), norm, viewDir, fragPos, albedo);
+#if POINT_SHADOW
+        if (lightIndex == shadowPointIndex) {
             float shadow = CalculatePointShadow(fragPos);
             pointContribution *= (1.0 - shadow);
         }
+#endif
         result += pointContribution;
     }
+#endif
 
     result = max(result, vec3(0.0));
     vec3 gammaCorrected = pow(result, vec3(1.0 / gamma));
@@ -0,0 +1,100 @@
+#version 430 core
+
+// Culling GPU-driven (GpuDrivenScene): uma invocação por registro objeto x (LOD, mesh).
+// Registros visíveis ganham uma instância no comando indireto do mesh e gravam (objeto, mesh)
+// na faixa de instâncias do comando; o draw lê esse par como atributo por instância.
+layout (local_size_x = 64) in;
+
+struct ObjectData
+{
+    mat4 model;
+    vec4 boundingSphere; // centro em mundo (xyz) e raio (w)
+    uvec4 info;          // x: flags (bit 0 = dinâmico)
+};
+
+struct DrawRecord
+{
+    uint objectIndex;
+    uint commandIndex; // índice do mesh; o comando da visão é uCommandBase + commandIndex
+    float lodMinDistance; // LOD escolhido quando lodMinDistance < distância <= lodMaxDistance
+    float lodMaxDistance;
+};
+
+struct DrawCommand
+{
+    uint count;
+    uint instanceCount;
+    uint firstIndex;
+    int baseVertex;
+    uint baseInstance;
+};
+
+layout (std430, binding = 0) readonly buffer ObjectBuffer
+{
+    ObjectData objects[];
+};
+
+layout (std430, binding = 1) readonly buffer RecordBuffer
+{
+    DrawRecord records[];
+};
+
+layout (std430, binding = 2) buffer CommandBuffer
+{
+    DrawCommand commands[];
+};
+
+layout (std430, binding = 3) writeonly buffer VisibleBuffer
+{
+    uvec2 visible[];
+};
+
+const uint OBJECT_DYNAMIC = 1u;
+const uint CASTER_STATIC = 1u;
+const uint CASTER_DYNAMIC = 2u;
+
+uniform uint uRecordCount;
+uniform uint uCommandBase;
+// Mesmo volume do Frustum da CPU: planos com normal para dentro e esfera opcional (w < 0 desliga).
+uniform vec4 uPlanes[6];
+uniform int uPlaneCount;
+uniform vec4 uBoundingSphere;
+uniform vec3 uCameraPos;
+uniform uint uCasterMask;
+
+void main()
+{
+    uint recordIndex = gl_GlobalInvocationID.x;
+    if (recordIndex >= uRecordCount) {
+        return;
+    }
+
+    DrawRecord record = records[recordIndex];
+    vec4 sphere = objects[record.objectIndex].boundingSphere;
+    uint casterBit = (objects[record.objectIndex].info.x & OBJECT_DYNAMIC) != 0u ? CASTER_DYNAMIC : CASTER_STATIC;
+    if ((uCasterMask & casterBit) == 0u) {
+        return;
+    }
+
+    for (int i = 0; i < uPlaneCount; ++i) {
+        if (dot(uPlanes[i].xyz, sphere.xyz) + uPlanes[i].w < -sphere.w) {
+            return;
+        }
+    }
+    if (uBoundingSphere.w >= 0.0) {
+        vec3 offset = sphere.xyz - uBoundingSphere.xyz;
+        float reach = uBoundingSphere.w + sphere.w;
+        if (dot(offset, offset) > reach * reach) {
+            return;
+        }
+    }
+
+    float distance = length(sphere.xyz - uCameraPos);
+    if (distance <= record.lodMinDistance || distance > record.lodMaxDistance) {
+        return;
+    }
+
+    uint commandIndex = uCommandBase + record.commandIndex;
+    uint slot = atomicAdd(commands[commandIndex].instanceCount, 1u);
+    visible[commands[commandIndex].baseInstance + slot] = uvec2(record.objectIndex, record.commandIndex);
+}
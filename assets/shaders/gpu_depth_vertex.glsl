@@ -0,0 +1,67 @@
+#version 430 core
+
+// Depth GPU-driven: pré-passe da câmera ou, com CASCADE_DEPTH, uma cascata da luz direcional.
+// Lê o stream de posições do GeometryPool e aplica a decodificação do mesh (float ou quantizado).
+#ifndef CASCADE_DEPTH
+#define CASCADE_DEPTH 0
+#endif
+
+const int MAX_SHADOW_CASCADES = 4;
+
+layout (location = 0) in vec3 aPos;
+layout (location = 3) in uvec2 aDrawInfo;
+
+layout (std140) uniform FrameData
+{
+    mat4 view;
+    mat4 projection;
+    mat4 cascadeMatrices[MAX_SHADOW_CASCADES];
+    vec4 cascadeSplits;
+    vec4 cascadeDepthScales;
+    vec3 viewPos;
+    int cascadeCount;
+};
+
+struct ObjectData
+{
+    mat4 model;
+    vec4 boundingSphere;
+    uvec4 info;
+};
+
+layout (std430, binding = 0) readonly buffer ObjectBuffer
+{
+    ObjectData objects[];
+};
+
+struct MeshData
+{
+    vec4 positionScale; // VertexDecode: w = 1 indica normal octaédrica
+    vec4 positionBias;
+    uvec4 info;         // x: índice do material
+};
+
+layout (std430, binding = 5) readonly buffer MeshBuffer
+{
+    MeshData meshes[];
+};
+
+uniform int uCascadeIndex = 0;
+
+// Mesma expressão de gpu_scene_vertex.glsl: o teste GL_EQUAL da passada de cor depende de depth bit a bit igual.
+invariant gl_Position;
+
+vec3 DecodePosition(MeshData mesh)
+{
+    return aPos * mesh.positionScale.xyz + mesh.positionBias.xyz;
+}
+
+void main()
+{
+    vec4 worldPosition = objects[aDrawInfo.x].model * vec4(DecodePosition(meshes[aDrawInfo.y]), 1.0);
+#if CASCADE_DEPTH
+    gl_Position = cascadeMatrices[uCascadeIndex] * worldPosition;
+#else
+    gl_Position = projection * view * worldPosition;
+#endif
+}
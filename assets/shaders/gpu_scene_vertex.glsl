@@ -0,0 +1,108 @@
+#version 430 core
+
+// Passada de cor GPU-driven: matriz, decodificação do mesh e material vêm dos SSBOs, indexados pelo par
+// (objeto, mesh) que o compute de culling gravou para cada instância do comando indireto.
+// Os vértices são os do GeometryPool, no formato do mesh (float ou quantizado), decodificados como em vertex.glsl.
+const int MAX_SHADOW_CASCADES = 4;
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec4 aNormal;
+layout (location = 2) in vec2 aTexCoord;
+layout (location = 3) in uvec2 aDrawInfo;
+
+layout (std140) uniform FrameData
+{
+    mat4 view;
+    mat4 projection;
+    mat4 cascadeMatrices[MAX_SHADOW_CASCADES];
+    vec4 cascadeSplits;
+    vec4 cascadeDepthScales;
+    vec3 viewPos;
+    int cascadeCount;
+};
+
+struct ObjectData
+{
+    mat4 model;
+    vec4 boundingSphere;
+    uvec4 info;
+};
+
+struct MeshData
+{
+    vec4 positionScale; // VertexDecode: w = 1 indica normal octaédrica
+    vec4 positionBias;
+    uvec4 info;         // x: índice do material
+};
+
+struct MaterialData
+{
+    vec4 ambient;
+    vec4 diffuse;
+    vec4 specular; // w: shininess
+};
+
+layout (std430, binding = 0) readonly buffer ObjectBuffer
+{
+    ObjectData objects[];
+};
+
+layout (std430, binding = 4) readonly buffer MaterialBuffer
+{
+    MaterialData materials[];
+};
+
+layout (std430, binding = 5) readonly buffer MeshBuffer
+{
+    MeshData meshes[];
+};
+
+out vec3 fragPos;
+out vec3 normal;
+out vec2 texCoord;
+flat out vec3 materialAmbient;
+flat out vec3 materialDiffuse;
+flat out vec4 materialSpecular;
+
+// Compartilhado com gpu_depth_vertex.glsl (pré-passe de depth testado com GL_EQUAL).
+invariant gl_Position;
+
+// Mesma expressão de gpu_depth_vertex.glsl.
+vec3 DecodePosition(MeshData mesh)
+{
+    return aPos * mesh.positionScale.xyz + mesh.positionBias.xyz;
+}
+
+vec3 DecodeNormal(MeshData mesh)
+{
+    if (mesh.positionScale.w < 0.5)
+    {
+        return aNormal.xyz;
+    }
+    vec3 n = vec3(aNormal.xy, 1.0 - abs(aNormal.x) - abs(aNormal.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+
+void main()
+{
+    MeshData mesh = meshes[aDrawInfo.y];
+    mat4 finalModel = objects[aDrawInfo.x].model;
+    // Objetos e instâncias são TRS: inversa transposta = M * S^-2, como na variante instanciada de vertex.glsl.
+    mat3 linear = mat3(finalModel);
+    vec3 inverseScaleSq = 1.0 / vec3(dot(linear[0], linear[0]), dot(linear[1], linear[1]), dot(linear[2], linear[2]));
+    normal = normalize(linear * (DecodeNormal(mesh) * inverseScaleSq));
+
+    MaterialData material = materials[mesh.info.x];
+    materialAmbient = material.ambient.xyz;
+    materialDiffuse = material.diffuse.xyz;
+    materialSpecular = material.specular;
+
+    vec4 worldPosition = finalModel * vec4(DecodePosition(mesh), 1.0);
+    fragPos = worldPosition.xyz;
+
+    texCoord = aTexCoord;
+    gl_Position = projection * view * worldPosition;
+}
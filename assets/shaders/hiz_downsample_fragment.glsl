@@ -0,0 +1,35 @@
+#version 330 core
+
+// Redução por máximo da pirâmide Hi-Z: cada texel guarda a depth mais distante da área que cobre.
+// O último texel de cada eixo absorve a coluna/linha que sobra quando a origem tem tamanho ímpar.
+
+uniform sampler2D sourceDepth;
+uniform ivec2 uSourceSize;
+
+out float farthestDepth;
+
+void main()
+{
+    ivec2 target = ivec2(gl_FragCoord.xy);
+    ivec2 targetSize = max(uSourceSize / 2, ivec2(1));
+    ivec2 first = target * 2;
+    ivec2 last = min(first + ivec2(1), uSourceSize - 1);
+    if (target.x == targetSize.x - 1)
+    {
+        last.x = uSourceSize.x - 1;
+    }
+    if (target.y == targetSize.y - 1)
+    {
+        last.y = uSourceSize.y - 1;
+    }
+
+    float depth = 0.0;
+    for (int y = first.y; y <= last.y; ++y)
+    {
+        for (int x = first.x; x <= last.x; ++x)
+        {
+            depth = max(depth, texelFetch(sourceDepth, ivec2(x, y), 0).r);
+        }
+    }
+    farthestDepth = depth;
+}
@@ -0,0 +1,69 @@
+#version 330 core
+
+// Variantes (ShaderVariantCache) definem INSTANCED logo após #version; sem ela, draw não instanciado.
+#ifndef INSTANCED
+#define INSTANCED 0
+#endif
+// Com INSTANCED, matriz lida do texture buffer estático pelo índice da instância em vez do atributo.
+#ifndef INSTANCE_TRANSFORM_BUFFER
+#define INSTANCE_TRANSFORM_BUFFER 0
+#endif
+
+const int MAX_SHADOW_CASCADES = 4;
+
+layout (location = 0) in vec3 aPos;
+layout (location = 3) in mat4 aInstanceModel;
+// Decodificação do formato do mesh (GeometryPool::ApplyDecode): valores correntes, nunca arrays.
+layout (location = 8) in vec4 aPositionScale;
+layout (location = 9) in vec3 aPositionBias;
+
+layout (std140) uniform FrameData
+{
+    mat4 view;
+    mat4 projection;
+    mat4 cascadeMatrices[MAX_SHADOW_CASCADES];
+    vec4 cascadeSplits;
+    vec4 cascadeDepthScales;
+    vec3 viewPos;
+    int cascadeCount;
+};
+
+uniform mat4 model;
+
+// Mesma expressão de vertex.glsl: o teste GL_EQUAL da passada de cor depende de depth bit a bit igual.
+invariant gl_Position;
+
+#if INSTANCE_TRANSFORM_BUFFER
+layout (location = 7) in uint aInstanceIndex;
+uniform samplerBuffer instanceTransforms;
+
+// Matriz da instância no texture buffer estático: quatro colunas RGBA32F a partir de aInstanceIndex * 4.
+mat4 FetchInstanceTransform()
+{
+    int base = int(aInstanceIndex) * 4;
+    return mat4(texelFetch(instanceTransforms, base),
+                texelFetch(instanceTransforms, base + 1),
+                texelFetch(instanceTransforms, base + 2),
+                texelFetch(instanceTransforms, base + 3));
+}
+#endif
+
+// Posição quantizada (SNORM16 na AABB do mesh) ou float com escala 1 e bias 0.
+vec3 DecodePosition()
+{
+    return aPos * aPositionScale.xyz + aPositionBias;
+}
+
+void main()
+{
+#if INSTANCED && INSTANCE_TRANSFORM_BUFFER
+    mat4 finalModel = FetchInstanceTransform();
+#elif INSTANCED
+    mat4 finalModel = aInstanceModel;
+#else
+    mat4 finalModel = model;
+#endif
+
+    vec4 worldPosition = finalModel * vec4(DecodePosition(), 1.0);
+    gl_Position = projection * view * worldPosition;
+}
@@ -1,39 +1,104 @@
 #version 330 core
 
+// Variantes (ShaderVariantCache) definem INSTANCED logo após #version; sem ela, draw não instanciado.
+#ifndef INSTANCED
+#define INSTANCED 0
+#endif
+// Com INSTANCED, matriz lida do texture buffer estático pelo índice da instância em vez do atributo.
+#ifndef INSTANCE_TRANSFORM_BUFFER
+#define INSTANCE_TRANSFORM_BUFFER 0
+#endif
+
+const int MAX_SHADOW_CASCADES = 4;
+
 // Atributos do modelo importado
 layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec3 aNormal;
+layout (location = 1) in vec4 aNormal;
 layout (location = 2) in vec2 aTexCoord;
 layout (location = 3) in mat4 aInstanceModel;
+// Decodificação do formato do mesh (GeometryPool::ApplyDecode): valores correntes, nunca arrays.
+layout (location = 8) in vec4 aPositionScale;
+layout (location = 9) in vec3 aPositionBias;
 
-// Matrizes de transformação
+// Dados por frame (UBO std140, binding 0)
+layout (std140) uniform FrameData
+{
+    mat4 view;
+    mat4 projection;
+    mat4 cascadeMatrices[MAX_SHADOW_CASCADES];
+    vec4 cascadeSplits;
+    vec4 cascadeDepthScales;
+    vec3 viewPos;
+    int cascadeCount;
+};
+
+// Matriz do objeto e inversa transposta calculada na CPU (variante não instanciada)
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
-uniform mat4 lightSpaceMatrix;
-uniform int uUseInstanceTransform = 0;
+uniform mat3 normalMatrix;
 
 // Dados enviados ao fragment shader
 out vec3 fragPos;
 out vec3 normal;
 out vec2 texCoord;
-out vec4 fragPosLightSpace;
 
-void main()
+// Compartilhado com scene_depth_vertex.glsl (pré-passe de depth testado com GL_EQUAL).
+invariant gl_Position;
+
+#if INSTANCE_TRANSFORM_BUFFER
+layout (location = 7) in uint aInstanceIndex;
+uniform samplerBuffer instanceTransforms;
+
+// Matriz da instância no texture buffer estático: quatro colunas RGBA32F a partir de aInstanceIndex * 4.
+mat4 FetchInstanceTransform()
 {
-    mat4 finalModel = model;
-    if (uUseInstanceTransform == 1)
+    int base = int(aInstanceIndex) * 4;
+    return mat4(texelFetch(instanceTransforms, base),
+                texelFetch(instanceTransforms, base + 1),
+                texelFetch(instanceTransforms, base + 2),
+                texelFetch(instanceTransforms, base + 3));
+}
+#endif
+
+// Posição quantizada (SNORM16 na AABB do mesh) ou float com escala 1 e bias 0.
+vec3 DecodePosition()
+{
+    return aPos * aPositionScale.xyz + aPositionBias;
+}
+
+// aPositionScale.w = 1: normal octaédrica em xy (2_10_10_10 normalizado); senão vetor float em xyz.
+vec3 DecodeNormal()
+{
+    if (aPositionScale.w < 0.5)
     {
-        finalModel = aInstanceModel;
+        return aNormal.xyz;
     }
+    vec3 n = vec3(aNormal.xy, 1.0 - abs(aNormal.x) - abs(aNormal.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
 
-    vec4 worldPosition = finalModel * vec4(aPos, 1.0);
-    fragPos = worldPosition.xyz;
+void main()
+{
+#if INSTANCED
+#if INSTANCE_TRANSFORM_BUFFER
+    mat4 finalModel = FetchInstanceTransform();
+#else
+    mat4 finalModel = aInstanceModel;
+#endif
+    // Instâncias são TRS (colunas ortogonais): inversa transposta = M * S^-2, com S^2 das colunas.
+    mat3 linear = mat3(finalModel);
+    vec3 inverseScaleSq = 1.0 / vec3(dot(linear[0], linear[0]), dot(linear[1], linear[1]), dot(linear[2], linear[2]));
+    normal = normalize(linear * (DecodeNormal() * inverseScaleSq));
+#else
+    mat4 finalModel = model;
+    normal = normalize(normalMatrix * DecodeNormal());
+#endif
 
-    // Transformação correta das normais (sem translação)
-    normal = normalize(mat3(transpose(inverse(finalModel))) * aNormal);
+    vec4 worldPosition = finalModel * vec4(DecodePosition(), 1.0);
+    fragPos = worldPosition.xyz;
 
     texCoord = aTexCoord;
-    fragPosLightSpace = lightSpaceMatrix * worldPosition;
     gl_Position = projection * view * worldPosition;
 }
@@ -115,3 +115,41 @@ project "CursoOpenGL"
 
     filter {}
 
+
+project "OcclusionTests"
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++17"
+    staticruntime "On"
+
+    targetdir "build/bin/%{cfg.buildcfg}"
+    objdir "build/obj/%{cfg.buildcfg}/%{prj.name}"
+
+    files {
+        "tests/occlusion_rasterizer_tests.cpp",
+        "src/occlusion_rasterizer.cpp"
+    }
+
+    includedirs {
+        "src",
+        "vendor/glm"
+    }
+
+project "InstanceCullingBenchmark"
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++17"
+    staticruntime "On"
+
+    targetdir "build/bin/%{cfg.buildcfg}"
+    objdir "build/obj/%{cfg.buildcfg}/%{prj.name}"
+
+    files {
+        "benchmarks/instance_culling_benchmark.cpp",
+        "src/frustum.cpp"
+    }
+
+    includedirs {
+        "src",
+        "vendor/glm"
+    }
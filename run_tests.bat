@@ -0,0 +1,2 @@
+@echo off
+.\build\bin\Debug\OcclusionTests.exe
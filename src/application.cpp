@@ -1,5 +1,7 @@
 #include "application.h"
 
+#include "geometry_pool.h"
+
 #include <iostream>
 #include <cstring>
 
@@ -114,6 +116,10 @@ bool Application::Initialize()
     m_inputController.AttachWindow(m_window);
 
     m_rendererController.Initialize(&m_renderer);
+    std::cout << "Atalhos:" << std::endl;
+    m_rendererController.PrintShortcuts();
+    std::cout << "  F4     debug de colisão\n"
+              << "  F5     recarregar a cena" << std::endl;
     m_lastFrame = static_cast<float>(glfwGetTime());
 
     return true;
@@ -123,6 +129,8 @@ void Application::Shutdown()
 {
     m_physicsSystem.Shutdown();
     m_renderer.Shutdown();
+    // Meshes da cena ainda vivos só devolvem faixas às listas; os buffers saem enquanto há contexto.
+    GeometryPool::Get().Destroy();
 
     if (m_window)
     {
@@ -0,0 +1,182 @@
+#include "asset_cache.h"
+
+#include "content_hash.h"
+#include "model.h"
+#include "texture.h"
+
+#include <filesystem>
+#include <iomanip>
+#include <sstream>
+#include <system_error>
+
+namespace
+{
+std::string MakeContentKey(const char* prefix, const unsigned char* data, std::size_t size)
+{
+    std::ostringstream key;
+    key << prefix << std::hex << std::setw(16) << std::setfill('0') << HashBytes(data, size) << ":" << std::dec << size;
+    return key.str();
+}
+
+template <typename T>
+std::size_t CountLive(const std::unordered_map<std::string, std::weak_ptr<T>>& entries)
+{
+    std::size_t live = 0;
+    for (const auto& entry : entries)
+    {
+        live += entry.second.expired() ? 0 : 1;
+    }
+    return live;
+}
+}
+
+std::string CanonicalAssetPath(const std::string& path)
+{
+    std::error_code error;
+    std::filesystem::path resolved = std::filesystem::weakly_canonical(std::filesystem::absolute(path, error), error);
+    if (error)
+    {
+        resolved = std::filesystem::path(path).lexically_normal();
+    }
+    return resolved.generic_string();
+}
+
+TextureCache& TextureCache::Get()
+{
+    static TextureCache cache;
+    return cache;
+}
+
+std::shared_ptr<Texture> TextureCache::LoadFromFile(const std::string& path)
+{
+    const std::string key = "file:" + CanonicalAssetPath(path);
+    if (std::shared_ptr<Texture> cached = Find(key))
+    {
+        return cached;
+    }
+    auto texture = std::make_unique<Texture>();
+    if (!texture->LoadFromFile(path))
+    {
+        return nullptr;
+    }
+    return Insert(key, std::move(texture));
+}
+
+std::shared_ptr<Texture> TextureCache::LoadFromMemory(const unsigned char* data, std::size_t size)
+{
+    const std::string key = MakeContentKey("memory:", data, size);
+    if (std::shared_ptr<Texture> cached = Find(key))
+    {
+        return cached;
+    }
+    auto texture = std::make_unique<Texture>();
+    if (!texture->LoadFromMemory(data, size))
+    {
+        return nullptr;
+    }
+    return Insert(key, std::move(texture));
+}
+
+std::shared_ptr<Texture> TextureCache::LoadFromRawData(const unsigned char* data, int width, int height, int channels)
+{
+    const std::size_t size = static_cast<std::size_t>(width) * static_cast<std::size_t>(height) * static_cast<std::size_t>(channels);
+    const std::string key = MakeContentKey("raw:", data, size) + ":" + std::to_string(width) + "x" + std::to_string(height);
+    if (std::shared_ptr<Texture> cached = Find(key))
+    {
+        return cached;
+    }
+    auto texture = std::make_unique<Texture>();
+    if (!texture->LoadFromRawData(data, width, height, channels))
+    {
+        return nullptr;
+    }
+    return Insert(key, std::move(texture));
+}
+
+std::size_t TextureCache::GetLiveCount() const
+{
+    return CountLive(m_entries);
+}
+
+std::size_t TextureCache::EstimateGpuBytes(const Texture& texture)
+{
+    const std::size_t baseLevel = static_cast<std::size_t>(texture.GetWidth()) *
+                                  static_cast<std::size_t>(texture.GetHeight()) *
+                                  static_cast<std::size_t>(texture.GetChannels());
+    // Os mipmaps somam cerca de um terço do nível base.
+    return baseLevel + baseLevel / 3;
+}
+
+std::shared_ptr<Texture> TextureCache::Find(const std::string& key)
+{
+    const auto found = m_entries.find(key);
+    if (found != m_entries.end())
+    {
+        if (std::shared_ptr<Texture> texture = found->second.lock())
+        {
+            ++m_stats.hits;
+            m_stats.bytesSaved += EstimateGpuBytes(*texture);
+            return texture;
+        }
+    }
+    ++m_stats.misses;
+    return nullptr;
+}
+
+std::shared_ptr<Texture> TextureCache::Insert(const std::string& key, std::unique_ptr<Texture> texture)
+{
+    std::shared_ptr<Texture> shared(std::move(texture));
+    m_entries[key] = shared;
+    return shared;
+}
+
+ModelCache& ModelCache::Get()
+{
+    static ModelCache cache;
+    return cache;
+}
+
+std::shared_ptr<Model> ModelCache::Load(const std::string& path, const std::vector<std::string>& allowedNodes)
+{
+    std::string key = CanonicalAssetPath(path);
+    for (const std::string& node : allowedNodes)
+    {
+        key += '\n';
+        key += node;
+    }
+
+    const auto found = m_entries.find(key);
+    if (found != m_entries.end())
+    {
+        if (std::shared_ptr<Model> model = found->second.lock())
+        {
+            ++m_stats.hits;
+            m_stats.bytesSaved += EstimateGpuBytes(*model);
+            return model;
+        }
+    }
+    ++m_stats.misses;
+
+    auto model = std::make_shared<Model>();
+    if (!model->LoadFromFile(path, allowedNodes) || !model->HasMeshes())
+    {
+        return nullptr;
+    }
+    m_entries[key] = model;
+    return model;
+}
+
+std::size_t ModelCache::GetLiveCount() const
+{
+    return CountLive(m_entries);
+}
+
+std::size_t ModelCache::EstimateGpuBytes(const Model& model)
+{
+    std::size_t bytes = model.GetQuantizationReport().packedBytes;
+    for (const std::shared_ptr<Texture>& texture : model.GetTextures())
+    {
+        bytes += TextureCache::EstimateGpuBytes(*texture);
+    }
+    return bytes;
+}
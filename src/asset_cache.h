@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Model;
+class Texture;
+
+struct AssetCacheStats
+{
+    std::size_t hits = 0;
+    std::size_t misses = 0;
+    std::size_t bytesSaved = 0; ///< Memória de GPU que cada acerto deixou de alocar (estimada).
+};
+
+/// @brief Registro compartilhado de texturas: uma cópia na GPU por arquivo (caminho canônico) ou por conteúdo
+/// (hash dos bytes embutidos). Guarda só weak_ptr: a textura vive enquanto algum modelo ou cena a segura.
+/// Como o GeometryPool, é global; falhas de carga não entram no cache.
+class TextureCache
+{
+public:
+    static TextureCache& Get();
+
+    TextureCache(const TextureCache&) = delete;
+    TextureCache& operator=(const TextureCache&) = delete;
+
+    std::shared_ptr<Texture> LoadFromFile(const std::string& path);
+    /// @brief Imagem codificada (PNG/JPEG) em memória, como Texture::LoadFromMemory.
+    std::shared_ptr<Texture> LoadFromMemory(const unsigned char* data, std::size_t size);
+    /// @brief Texels já decodificados, como Texture::LoadFromRawData.
+    std::shared_ptr<Texture> LoadFromRawData(const unsigned char* data, int width, int height, int channels);
+
+    const AssetCacheStats& GetStats() const { return m_stats; }
+    std::size_t GetLiveCount() const;
+
+    /// @brief Bytes da textura na GPU com a cadeia de mipmaps.
+    static std::size_t EstimateGpuBytes(const Texture& texture);
+
+private:
+    TextureCache() = default;
+
+    std::shared_ptr<Texture> Find(const std::string& key);
+    std::shared_ptr<Texture> Insert(const std::string& key, std::unique_ptr<Texture> texture);
+
+    std::unordered_map<std::string, std::weak_ptr<Texture>> m_entries;
+    AssetCacheStats m_stats{};
+};
+
+/// @brief Registro compartilhado de modelos importados por arquivo, chaveado pelo caminho canônico e pelo
+/// filtro de nós: quem pede o mesmo asset recebe o mesmo Model (meshes no pool e texturas uma vez só).
+/// Materiais também são compartilhados; ajustes feitos por um dono valem para todos.
+class ModelCache
+{
+public:
+    static ModelCache& Get();
+
+    ModelCache(const ModelCache&) = delete;
+    ModelCache& operator=(const ModelCache&) = delete;
+
+    /// @brief nullptr se o modelo não carregou ou não tem meshes.
+    std::shared_ptr<Model> Load(const std::string& path, const std::vector<std::string>& allowedNodes = {});
+
+    const AssetCacheStats& GetStats() const { return m_stats; }
+    std::size_t GetLiveCount() const;
+
+    /// @brief Geometria no pool mais as texturas que o modelo referencia.
+    static std::size_t EstimateGpuBytes(const Model& model);
+
+private:
+    ModelCache() = default;
+
+    std::unordered_map<std::string, std::weak_ptr<Model>> m_entries;
+    AssetCacheStats m_stats{};
+};
+
+/// @brief Caminho normalizado para chave de cache (absoluto, sem "." e "..", separador '/').
+std::string CanonicalAssetPath(const std::string& path);
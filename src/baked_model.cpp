@@ -0,0 +1,422 @@
+#include "baked_model.h"
+
+#include "content_hash.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <system_error>
+#include <type_traits>
+#include <unordered_map>
+
+namespace
+{
+constexpr char kMagic[8] = { 'C', 'G', 'L', 'B', 'A', 'K', 'E', '\0' };
+constexpr std::size_t kBlobAlignment = 16;
+
+// Layout em disco: nativo (little-endian, mesmo compilador). Mudou o struct, muda kVersion.
+struct FileHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t meshCount;
+    std::uint64_t optionsHash;
+    std::uint64_t fileSize;
+    std::uint64_t dependencyTableOffset;
+    std::uint32_t dependencyCount;
+    std::uint32_t hasBounds;
+    float aabbMin[3];
+    float aabbMax[3];
+};
+
+/// O fonte é sempre a dependência 0.
+struct FileDependencyRecord
+{
+    std::uint64_t size;
+    std::int64_t writeTime;
+    std::uint64_t hash;
+    std::uint64_t pathOffset;
+    std::uint64_t pathSize;
+};
+
+struct FileMeshRecord
+{
+    std::uint32_t format;
+    std::uint32_t indexType;
+    std::uint32_t vertexCount;
+    std::uint32_t indexCount;
+    float decodeScale[4];
+    float decodeBias[4];
+    std::uint64_t vertexBlobOffset;
+    std::uint64_t positionBlobOffset;
+    std::uint64_t indexBlobOffset;
+    float ambient[4];
+    float diffuse[4];
+    float specular[4];
+    float shininess;
+    std::uint32_t textureKind;
+    std::int32_t textureWidth;
+    std::int32_t textureHeight;
+    std::uint64_t textureOffset;
+    std::uint64_t textureSize;
+};
+
+static_assert(std::is_trivially_copyable<FileHeader>::value, "FileHeader é copiado byte a byte");
+static_assert(std::is_trivially_copyable<FileMeshRecord>::value, "FileMeshRecord é copiado byte a byte");
+static_assert(std::is_trivially_copyable<FileDependencyRecord>::value, "FileDependencyRecord é copiado byte a byte");
+
+void StoreVec3(const glm::vec3& value, float* out)
+{
+    out[0] = value.x;
+    out[1] = value.y;
+    out[2] = value.z;
+}
+
+template <typename T>
+std::uint64_t HashValue(const T& value, std::uint64_t hash)
+{
+    return HashBytes(&value, sizeof(T), hash);
+}
+
+std::size_t VertexStride(VertexFormat format)
+{
+    return format == VertexFormat::Quantized ? sizeof(PackedVertex) : sizeof(Vertex);
+}
+
+std::size_t PositionStride(VertexFormat format)
+{
+    return format == VertexFormat::Quantized ? sizeof(PackedPosition) : sizeof(glm::vec3);
+}
+
+std::size_t IndexSize(GLenum indexType)
+{
+    return indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+}
+
+bool HashFile(const std::string& path, std::uint64_t& hash)
+{
+    MappedFile file;
+    if (!file.Open(path))
+    {
+        return false;
+    }
+    hash = HashBytes(file.GetData(), file.GetSize());
+    return true;
+}
+
+/// Tamanho e data de modificação: a checagem barata feita antes de reler o arquivo.
+bool StatFile(const std::string& path, std::uint64_t& size, std::int64_t& writeTime)
+{
+    std::error_code error;
+    const std::uintmax_t fileSize = std::filesystem::file_size(path, error);
+    if (error)
+    {
+        return false;
+    }
+    const std::filesystem::file_time_type time = std::filesystem::last_write_time(path, error);
+    if (error)
+    {
+        return false;
+    }
+    size = static_cast<std::uint64_t>(fileSize);
+    writeTime = static_cast<std::int64_t>(time.time_since_epoch().count());
+    return true;
+}
+
+/// Confere uma dependência gravada: mesmo tamanho e data valem como intacta; data diferente refaz o hash.
+bool IsDependencyCurrent(const std::string& path, const FileDependencyRecord& record)
+{
+    std::uint64_t size = 0;
+    std::int64_t writeTime = 0;
+    if (!StatFile(path, size, writeTime) || size != record.size)
+    {
+        return false;
+    }
+    if (writeTime == record.writeTime)
+    {
+        return true;
+    }
+    std::uint64_t hash = 0;
+    return HashFile(path, hash) && hash == record.hash;
+}
+
+class BlobWriter
+{
+public:
+    std::uint64_t Append(const void* data, std::size_t size)
+    {
+        m_bytes.resize((m_bytes.size() + kBlobAlignment - 1) / kBlobAlignment * kBlobAlignment, 0);
+        const std::uint64_t offset = m_bytes.size();
+        if (size > 0)
+        {
+            const unsigned char* bytes = static_cast<const unsigned char*>(data);
+            m_bytes.insert(m_bytes.end(), bytes, bytes + size);
+        }
+        return offset;
+    }
+
+    void Patch(std::uint64_t offset, const void* data, std::size_t size)
+    {
+        std::memcpy(m_bytes.data() + offset, data, size);
+    }
+
+    const std::vector<unsigned char>& GetBytes() const { return m_bytes; }
+
+private:
+    std::vector<unsigned char> m_bytes;
+};
+}
+
+BakedModelKey BakedModelFile::MakeKey(const std::string& sourcePath,
+                                      unsigned int importFlags,
+                                      const std::vector<std::string>& allowedNodes)
+{
+    BakedModelKey key;
+    key.sourcePath = sourcePath;
+
+    std::uint64_t options = HashValue(kVersion, kContentHashSeed);
+    options = HashValue(importFlags, options);
+    options = HashValue(static_cast<std::uint32_t>(sizeof(Vertex)), options);
+    options = HashValue(static_cast<std::uint32_t>(sizeof(PackedVertex)), options);
+    for (const std::string& node : allowedNodes)
+    {
+        options = HashBytes(node.c_str(), node.size() + 1, options);
+    }
+    key.optionsHash = options;
+
+    std::ostringstream path;
+    path << sourcePath << "." << std::hex << std::setw(8) << std::setfill('0')
+         << static_cast<std::uint32_t>(options & 0xFFFFFFFFu) << ".bake";
+    key.cachePath = path.str();
+    return key;
+}
+
+bool BakedModelFile::Write(const BakedModelKey& key, const BakedModelData& data)
+{
+    BlobWriter writer;
+    FileHeader header{};
+    const std::uint64_t headerOffset = writer.Append(&header, sizeof(header));
+    std::vector<FileMeshRecord> records(data.meshes.size());
+    const std::uint64_t tableOffset = writer.Append(records.data(), records.size() * sizeof(FileMeshRecord));
+    std::unordered_map<const unsigned char*, std::uint64_t> textureOffsets;
+
+    // Fonte primeiro, depois cada dependência uma vez; todas precisam estar legíveis agora.
+    std::vector<std::string> dependencyPaths{ key.sourcePath };
+    for (const std::string& dependency : data.dependencies)
+    {
+        const std::string normalized = std::filesystem::path(dependency).lexically_normal().generic_string();
+        if (std::find(dependencyPaths.begin(), dependencyPaths.end(), normalized) == dependencyPaths.end() &&
+            normalized != std::filesystem::path(key.sourcePath).lexically_normal().generic_string())
+        {
+            dependencyPaths.push_back(normalized);
+        }
+    }
+    std::vector<FileDependencyRecord> dependencies(dependencyPaths.size());
+    const std::uint64_t dependencyTableOffset =
+        writer.Append(dependencies.data(), dependencies.size() * sizeof(FileDependencyRecord));
+    for (std::size_t i = 0; i < dependencyPaths.size(); ++i)
+    {
+        const std::string& path = dependencyPaths[i];
+        FileDependencyRecord& dependency = dependencies[i];
+        if (!StatFile(path, dependency.size, dependency.writeTime) || !HashFile(path, dependency.hash))
+        {
+            std::cerr << "Dependência ilegível, cache de modelo não gravado: " << path << std::endl;
+            return false;
+        }
+        dependency.pathOffset = writer.Append(path.data(), path.size());
+        dependency.pathSize = path.size();
+    }
+
+    for (std::size_t i = 0; i < data.meshes.size(); ++i)
+    {
+        const BakedMesh& mesh = data.meshes[i];
+        FileMeshRecord& record = records[i];
+        record.format = static_cast<std::uint32_t>(mesh.format);
+        record.indexType = mesh.indexType;
+        record.vertexCount = mesh.vertexCount;
+        record.indexCount = mesh.indexCount;
+        StoreVec3(glm::vec3(mesh.decode.positionScale), record.decodeScale);
+        record.decodeScale[3] = mesh.decode.positionScale.w;
+        StoreVec3(mesh.decode.positionBias, record.decodeBias);
+
+        record.vertexBlobOffset = writer.Append(mesh.vertexBlob, mesh.vertexCount * VertexStride(mesh.format));
+        record.positionBlobOffset = writer.Append(mesh.positionBlob, mesh.vertexCount * PositionStride(mesh.format));
+        record.indexBlobOffset = writer.Append(mesh.indexBlob, mesh.indexCount * IndexSize(mesh.indexType));
+
+        StoreVec3(mesh.ambient, record.ambient);
+        StoreVec3(mesh.diffuse, record.diffuse);
+        StoreVec3(mesh.specular, record.specular);
+        record.shininess = mesh.shininess;
+        record.textureKind = static_cast<std::uint32_t>(mesh.texture.kind);
+        record.textureWidth = mesh.texture.width;
+        record.textureHeight = mesh.texture.height;
+        // Materiais que dividem a textura apontam para o mesmo blob; a leitura cria uma textura só.
+        auto texture = textureOffsets.find(mesh.texture.data);
+        if (texture == textureOffsets.end())
+        {
+            texture = textureOffsets.emplace(mesh.texture.data, writer.Append(mesh.texture.data, mesh.texture.size)).first;
+        }
+        record.textureOffset = texture->second;
+        record.textureSize = mesh.texture.size;
+    }
+
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.meshCount = static_cast<std::uint32_t>(data.meshes.size());
+    header.optionsHash = key.optionsHash;
+    header.fileSize = writer.GetBytes().size();
+    header.dependencyTableOffset = dependencyTableOffset;
+    header.dependencyCount = static_cast<std::uint32_t>(dependencies.size());
+    StoreVec3(data.aabbMin, header.aabbMin);
+    StoreVec3(data.aabbMax, header.aabbMax);
+    header.hasBounds = data.hasBounds ? 1u : 0u;
+    writer.Patch(headerOffset, &header, sizeof(header));
+    writer.Patch(tableOffset, records.data(), records.size() * sizeof(FileMeshRecord));
+    writer.Patch(dependencyTableOffset, dependencies.data(), dependencies.size() * sizeof(FileDependencyRecord));
+
+    // Grava num temporário e troca: um bake cortado no meio nunca fica com o nome válido.
+    const std::string temporaryPath = key.cachePath + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            std::cerr << "Não foi possível gravar o cache de modelo " << temporaryPath << std::endl;
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(writer.GetBytes().data()),
+                   static_cast<std::streamsize>(writer.GetBytes().size()));
+        if (!file)
+        {
+            std::cerr << "Falha ao gravar o cache de modelo " << temporaryPath << std::endl;
+            std::remove(temporaryPath.c_str());
+            return false;
+        }
+    }
+    std::remove(key.cachePath.c_str());
+    if (std::rename(temporaryPath.c_str(), key.cachePath.c_str()) != 0)
+    {
+        std::cerr << "Falha ao publicar o cache de modelo " << key.cachePath << std::endl;
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool BakedModelFile::Open(const BakedModelKey& key)
+{
+    Close();
+    if (!m_file.Open(key.cachePath))
+    {
+        return false;
+    }
+
+    const unsigned char* base = m_file.GetData();
+    const std::size_t fileSize = m_file.GetSize();
+    FileHeader header{};
+    if (fileSize < sizeof(FileHeader))
+    {
+        Close();
+        return false;
+    }
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion ||
+        header.optionsHash != key.optionsHash || header.fileSize != fileSize || header.dependencyCount == 0)
+    {
+        Close();
+        return false;
+    }
+
+    // Toda faixa precisa caber no arquivo e respeitar o alinhamento dos blobs.
+    auto inRange = [fileSize](std::uint64_t offset, std::uint64_t size) {
+        return offset % kBlobAlignment == 0 && offset <= fileSize && size <= fileSize - offset;
+    };
+    const std::uint64_t tableOffset = (sizeof(FileHeader) + kBlobAlignment - 1) / kBlobAlignment * kBlobAlignment;
+    const std::uint64_t tableSize = static_cast<std::uint64_t>(header.meshCount) * sizeof(FileMeshRecord);
+    const std::uint64_t dependencyTableSize = static_cast<std::uint64_t>(header.dependencyCount) * sizeof(FileDependencyRecord);
+    if (!inRange(tableOffset, tableSize) || !inRange(header.dependencyTableOffset, dependencyTableSize))
+    {
+        Close();
+        return false;
+    }
+
+    // O fonte (registro 0) precisa ser o da chave; fonte ou dependência alterada invalida o bake.
+    for (std::uint32_t i = 0; i < header.dependencyCount; ++i)
+    {
+        FileDependencyRecord dependency{};
+        std::memcpy(&dependency, base + header.dependencyTableOffset + i * sizeof(FileDependencyRecord), sizeof(dependency));
+        if (!inRange(dependency.pathOffset, dependency.pathSize))
+        {
+            Close();
+            return false;
+        }
+        const std::string path(reinterpret_cast<const char*>(base + dependency.pathOffset),
+                               static_cast<std::size_t>(dependency.pathSize));
+        if ((i == 0 && path != key.sourcePath) || !IsDependencyCurrent(path, dependency))
+        {
+            Close();
+            return false;
+        }
+    }
+
+    m_data.aabbMin = glm::vec3(header.aabbMin[0], header.aabbMin[1], header.aabbMin[2]);
+    m_data.aabbMax = glm::vec3(header.aabbMax[0], header.aabbMax[1], header.aabbMax[2]);
+    m_data.hasBounds = header.hasBounds != 0;
+    m_data.meshes.resize(header.meshCount);
+    for (std::uint32_t i = 0; i < header.meshCount; ++i)
+    {
+        FileMeshRecord record{};
+        std::memcpy(&record, base + tableOffset + i * sizeof(FileMeshRecord), sizeof(record));
+        const VertexFormat format = static_cast<VertexFormat>(record.format);
+        const GLenum indexType = record.indexType;
+        if ((format != VertexFormat::Float && format != VertexFormat::Quantized) ||
+            (indexType != GL_UNSIGNED_SHORT && indexType != GL_UNSIGNED_INT) ||
+            record.textureKind > static_cast<std::uint32_t>(BakedTextureSource::Kind::Raw))
+        {
+            Close();
+            return false;
+        }
+        const std::uint64_t vertexCount = record.vertexCount;
+        const std::uint64_t indexCount = record.indexCount;
+        if (!inRange(record.vertexBlobOffset, vertexCount * VertexStride(format)) ||
+            !inRange(record.positionBlobOffset, vertexCount * PositionStride(format)) ||
+            !inRange(record.indexBlobOffset, indexCount * IndexSize(indexType)) ||
+            !inRange(record.textureOffset, record.textureSize))
+        {
+            Close();
+            return false;
+        }
+
+        BakedMesh& mesh = m_data.meshes[i];
+        mesh.format = format;
+        mesh.indexType = indexType;
+        mesh.vertexCount = record.vertexCount;
+        mesh.indexCount = record.indexCount;
+        mesh.decode.positionScale =
+            glm::vec4(record.decodeScale[0], record.decodeScale[1], record.decodeScale[2], record.decodeScale[3]);
+        mesh.decode.positionBias = glm::vec3(record.decodeBias[0], record.decodeBias[1], record.decodeBias[2]);
+        mesh.vertexBlob = base + record.vertexBlobOffset;
+        mesh.positionBlob = base + record.positionBlobOffset;
+        mesh.indexBlob = base + record.indexBlobOffset;
+        mesh.ambient = glm::vec3(record.ambient[0], record.ambient[1], record.ambient[2]);
+        mesh.diffuse = glm::vec3(record.diffuse[0], record.diffuse[1], record.diffuse[2]);
+        mesh.specular = glm::vec3(record.specular[0], record.specular[1], record.specular[2]);
+        mesh.shininess = record.shininess;
+        mesh.texture.kind = static_cast<BakedTextureSource::Kind>(record.textureKind);
+        mesh.texture.data = base + record.textureOffset;
+        mesh.texture.size = static_cast<std::size_t>(record.textureSize);
+        mesh.texture.width = record.textureWidth;
+        mesh.texture.height = record.textureHeight;
+    }
+    return true;
+}
+
+void BakedModelFile::Close()
+{
+    m_file.Close();
+    m_data = {};
+}
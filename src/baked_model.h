@@ -0,0 +1,97 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "mapped_file.h"
+#include "vertex_format.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// @brief Origem da textura difusa de um material, como o importador a resolveu.
+struct BakedTextureSource
+{
+    enum class Kind : std::uint32_t
+    {
+        None,
+        File,       ///< data/size: caminho do arquivo (sem terminador).
+        Compressed, ///< data/size: imagem embutida codificada (PNG/JPEG), para Texture::LoadFromMemory.
+        Raw,        ///< data/size: texels RGBA8 de width x height, para Texture::LoadFromRawData.
+    };
+
+    Kind kind = Kind::None;
+    const unsigned char* data = nullptr;
+    std::size_t size = 0;
+    int width = 0;
+    int height = 0;
+};
+
+/// @brief Um mesh pronto para o GeometryPool. Na leitura todos os ponteiros apontam para o arquivo mapeado;
+/// na escrita, para buffers do chamador.
+struct BakedMesh
+{
+    VertexFormat format = VertexFormat::Float;
+    GLenum indexType = GL_UNSIGNED_INT;
+    std::uint32_t vertexCount = 0;
+    std::uint32_t indexCount = 0;
+    VertexDecode decode;
+
+    const void* vertexBlob = nullptr;   ///< Stream completo no formato do pool.
+    const void* positionBlob = nullptr; ///< Stream só de posições do mesmo formato.
+    const void* indexBlob = nullptr;    ///< indexCount índices de indexType.
+
+    glm::vec3 ambient{ 0.2f };
+    glm::vec3 diffuse{ 1.0f };
+    glm::vec3 specular{ 1.0f };
+    float shininess = 32.0f;
+    BakedTextureSource texture;
+};
+
+struct BakedModelData
+{
+    glm::vec3 aabbMin{ 0.0f };
+    glm::vec3 aabbMax{ 0.0f };
+    bool hasBounds = false;
+    std::vector<BakedMesh> meshes;
+    /// Arquivos além do fonte lidos na importação (buffers externos, .mtl, texturas); conferidos pelo Open.
+    std::vector<std::string> dependencies;
+};
+
+/// @brief Identifica um bake: arquivo fonte e hash das opções de importação (flags do Assimp, filtro de nós,
+/// versão do formato e do pipeline de otimização/quantização). O conteúdo é conferido pelas dependências do bake.
+struct BakedModelKey
+{
+    std::string sourcePath;
+    std::string cachePath;
+    std::uint64_t optionsHash = 0;
+};
+
+/// @brief Cache binário de modelos importados, gravado ao lado do fonte (<fonte>.<opções>.bake).
+/// Cabeçalho versionado, tabela de meshes e blobs alinhados a 16 bytes; a leitura mapeia o arquivo e só
+/// valida offsets: os blobs vão direto para glBufferSubData, sem parse nem cópia.
+/// O bake guarda tamanho, data de modificação e hash do fonte e de cada dependência: arquivos com tamanho e data
+/// iguais não são relidos; data diferente recalcula o hash. Qualquer divergência (versão, opções, dependência
+/// alterada ou ausente, tamanho) conta como ausência e o modelo é reimportado.
+class BakedModelFile
+{
+public:
+    /// Incrementar sempre que o layout ou o pipeline de importação mudar a saída.
+    static constexpr std::uint32_t kVersion = 3;
+
+    static BakedModelKey MakeKey(const std::string& sourcePath,
+                                 unsigned int importFlags,
+                                 const std::vector<std::string>& allowedNodes);
+    static bool Write(const BakedModelKey& key, const BakedModelData& data);
+
+    /// @brief Mapeia e valida o bake da chave; os ponteiros de GetData valem até Close ou a destruição.
+    bool Open(const BakedModelKey& key);
+    void Close();
+    const BakedModelData& GetData() const { return m_data; }
+
+private:
+    MappedFile m_file;
+    BakedModelData m_data;
+};
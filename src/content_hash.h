@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/// @brief FNV-1a de 64 bits. Chave de conteúdo para bakes e caches de assets; seed encadeia vários blocos.
+constexpr std::uint64_t kContentHashSeed = 14695981039346656037ull;
+
+inline std::uint64_t HashBytes(const void* data, std::size_t size, std::uint64_t seed = kContentHashSeed)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    std::uint64_t hash = seed;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    return hash;
+}
@@ -0,0 +1,126 @@
+#include "frustum.h"
+
+#include <glm/gtc/matrix_access.hpp>
+
+#include <xmmintrin.h>
+
+namespace
+{
+Plane NormalizePlane(const glm::vec4& plane)
+{
+    const glm::vec3 normal = glm::vec3(plane);
+    const float length = glm::length(normal);
+    if (length == 0.0f)
+    {
+        return Plane{};
+    }
+    return Plane{ normal / length, plane.w / length };
+}
+}
+
+Frustum ExtractFrustum(const glm::mat4& matrix, bool includeNearPlane)
+{
+    Frustum frustum;
+    const glm::vec4 rowX = glm::row(matrix, 0);
+    const glm::vec4 rowY = glm::row(matrix, 1);
+    const glm::vec4 rowZ = glm::row(matrix, 2);
+    const glm::vec4 rowW = glm::row(matrix, 3);
+
+    frustum.planes[0] = NormalizePlane(rowW + rowX);
+    frustum.planes[1] = NormalizePlane(rowW - rowX);
+    frustum.planes[2] = NormalizePlane(rowW + rowY);
+    frustum.planes[3] = NormalizePlane(rowW - rowY);
+    frustum.planes[4] = NormalizePlane(rowW - rowZ);
+    frustum.planes[5] = NormalizePlane(rowW + rowZ);
+    frustum.planeCount = includeNearPlane ? 6 : 5;
+
+    return frustum;
+}
+
+Frustum MakeSphereVolume(const glm::vec3& center, float radius)
+{
+    Frustum volume;
+    volume.planeCount = 0;
+    volume.hasBoundingSphere = true;
+    volume.sphereCenter = center;
+    volume.sphereRadius = radius;
+    return volume;
+}
+
+void SphereBoundsSoA::Resize(std::size_t count)
+{
+    const std::size_t padded = (count + kSimdWidth - 1) / kSimdWidth * kSimdWidth;
+    centerX.assign(padded, 0.0f);
+    centerY.assign(padded, 0.0f);
+    centerZ.assign(padded, 0.0f);
+    // Raio negativo marca a vaga de preenchimento; o kernel a descarta antes dos planos.
+    radius.assign(padded, -1.0f);
+}
+
+void SphereBoundsSoA::Assign(std::size_t index, const glm::vec3& center, float sphereRadius)
+{
+    centerX[index] = center.x;
+    centerY[index] = center.y;
+    centerZ[index] = center.z;
+    radius[index] = sphereRadius;
+}
+
+std::size_t CullSpheres(const Frustum& volume, const SphereBoundsSoA& spheres, std::uint32_t* visibleIndices)
+{
+    // Planos e esfera limitante espalhados uma vez; o laço só carrega quatro esferas por iteração.
+    __m128 planeX[6];
+    __m128 planeY[6];
+    __m128 planeZ[6];
+    __m128 planeD[6];
+    for (int i = 0; i < volume.planeCount; ++i)
+    {
+        planeX[i] = _mm_set1_ps(volume.planes[i].normal.x);
+        planeY[i] = _mm_set1_ps(volume.planes[i].normal.y);
+        planeZ[i] = _mm_set1_ps(volume.planes[i].normal.z);
+        planeD[i] = _mm_set1_ps(volume.planes[i].distance);
+    }
+    const __m128 sphereX = _mm_set1_ps(volume.sphereCenter.x);
+    const __m128 sphereY = _mm_set1_ps(volume.sphereCenter.y);
+    const __m128 sphereZ = _mm_set1_ps(volume.sphereCenter.z);
+    const __m128 sphereRadius = _mm_set1_ps(volume.sphereRadius);
+    const __m128 zero = _mm_setzero_ps();
+
+    std::size_t visibleCount = 0;
+    const std::size_t count = spheres.PaddedSize();
+    for (std::size_t base = 0; base < count; base += SphereBoundsSoA::kSimdWidth)
+    {
+        const __m128 x = _mm_loadu_ps(&spheres.centerX[base]);
+        const __m128 y = _mm_loadu_ps(&spheres.centerY[base]);
+        const __m128 z = _mm_loadu_ps(&spheres.centerZ[base]);
+        const __m128 r = _mm_loadu_ps(&spheres.radius[base]);
+        const __m128 negativeR = _mm_sub_ps(zero, r);
+
+        __m128 outside = _mm_cmplt_ps(r, zero);
+        for (int i = 0; i < volume.planeCount; ++i)
+        {
+            const __m128 distance = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(planeX[i], x), _mm_mul_ps(planeY[i], y)),
+                _mm_add_ps(_mm_mul_ps(planeZ[i], z), planeD[i]));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, negativeR));
+        }
+        if (volume.hasBoundingSphere)
+        {
+            const __m128 dx = _mm_sub_ps(x, sphereX);
+            const __m128 dy = _mm_sub_ps(y, sphereY);
+            const __m128 dz = _mm_sub_ps(z, sphereZ);
+            const __m128 reach = _mm_add_ps(sphereRadius, r);
+            const __m128 distanceSquared =
+                _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+            outside = _mm_or_ps(outside, _mm_cmpgt_ps(distanceSquared, _mm_mul_ps(reach, reach)));
+        }
+
+        // Compactação sem desvio: cada lane grava na vaga atual e só avança se for visível.
+        const int visibleMask = ~_mm_movemask_ps(outside) & 0xF;
+        for (std::size_t lane = 0; lane < SphereBoundsSoA::kSimdWidth; ++lane)
+        {
+            visibleIndices[visibleCount] = static_cast<std::uint32_t>(base + lane);
+            visibleCount += static_cast<std::size_t>((visibleMask >> lane) & 1);
+        }
+    }
+    return visibleCount;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct Plane
+{
+    glm::vec3 normal{ 0.0f };
+    float distance = 0.0f;
+};
+
+/// @brief Volume de culling: até seis planos (normais para dentro) e, opcionalmente, uma esfera limitante.
+/// Planos em ordem esquerda, direita, baixo, cima, far, near; planeCount = 5 descarta o near.
+struct Frustum
+{
+    std::array<Plane, 6> planes{};
+    int planeCount = 6;
+    bool hasBoundingSphere = false;
+    glm::vec3 sphereCenter{ 0.0f };
+    float sphereRadius = 0.0f;
+
+    bool IsSphereVisible(const glm::vec3& center, float radius) const
+    {
+        for (int i = 0; i < planeCount; ++i)
+        {
+            const Plane& plane = planes[i];
+            if (glm::dot(plane.normal, center) + plane.distance < -radius)
+            {
+                return false;
+            }
+        }
+        if (hasBoundingSphere)
+        {
+            const glm::vec3 offset = center - sphereCenter;
+            const float reach = sphereRadius + radius;
+            if (glm::dot(offset, offset) > reach * reach)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+/// @brief Extrai os planos de uma matriz view-projection (Gribb/Hartmann).
+/// Sem o near plane o volume fica extrudado em direção à origem da projeção (casters entre a luz e o volume).
+Frustum ExtractFrustum(const glm::mat4& matrix, bool includeNearPlane = true);
+
+/// @brief Volume formado apenas por uma esfera (ex.: alcance de uma luz pontual).
+Frustum MakeSphereVolume(const glm::vec3& center, float radius);
+
+/// @brief Esferas em SoA (um array por componente) para o culling em SIMD.
+/// O tamanho é sempre múltiplo de kSimdWidth: as vagas extras têm raio negativo e nunca são visíveis.
+struct SphereBoundsSoA
+{
+    static constexpr std::size_t kSimdWidth = 4;
+
+    std::vector<float> centerX;
+    std::vector<float> centerY;
+    std::vector<float> centerZ;
+    std::vector<float> radius;
+
+    /// @brief count esferas, arredondado para cima com vagas de preenchimento.
+    void Resize(std::size_t count);
+    void Assign(std::size_t index, const glm::vec3& center, float sphereRadius);
+    std::size_t PaddedSize() const { return radius.size(); }
+    glm::vec3 GetCenter(std::size_t index) const { return glm::vec3(centerX[index], centerY[index], centerZ[index]); }
+};
+
+/// @brief Testa as esferas quatro por vez (SSE) e grava em visibleIndices, em ordem crescente, os índices das
+/// visíveis. visibleIndices precisa comportar PaddedSize() índices. Retorna quantas foram gravadas.
+std::size_t CullSpheres(const Frustum& volume, const SphereBoundsSoA& spheres, std::uint32_t* visibleIndices);
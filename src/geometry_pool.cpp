@@ -0,0 +1,407 @@
+#include "geometry_pool.h"
+
+#include "render_state.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <iostream>
+
+namespace
+{
+// Capacidades iniciais (vértices por formato e unidades de 2 bytes de índice); crescem dobrando conforme
+// os modelos são carregados. Um formato sem meshes não aloca buffer.
+constexpr std::uint32_t kInitialVertexCapacity = 1u << 16;
+constexpr std::uint32_t kInitialIndexUnits = 1u << 19;
+constexpr std::size_t kIndexUnitBytes = sizeof(GLushort);
+// Até aqui os índices locais cabem em GL_UNSIGNED_SHORT.
+constexpr std::size_t kMaxShortIndexVertices = 65536;
+
+// Realoca buffer com newBytes e copia os oldBytes atuais na GPU (GL_COPY_*_BUFFER não mexe no VAO).
+void ReallocateBuffer(GLuint& buffer, std::size_t oldBytes, std::size_t newBytes)
+{
+    RenderStateCache& state = RenderStateCache::Get();
+    GLuint grown = 0;
+    glGenBuffers(1, &grown);
+    state.BindBuffer(GL_COPY_WRITE_BUFFER, grown);
+    glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(newBytes), nullptr, GL_STATIC_DRAW);
+    if (buffer != 0 && oldBytes > 0)
+    {
+        state.BindBuffer(GL_COPY_READ_BUFFER, buffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, static_cast<GLsizeiptr>(oldBytes));
+    }
+    state.DeleteBuffer(buffer);
+    buffer = grown;
+}
+
+void UploadRange(GLuint buffer, std::size_t byteOffset, std::size_t byteCount, const void* data)
+{
+    RenderStateCache::Get().BindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER,
+                    static_cast<GLintptr>(byteOffset),
+                    static_cast<GLsizeiptr>(byteCount),
+                    data);
+}
+}
+
+void GeometryPool::RangeAllocator::Reset()
+{
+    m_free.clear();
+    m_capacity = 0;
+}
+
+std::uint32_t GeometryPool::RangeAllocator::Allocate(std::uint32_t count, std::uint32_t alignment)
+{
+    for (auto it = m_free.begin(); it != m_free.end(); ++it)
+    {
+        const std::uint32_t aligned = (it->offset + alignment - 1) / alignment * alignment;
+        const std::uint32_t padding = aligned - it->offset;
+        if (it->count < count + padding)
+        {
+            continue;
+        }
+
+        // O que sobra antes (alinhamento) e depois da faixa continua livre, na mesma posição da lista.
+        const Range source = *it;
+        it = m_free.erase(it);
+        const std::uint32_t tail = source.count - padding - count;
+        if (tail > 0)
+        {
+            it = m_free.insert(it, Range{ aligned + count, tail });
+        }
+        if (padding > 0)
+        {
+            m_free.insert(it, Range{ source.offset, padding });
+        }
+        return aligned;
+    }
+    return kInvalidOffset;
+}
+
+void GeometryPool::RangeAllocator::Free(std::uint32_t offset, std::uint32_t count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    auto next = std::lower_bound(m_free.begin(), m_free.end(), offset, [](const Range& range, std::uint32_t value) {
+        return range.offset < value;
+    });
+    next = m_free.insert(next, Range{ offset, count });
+
+    // Funde com a vizinha seguinte e depois com a anterior, mantendo a lista sem faixas adjacentes.
+    auto following = next + 1;
+    if (following != m_free.end() && next->offset + next->count == following->offset)
+    {
+        next->count += following->count;
+        m_free.erase(following);
+    }
+    if (next != m_free.begin())
+    {
+        auto previous = next - 1;
+        if (previous->offset + previous->count == next->offset)
+        {
+            previous->count += next->count;
+            m_free.erase(next);
+        }
+    }
+}
+
+void GeometryPool::RangeAllocator::Grow(std::uint32_t newCapacity)
+{
+    if (newCapacity <= m_capacity)
+    {
+        return;
+    }
+    const std::uint32_t oldCapacity = m_capacity;
+    m_capacity = newCapacity;
+    Free(oldCapacity, newCapacity - oldCapacity);
+}
+
+GeometryPool::GeometryPool()
+{
+    m_formats[FormatSlot(VertexFormat::Float)].vertexStride = sizeof(Vertex);
+    m_formats[FormatSlot(VertexFormat::Float)].positionStride = sizeof(glm::vec3);
+    m_formats[FormatSlot(VertexFormat::Quantized)].vertexStride = sizeof(PackedVertex);
+    m_formats[FormatSlot(VertexFormat::Quantized)].positionStride = sizeof(PackedPosition);
+}
+
+GeometryPool& GeometryPool::Get()
+{
+    static GeometryPool pool;
+    return pool;
+}
+
+bool GeometryPool::SupportsBaseInstance()
+{
+    static const bool supported = glDrawElementsInstancedBaseVertexBaseInstance != nullptr;
+    return supported;
+}
+
+bool GeometryPool::EnsureCreated()
+{
+    if (m_formats[0].vertexArray != 0)
+    {
+        return true;
+    }
+    if (glDrawElementsBaseVertex == nullptr || glCopyBufferSubData == nullptr)
+    {
+        std::cerr << "Contexto sem glDrawElementsBaseVertex/glCopyBufferSubData; pool de geometria indisponível."
+                  << std::endl;
+        return false;
+    }
+
+    for (FormatBuffers& buffers : m_formats)
+    {
+        glGenVertexArrays(1, &buffers.vertexArray);
+        glGenVertexArrays(1, &buffers.depthVertexArray);
+        if (buffers.vertexArray == 0 || buffers.depthVertexArray == 0)
+        {
+            std::cerr << "Falha ao criar os VAOs do pool de geometria." << std::endl;
+            Destroy();
+            return false;
+        }
+        buffers.ranges.Reset();
+    }
+    m_indexUnits.Reset();
+    m_stats = {};
+    return true;
+}
+
+void GeometryPool::Destroy()
+{
+    RenderStateCache& state = RenderStateCache::Get();
+    for (FormatBuffers& buffers : m_formats)
+    {
+        state.DeleteVertexArray(buffers.vertexArray);
+        state.DeleteVertexArray(buffers.depthVertexArray);
+        state.DeleteBuffer(buffers.vertexBuffer);
+        state.DeleteBuffer(buffers.positionBuffer);
+        buffers.vertexArray = 0;
+        buffers.depthVertexArray = 0;
+        buffers.vertexBuffer = 0;
+        buffers.positionBuffer = 0;
+        buffers.ranges.Reset();
+    }
+    state.DeleteBuffer(m_indexBuffer);
+    m_indexBuffer = 0;
+    m_indexUnits.Reset();
+    m_decodeKnown = false;
+    m_stats = {};
+    ++m_bufferRevision;
+}
+
+void GeometryPool::GrowVertices(VertexFormat format, std::uint32_t requiredCount)
+{
+    FormatBuffers& buffers = m_formats[FormatSlot(format)];
+    const std::uint32_t oldCapacity = buffers.ranges.GetCapacity();
+    const std::uint32_t newCapacity = std::max(std::max(oldCapacity * 2u, kInitialVertexCapacity), oldCapacity + requiredCount);
+    ReallocateBuffer(buffers.vertexBuffer, oldCapacity * buffers.vertexStride, newCapacity * buffers.vertexStride);
+    ReallocateBuffer(buffers.positionBuffer, oldCapacity * buffers.positionStride, newCapacity * buffers.positionStride);
+    buffers.ranges.Grow(newCapacity);
+    m_stats.vertexBytesCapacity += (newCapacity - oldCapacity) * (buffers.vertexStride + buffers.positionStride);
+    if (oldCapacity > 0)
+    {
+        ++m_stats.growths;
+    }
+    SetupVertexArrays(format);
+}
+
+void GeometryPool::GrowIndices(std::uint32_t requiredUnits)
+{
+    const std::uint32_t oldCapacity = m_indexUnits.GetCapacity();
+    const std::uint32_t newCapacity = std::max(std::max(oldCapacity * 2u, kInitialIndexUnits), oldCapacity + requiredUnits);
+    ReallocateBuffer(m_indexBuffer, oldCapacity * kIndexUnitBytes, newCapacity * kIndexUnitBytes);
+    m_indexUnits.Grow(newCapacity);
+    m_stats.indexBytesCapacity = newCapacity * kIndexUnitBytes;
+    if (oldCapacity > 0)
+    {
+        ++m_stats.growths;
+    }
+    for (std::size_t slot = 0; slot < kVertexFormatCount; ++slot)
+    {
+        if (m_formats[slot].vertexBuffer != 0)
+        {
+            SetupVertexArrays(static_cast<VertexFormat>(slot));
+        }
+    }
+}
+
+void GeometryPool::SetupVertexArrays(VertexFormat format)
+{
+    // Os VAOs guardam o nome do buffer de cada atributo: refeitos sempre que um buffer cresce.
+    // Atributos de instância (3-7) continuam a cargo de Mesh::BindInstanceAttributes.
+    const FormatBuffers& buffers = m_formats[FormatSlot(format)];
+    RenderStateCache& state = RenderStateCache::Get();
+    state.BindVertexArray(buffers.vertexArray);
+    BindFormatAttributes(format, false);
+    state.BindVertexArray(buffers.depthVertexArray);
+    BindFormatAttributes(format, true);
+    state.BindVertexArray(0);
+    ++m_bufferRevision;
+}
+
+void GeometryPool::BindFormatAttributes(VertexFormat format, bool depthOnly) const
+{
+    const FormatBuffers& buffers = m_formats[FormatSlot(format)];
+    RenderStateCache& state = RenderStateCache::Get();
+    state.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer);
+    glEnableVertexAttribArray(0);
+    if (depthOnly)
+    {
+        const GLsizei positionStride = static_cast<GLsizei>(buffers.positionStride);
+        state.BindBuffer(GL_ARRAY_BUFFER, buffers.positionBuffer);
+        if (format == VertexFormat::Quantized)
+        {
+            glVertexAttribPointer(0, 3, GL_SHORT, GL_TRUE, positionStride, nullptr);
+        }
+        else
+        {
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, positionStride, nullptr);
+        }
+        return;
+    }
+
+    const GLsizei stride = static_cast<GLsizei>(buffers.vertexStride);
+    state.BindBuffer(GL_ARRAY_BUFFER, buffers.vertexBuffer);
+    glEnableVertexAttribArray(1);
+    glEnableVertexAttribArray(2);
+    if (format == VertexFormat::Quantized)
+    {
+        // SNORM16 na AABB, normal octaédrica em x/y de um 2_10_10_10 com sinal, UV em half float.
+        glVertexAttribPointer(0, 3, GL_SHORT, GL_TRUE, stride, reinterpret_cast<void*>(offsetof(PackedVertex, position)));
+        glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, reinterpret_cast<void*>(offsetof(PackedVertex, normal)));
+        glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(offsetof(PackedVertex, texCoords)));
+    }
+    else
+    {
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(offsetof(Vertex, position)));
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(offsetof(Vertex, normal)));
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(offsetof(Vertex, texCoords)));
+    }
+}
+
+GeometryAllocation GeometryPool::Allocate(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices)
+{
+    // Passadas de depth só leem a posição: cópia compacta (12 de 32 bytes por vértice) no mesmo baseVertex.
+    std::vector<glm::vec3> positions;
+    positions.reserve(vertices.size());
+    for (const Vertex& vertex : vertices)
+    {
+        positions.push_back(vertex.position);
+    }
+    return AllocateRanges(VertexFormat::Float, vertices.data(), positions.data(), vertices.size(), indices);
+}
+
+GeometryAllocation GeometryPool::Allocate(const QuantizedVertices& vertices, const std::vector<unsigned int>& indices)
+{
+    return AllocateRanges(VertexFormat::Quantized,
+                          vertices.vertices.data(),
+                          vertices.positions.data(),
+                          vertices.vertices.size(),
+                          indices);
+}
+
+GLenum GeometryPool::GetIndexType(std::size_t vertexCount)
+{
+    return vertexCount <= kMaxShortIndexVertices ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
+
+GeometryAllocation GeometryPool::AllocateRanges(VertexFormat format,
+                                                const void* vertices,
+                                                const void* positions,
+                                                std::size_t vertexCount,
+                                                const std::vector<unsigned int>& indices)
+{
+    if (GetIndexType(vertexCount) == GL_UNSIGNED_INT)
+    {
+        return Allocate(format, vertices, positions, vertexCount, indices.data(), indices.size(), GL_UNSIGNED_INT);
+    }
+    const std::vector<GLushort> shortIndices(indices.begin(), indices.end());
+    return Allocate(format, vertices, positions, vertexCount, shortIndices.data(), shortIndices.size(), GL_UNSIGNED_SHORT);
+}
+
+GeometryAllocation GeometryPool::Allocate(VertexFormat format,
+                                          const void* vertices,
+                                          const void* positions,
+                                          std::size_t vertexCount,
+                                          const void* indices,
+                                          std::size_t indexCount,
+                                          GLenum indexType)
+{
+    GeometryAllocation allocation;
+    if (vertexCount == 0 || indexCount == 0 || indexType != GetIndexType(vertexCount) || !EnsureCreated())
+    {
+        return allocation;
+    }
+
+    FormatBuffers& buffers = m_formats[FormatSlot(format)];
+    const std::uint32_t count = static_cast<std::uint32_t>(vertexCount);
+    std::uint32_t vertexOffset = buffers.ranges.Allocate(count);
+    if (vertexOffset == RangeAllocator::kInvalidOffset)
+    {
+        GrowVertices(format, count);
+        vertexOffset = buffers.ranges.Allocate(count);
+    }
+
+    const bool shortIndices = indexType == GL_UNSIGNED_SHORT;
+    const std::uint32_t unitsPerIndex = shortIndices ? 1u : 2u;
+    const std::uint32_t indexUnits = static_cast<std::uint32_t>(indexCount) * unitsPerIndex;
+    std::uint32_t indexOffset = m_indexUnits.Allocate(indexUnits, unitsPerIndex);
+    if (indexOffset == RangeAllocator::kInvalidOffset)
+    {
+        GrowIndices(indexUnits + unitsPerIndex);
+        indexOffset = m_indexUnits.Allocate(indexUnits, unitsPerIndex);
+    }
+
+    UploadRange(buffers.vertexBuffer, vertexOffset * buffers.vertexStride, vertexCount * buffers.vertexStride, vertices);
+    UploadRange(buffers.positionBuffer, vertexOffset * buffers.positionStride, vertexCount * buffers.positionStride, positions);
+    UploadRange(m_indexBuffer, indexOffset * kIndexUnitBytes, indexUnits * kIndexUnitBytes, indices);
+
+    allocation.format = format;
+    allocation.indexType = indexType;
+    allocation.baseVertex = static_cast<GLint>(vertexOffset);
+    allocation.firstIndex = indexOffset / unitsPerIndex;
+    allocation.indexCount = static_cast<GLsizei>(indexCount);
+    allocation.vertexCount = count;
+
+    ++m_stats.allocations;
+    m_stats.quantizedAllocations += format == VertexFormat::Quantized ? 1 : 0;
+    m_stats.shortIndexAllocations += shortIndices ? 1 : 0;
+    m_stats.vertexBytesUsed += vertexCount * (buffers.vertexStride + buffers.positionStride);
+    m_stats.indexBytesUsed += indexUnits * kIndexUnitBytes;
+    return allocation;
+}
+
+void GeometryPool::Free(const GeometryAllocation& allocation)
+{
+    // Depois de Destroy as listas já foram zeradas: nada a devolver.
+    FormatBuffers& buffers = m_formats[FormatSlot(allocation.format)];
+    if (!allocation.IsValid() || buffers.vertexArray == 0)
+    {
+        return;
+    }
+    const std::uint32_t unitsPerIndex = allocation.indexType == GL_UNSIGNED_SHORT ? 1u : 2u;
+    const std::uint32_t indexUnits = static_cast<std::uint32_t>(allocation.indexCount) * unitsPerIndex;
+    buffers.ranges.Free(static_cast<std::uint32_t>(allocation.baseVertex), allocation.vertexCount);
+    m_indexUnits.Free(allocation.firstIndex * unitsPerIndex, indexUnits);
+
+    --m_stats.allocations;
+    m_stats.quantizedAllocations -= allocation.format == VertexFormat::Quantized ? 1 : 0;
+    m_stats.shortIndexAllocations -= allocation.indexType == GL_UNSIGNED_SHORT ? 1 : 0;
+    m_stats.vertexBytesUsed -= allocation.vertexCount * (buffers.vertexStride + buffers.positionStride);
+    m_stats.indexBytesUsed -= indexUnits * kIndexUnitBytes;
+}
+
+void GeometryPool::ApplyDecode(const VertexDecode& decode)
+{
+    // Valores correntes de atributo são estado do contexto, não do VAO: valem para qualquer VAO do pool.
+    if (m_decodeKnown && decode == m_appliedDecode)
+    {
+        return;
+    }
+    glVertexAttrib4fv(kPositionScaleAttribute, glm::value_ptr(decode.positionScale));
+    glVertexAttrib3fv(kPositionBiasAttribute, glm::value_ptr(decode.positionBias));
+    m_appliedDecode = decode;
+    m_decodeKnown = true;
+}
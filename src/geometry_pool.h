@@ -0,0 +1,156 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include "vertex_format.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// @brief Faixa de um mesh dentro do pool: vértices a partir de baseVertex, índices locais a partir de firstIndex
+/// (em elementos de indexType).
+struct GeometryAllocation
+{
+    VertexFormat format = VertexFormat::Float;
+    GLenum indexType = GL_UNSIGNED_INT;
+    GLint baseVertex = 0;
+    GLuint firstIndex = 0;
+    GLsizei indexCount = 0;
+    GLuint vertexCount = 0;
+
+    bool IsValid() const { return indexCount > 0; }
+    std::size_t GetIndexSize() const { return indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint); }
+    /// @brief Deslocamento em bytes do primeiro índice, no formato do ponteiro de glDrawElements*.
+    const void* GetIndexOffset() const
+    {
+        return reinterpret_cast<const void*>(static_cast<std::uintptr_t>(firstIndex) * GetIndexSize());
+    }
+};
+
+struct GeometryPoolStats
+{
+    std::size_t allocations = 0;
+    std::size_t quantizedAllocations = 0;
+    std::size_t shortIndexAllocations = 0;
+    std::size_t vertexBytesUsed = 0;
+    std::size_t vertexBytesCapacity = 0;
+    std::size_t indexBytesUsed = 0;
+    std::size_t indexBytesCapacity = 0;
+    std::size_t growths = 0;
+};
+
+/// @brief Mega-buffer de geometria: os meshes de todos os modelos dividem, por formato de vértice, um VBO
+/// completo e um só de posições (passadas de depth), com um VAO para cada; o EBO é um só. Cada mesh guarda só
+/// a sua faixa e desenha com glDrawElements*BaseVertex; a fila de desenho deixa de trocar VAO entre meshes.
+/// Índices são de 16 bits quando o mesh tem até 65536 vértices.
+/// Faixas liberadas voltam a listas livres (first-fit, com fusão de vizinhas) e são reaproveitadas pelos
+/// próximos carregamentos. Sem espaço, os buffers dobram e o conteúdo é copiado na GPU.
+/// Como o RenderStateCache, é global: a cena carrega modelos antes de o Renderer existir.
+class GeometryPool
+{
+public:
+    /// Atributos genéricos (arrays sempre desligados) com a VertexDecode do mesh desenhado.
+    static constexpr GLuint kPositionScaleAttribute = 8;
+    static constexpr GLuint kPositionBiasAttribute = 9;
+
+    static GeometryPool& Get();
+
+    GeometryPool(const GeometryPool&) = delete;
+    GeometryPool& operator=(const GeometryPool&) = delete;
+
+    /// @brief Copia os vértices e índices para o pool. Alocação inválida se não há contexto ou dados.
+    GeometryAllocation Allocate(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices);
+    GeometryAllocation Allocate(const QuantizedVertices& vertices, const std::vector<unsigned int>& indices);
+    /// @brief Streams já no layout do pool (ex.: blobs de um bake mapeado), enviados sem conversão nem cópia
+    /// intermediária. indexType tem de ser GetIndexType(vertexCount).
+    GeometryAllocation Allocate(VertexFormat format,
+                                const void* vertices,
+                                const void* positions,
+                                std::size_t vertexCount,
+                                const void* indices,
+                                std::size_t indexCount,
+                                GLenum indexType);
+    void Free(const GeometryAllocation& allocation);
+    /// @brief Libera os objetos GL; chamado antes de o contexto sumir. Free posterior só ajusta as listas.
+    void Destroy();
+
+    GLuint GetVertexArray(VertexFormat format) const { return m_formats[FormatSlot(format)].vertexArray; }
+    /// @brief VAO com apenas o atributo 0 (posições compactas) e o mesmo EBO.
+    GLuint GetDepthVertexArray(VertexFormat format) const { return m_formats[FormatSlot(format)].depthVertexArray; }
+    /// @brief Liga ao VAO vinculado o EBO e os atributos 0-2 do formato (só o 0, de posições, com depthOnly).
+    /// Para VAOs de fora do pool que leem os mesmos buffers com atributos próprios (GpuDrivenScene).
+    void BindFormatAttributes(VertexFormat format, bool depthOnly) const;
+    /// @brief Muda sempre que um buffer do pool é recriado: VAOs de fora do pool precisam ser refeitos.
+    std::uint64_t GetBufferRevision() const { return m_bufferRevision; }
+    /// @brief Envia a decodificação do mesh como valores correntes dos atributos 8 e 9, se mudou.
+    /// Geometria fora do pool desenhada com os shaders de mesh aplica VertexDecode{} (identidade).
+    void ApplyDecode(const VertexDecode& decode);
+    const GeometryPoolStats& GetStats() const { return m_stats; }
+
+    /// @brief true se o contexto expõe glDrawElementsInstancedBaseVertexBaseInstance (GL 4.2 / ARB_base_instance).
+    static bool SupportsBaseInstance();
+    /// @brief Tipo de índice que o pool usa para um mesh com vertexCount vértices.
+    static GLenum GetIndexType(std::size_t vertexCount);
+
+private:
+    struct Range
+    {
+        std::uint32_t offset = 0;
+        std::uint32_t count = 0;
+    };
+
+    /// Lista livre ordenada por offset sobre uma capacidade em elementos.
+    class RangeAllocator
+    {
+    public:
+        static constexpr std::uint32_t kInvalidOffset = 0xFFFFFFFFu;
+
+        void Reset();
+        /// @brief Primeira faixa que comporta count elementos a partir de um offset múltiplo de alignment.
+        std::uint32_t Allocate(std::uint32_t count, std::uint32_t alignment = 1);
+        void Free(std::uint32_t offset, std::uint32_t count);
+        /// @brief Acrescenta [capacidade atual, newCapacity) ao fim da lista livre.
+        void Grow(std::uint32_t newCapacity);
+        std::uint32_t GetCapacity() const { return m_capacity; }
+
+    private:
+        std::vector<Range> m_free;
+        std::uint32_t m_capacity = 0;
+    };
+
+    struct FormatBuffers
+    {
+        std::size_t vertexStride = 0;
+        std::size_t positionStride = 0;
+        GLuint vertexBuffer = 0;
+        GLuint positionBuffer = 0;
+        GLuint vertexArray = 0;
+        GLuint depthVertexArray = 0;
+        RangeAllocator ranges;
+    };
+
+    GeometryPool();
+
+    static std::size_t FormatSlot(VertexFormat format) { return static_cast<std::size_t>(format); }
+
+    bool EnsureCreated();
+    GeometryAllocation AllocateRanges(VertexFormat format,
+                                      const void* vertices,
+                                      const void* positions,
+                                      std::size_t vertexCount,
+                                      const std::vector<unsigned int>& indices);
+    void GrowVertices(VertexFormat format, std::uint32_t requiredCount);
+    void GrowIndices(std::uint32_t requiredUnits);
+    void SetupVertexArrays(VertexFormat format);
+
+    std::array<FormatBuffers, kVertexFormatCount> m_formats;
+    /// EBO em unidades de 2 bytes: índices de 32 bits ocupam duas, alinhadas.
+    GLuint m_indexBuffer = 0;
+    RangeAllocator m_indexUnits;
+    VertexDecode m_appliedDecode;
+    bool m_decodeKnown = false;
+    std::uint64_t m_bufferRevision = 0;
+    GeometryPoolStats m_stats{};
+};
@@ -0,0 +1,602 @@
+#include "gpu_driven_scene.h"
+
+#include "frustum.h"
+#include "geometry_pool.h"
+#include "material.h"
+#include "model.h"
+#include "render_state.h"
+#include "scene.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <unordered_map>
+
+namespace
+{
+constexpr GLuint kCullWorkGroupSize = 64;
+constexpr std::uint32_t kObjectDynamicFlag = 1u;
+constexpr GLuint kCasterStaticBit = 1u;
+constexpr GLuint kCasterDynamicBit = 2u;
+// Sem LOD o registro vale para qualquer distância (a distância nunca é negativa).
+constexpr float kNoLodMinDistance = -1.0f;
+constexpr float kNoLodMaxDistance = std::numeric_limits<float>::max();
+
+void UploadBuffer(GLenum target, GLuint buffer, const void* data, std::size_t size, GLenum usage)
+{
+    RenderStateCache::Get().BindBuffer(target, buffer);
+    glBufferData(target, static_cast<GLsizeiptr>(std::max<std::size_t>(size, 16)), nullptr, usage);
+    if (data != nullptr && size > 0)
+    {
+        glBufferSubData(target, 0, static_cast<GLsizeiptr>(size), data);
+    }
+}
+
+const Texture* DiffuseTextureOf(const Mesh* mesh)
+{
+    const Material* material = mesh->GetMaterial();
+    return material != nullptr ? material->GetActiveTexture() : nullptr;
+}
+
+GLuint ResolveTexture(const Material* material, GLuint fallbackTexture)
+{
+    if (material != nullptr && material->HasTexture())
+    {
+        return material->GetActiveTexture()->GetID();
+    }
+    return fallbackTexture;
+}
+}
+
+bool GpuDrivenScene::IsSupported()
+{
+    // Ponteiros só são carregados pelo glad quando a versão/extensão existe no contexto.
+    return glDispatchCompute != nullptr && glMemoryBarrier != nullptr && glMultiDrawElementsIndirect != nullptr &&
+           glBindBufferBase != nullptr && glCopyBufferSubData != nullptr;
+}
+
+GpuDrivenScene::~GpuDrivenScene()
+{
+    Destroy();
+}
+
+bool GpuDrivenScene::Create()
+{
+    Destroy();
+    if (!IsSupported())
+    {
+        std::cerr << "GL 4.3 indisponível; caminho GPU-driven desativado." << std::endl;
+        return false;
+    }
+    if (!m_cullShader.CreateCompute("assets/shaders/gpu_cull_compute.glsl"))
+    {
+        return false;
+    }
+
+    const GLuint program = m_cullShader.program;
+    m_recordCountLoc = glGetUniformLocation(program, "uRecordCount");
+    m_commandBaseLoc = glGetUniformLocation(program, "uCommandBase");
+    m_planesLoc = glGetUniformLocation(program, "uPlanes");
+    m_planeCountLoc = glGetUniformLocation(program, "uPlaneCount");
+    m_boundingSphereLoc = glGetUniformLocation(program, "uBoundingSphere");
+    m_cameraPosLoc = glGetUniformLocation(program, "uCameraPos");
+    m_casterMaskLoc = glGetUniformLocation(program, "uCasterMask");
+
+    GLuint* buffers[] = { &m_objectBuffer,  &m_materialBuffer,        &m_meshBuffer,   &m_recordBuffer,
+                          &m_commandBuffer, &m_commandTemplateBuffer, &m_visibleBuffer };
+    for (GLuint* buffer : buffers)
+    {
+        glGenBuffers(1, buffer);
+    }
+    glGenVertexArrays(static_cast<GLsizei>(m_shadedVAOs.size()), m_shadedVAOs.data());
+    glGenVertexArrays(static_cast<GLsizei>(m_depthVAOs.size()), m_depthVAOs.data());
+    m_vertexArraysReady = false;
+    return true;
+}
+
+void GpuDrivenScene::Destroy()
+{
+    DestroyBuffers();
+    m_cullShader.Destroy();
+    m_built = false;
+    m_sceneRevision = 0;
+    m_sceneObjectCount = 0;
+    m_objectCount = 0;
+    m_commandMeshes.clear();
+    m_materials.clear();
+    m_records.clear();
+    m_sceneObjectData.clear();
+    m_materialData.clear();
+    m_stats = {};
+}
+
+void GpuDrivenScene::DestroyBuffers()
+{
+    RenderStateCache& state = RenderStateCache::Get();
+    for (std::size_t slot = 0; slot < kVertexFormatCount; ++slot)
+    {
+        state.DeleteVertexArray(m_shadedVAOs[slot]);
+        state.DeleteVertexArray(m_depthVAOs[slot]);
+        m_shadedVAOs[slot] = 0;
+        m_depthVAOs[slot] = 0;
+    }
+    m_vertexArraysReady = false;
+
+    GLuint* buffers[] = { &m_objectBuffer,  &m_materialBuffer,        &m_meshBuffer,   &m_recordBuffer,
+                          &m_commandBuffer, &m_commandTemplateBuffer, &m_visibleBuffer };
+    for (GLuint* buffer : buffers)
+    {
+        state.DeleteBuffer(*buffer);
+        *buffer = 0;
+    }
+}
+
+void GpuDrivenScene::ResetFrameStats()
+{
+    m_stats.cullDispatches = 0;
+    m_stats.multiDraws = 0;
+}
+
+bool GpuDrivenScene::Prepare(const Scene& scene)
+{
+    if (m_cullShader.program == 0)
+    {
+        return false;
+    }
+
+    if (!m_built || scene.GetRevision() != m_sceneRevision || scene.GetObjects().size() != m_sceneObjectCount)
+    {
+        Rebuild(scene);
+    }
+    if (m_records.empty())
+    {
+        return false;
+    }
+
+    if (!m_vertexArraysReady || GeometryPool::Get().GetBufferRevision() != m_poolRevision)
+    {
+        SetupVertexArrays();
+    }
+
+    UpdateSceneObjects(scene);
+    UploadMaterials();
+    return true;
+}
+
+void GpuDrivenScene::Rebuild(const Scene& scene)
+{
+    m_built = true;
+    m_sceneRevision = scene.GetRevision();
+    m_commandMeshes.clear();
+    m_materials.assign(1, nullptr);
+    m_materialData.clear();
+    m_records.clear();
+
+    const auto& objects = scene.GetObjects();
+    const auto& batches = scene.GetInstancedBatches();
+
+    // Meshes de todos os modelos alcançáveis (inclusive LODs), um comando indireto por mesh.
+    std::vector<const Model*> models;
+    auto addModel = [&models](const Model* model) {
+        if (model != nullptr && std::find(models.begin(), models.end(), model) == models.end())
+        {
+            models.push_back(model);
+        }
+    };
+    for (const SceneObject& object : objects)
+    {
+        addModel(object.GetModel());
+        for (const SceneObjectLOD& lod : object.GetLODLevels())
+        {
+            addModel(lod.model);
+        }
+    }
+    for (const SceneInstancedBatch& batch : batches)
+    {
+        addModel(batch.model);
+    }
+    // Meshes sem faixa no pool (sem contexto na carga) ficam de fora.
+    for (const Model* model : models)
+    {
+        for (const auto& mesh : model->GetMeshes())
+        {
+            if (mesh->GetGeometry().IsValid())
+            {
+                m_commandMeshes.push_back(mesh.get());
+            }
+        }
+    }
+    std::stable_sort(m_commandMeshes.begin(), m_commandMeshes.end(), [](const Mesh* a, const Mesh* b) {
+        const GeometryAllocation& geometryA = a->GetGeometry();
+        const GeometryAllocation& geometryB = b->GetGeometry();
+        if (geometryA.format != geometryB.format)
+        {
+            return geometryA.format < geometryB.format;
+        }
+        if (geometryA.indexType != geometryB.indexType)
+        {
+            return geometryA.indexType < geometryB.indexType;
+        }
+        const Texture* textureA = DiffuseTextureOf(a);
+        const Texture* textureB = DiffuseTextureOf(b);
+        if (textureA != textureB)
+        {
+            return std::less<const Texture*>()(textureA, textureB);
+        }
+        return std::less<const Material*>()(a->GetMaterial(), b->GetMaterial());
+    });
+
+    // Comandos apontam para a faixa de cada mesh no pool; a decodificação vai na tabela de meshes.
+    std::unordered_map<const Mesh*, std::uint32_t> commandIndices;
+    std::unordered_map<const Material*, std::uint32_t> materialIndices;
+    materialIndices[nullptr] = 0;
+    std::vector<DrawCommand> meshCommands;
+    std::vector<MeshData> meshData;
+    meshCommands.reserve(m_commandMeshes.size());
+    meshData.reserve(m_commandMeshes.size());
+    for (const Mesh* mesh : m_commandMeshes)
+    {
+        commandIndices[mesh] = static_cast<std::uint32_t>(meshCommands.size());
+        if (materialIndices.emplace(mesh->GetMaterial(), static_cast<std::uint32_t>(m_materials.size())).second)
+        {
+            m_materials.push_back(mesh->GetMaterial());
+        }
+
+        const GeometryAllocation& geometry = mesh->GetGeometry();
+        DrawCommand command;
+        command.count = static_cast<GLuint>(geometry.indexCount);
+        command.firstIndex = geometry.firstIndex;
+        command.baseVertex = geometry.baseVertex;
+        meshCommands.push_back(command);
+
+        const VertexDecode& decode = mesh->GetVertexDecode();
+        MeshData data;
+        data.positionScale = decode.positionScale;
+        data.positionBias = glm::vec4(decode.positionBias, 0.0f);
+        data.info.x = materialIndices[mesh->GetMaterial()];
+        meshData.push_back(data);
+    }
+
+    auto addRecords = [&](const Model* model, std::size_t objectIndex, float minDistance, float maxDistance) {
+        if (model == nullptr)
+        {
+            return;
+        }
+        for (const auto& mesh : model->GetMeshes())
+        {
+            const auto command = commandIndices.find(mesh.get());
+            if (command == commandIndices.end())
+            {
+                continue;
+            }
+            DrawRecord record;
+            record.objectIndex = static_cast<std::uint32_t>(objectIndex);
+            record.commandIndex = command->second;
+            record.lodMinDistance = minDistance;
+            record.lodMaxDistance = maxDistance;
+            m_records.push_back(record);
+        }
+    };
+
+    // Cada nível vira uma faixa (mínimo, máximo] de distância, reproduzindo ResolveModelForDistance:
+    // vale o primeiro nível válido cujo máximo cobre a distância; além de todos, o último.
+    m_sceneObjectCount = objects.size();
+    for (std::size_t i = 0; i < objects.size(); ++i)
+    {
+        const SceneObject& object = objects[i];
+        if (object.GetModel() == nullptr)
+        {
+            continue;
+        }
+        const std::vector<SceneObjectLOD>& lods = object.GetLODLevels();
+        if (lods.empty())
+        {
+            addRecords(object.GetModel(), i, kNoLodMinDistance, kNoLodMaxDistance);
+            continue;
+        }
+        float lowerBound = kNoLodMinDistance;
+        for (const SceneObjectLOD& lod : lods)
+        {
+            if (lod.model == nullptr)
+            {
+                continue;
+            }
+            if (lod.maxDistance > lowerBound)
+            {
+                addRecords(lod.model, i, lowerBound, lod.maxDistance);
+                lowerBound = lod.maxDistance;
+            }
+        }
+        addRecords(lods.back().model != nullptr ? lods.back().model : object.GetModel(), i, lowerBound, kNoLodMaxDistance);
+    }
+
+    // Instâncias dos batches entram depois dos objetos: cenário fixo, enviado só aqui.
+    std::vector<ObjectData> batchObjects;
+    for (const SceneInstancedBatch& batch : batches)
+    {
+        if (batch.model == nullptr)
+        {
+            continue;
+        }
+        for (std::size_t i = 0; i < batch.transforms.size(); ++i)
+        {
+            ObjectData data;
+            data.model = batch.transforms[i];
+            data.boundingSphere = glm::vec4(batch.bounds.GetCenter(i), batch.bounds.radius[i]);
+            addRecords(batch.model, m_sceneObjectCount + batchObjects.size(), kNoLodMinDistance, kNoLodMaxDistance);
+            batchObjects.push_back(data);
+        }
+    }
+    m_objectCount = m_sceneObjectCount + batchObjects.size();
+    m_sceneObjectData.assign(m_sceneObjectCount, ObjectData{});
+
+    // Faixa de instâncias de cada comando: uma vaga por registro que aponta para ele, repetida por visão.
+    std::vector<GLuint> commandOffsets(meshCommands.size() + 1, 0);
+    for (const DrawRecord& record : m_records)
+    {
+        ++commandOffsets[record.commandIndex + 1];
+    }
+    for (std::size_t i = 1; i < commandOffsets.size(); ++i)
+    {
+        commandOffsets[i] += commandOffsets[i - 1];
+    }
+    const GLuint recordCount = static_cast<GLuint>(m_records.size());
+    std::vector<DrawCommand> commandTemplate;
+    commandTemplate.reserve(meshCommands.size() * kMaxViews);
+    for (int view = 0; view < kMaxViews; ++view)
+    {
+        for (std::size_t i = 0; i < meshCommands.size(); ++i)
+        {
+            DrawCommand command = meshCommands[i];
+            command.baseInstance = static_cast<GLuint>(view) * recordCount + commandOffsets[i];
+            commandTemplate.push_back(command);
+        }
+    }
+
+    UploadBuffer(GL_SHADER_STORAGE_BUFFER, m_meshBuffer, meshData.data(), meshData.size() * sizeof(MeshData), GL_STATIC_DRAW);
+    UploadBuffer(GL_SHADER_STORAGE_BUFFER, m_objectBuffer, nullptr, m_objectCount * sizeof(ObjectData), GL_DYNAMIC_DRAW);
+    if (!batchObjects.empty())
+    {
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER,
+                        static_cast<GLintptr>(m_sceneObjectCount * sizeof(ObjectData)),
+                        static_cast<GLsizeiptr>(batchObjects.size() * sizeof(ObjectData)),
+                        batchObjects.data());
+    }
+    UploadBuffer(GL_SHADER_STORAGE_BUFFER, m_recordBuffer, m_records.data(), m_records.size() * sizeof(DrawRecord), GL_STATIC_DRAW);
+    UploadBuffer(GL_COPY_WRITE_BUFFER,
+                 m_commandTemplateBuffer,
+                 commandTemplate.data(),
+                 commandTemplate.size() * sizeof(DrawCommand),
+                 GL_STATIC_DRAW);
+    UploadBuffer(GL_DRAW_INDIRECT_BUFFER,
+                 m_commandBuffer,
+                 commandTemplate.data(),
+                 commandTemplate.size() * sizeof(DrawCommand),
+                 GL_DYNAMIC_DRAW);
+    UploadBuffer(GL_ARRAY_BUFFER,
+                 m_visibleBuffer,
+                 nullptr,
+                 static_cast<std::size_t>(kMaxViews) * m_records.size() * sizeof(glm::uvec2),
+                 GL_DYNAMIC_DRAW);
+    m_materialData.clear();
+
+    m_stats.objects = m_objectCount;
+    m_stats.drawRecords = m_records.size();
+    m_stats.commands = meshCommands.size();
+}
+
+void GpuDrivenScene::SetupVertexArrays()
+{
+    // Mesmos buffers, EBO e baseVertex dos VAOs do pool; o atributo 3 é o par (objeto, mesh) por instância.
+    GeometryPool& pool = GeometryPool::Get();
+    RenderStateCache& state = RenderStateCache::Get();
+    auto setupDrawInfoAttribute = [&state, this]() {
+        state.BindBuffer(GL_ARRAY_BUFFER, m_visibleBuffer);
+        glEnableVertexAttribArray(3);
+        glVertexAttribIPointer(3, 2, GL_UNSIGNED_INT, sizeof(glm::uvec2), nullptr);
+        glVertexAttribDivisor(3, 1);
+    };
+    for (std::size_t slot = 0; slot < kVertexFormatCount; ++slot)
+    {
+        const VertexFormat format = static_cast<VertexFormat>(slot);
+        if (pool.GetVertexArray(format) == 0)
+        {
+            continue;
+        }
+        state.BindVertexArray(m_shadedVAOs[slot]);
+        pool.BindFormatAttributes(format, false);
+        setupDrawInfoAttribute();
+        state.BindVertexArray(m_depthVAOs[slot]);
+        pool.BindFormatAttributes(format, true);
+        setupDrawInfoAttribute();
+    }
+    state.BindVertexArray(0);
+    m_poolRevision = pool.GetBufferRevision();
+    m_vertexArraysReady = true;
+}
+
+bool GpuDrivenScene::ShareGeometryLayout(std::size_t a, std::size_t b) const
+{
+    const GeometryAllocation& geometryA = m_commandMeshes[a]->GetGeometry();
+    const GeometryAllocation& geometryB = m_commandMeshes[b]->GetGeometry();
+    return geometryA.format == geometryB.format && geometryA.indexType == geometryB.indexType;
+}
+
+void GpuDrivenScene::UpdateSceneObjects(const Scene& scene)
+{
+    if (m_sceneObjectCount == 0)
+    {
+        return;
+    }
+
+    const auto& objects = scene.GetObjects();
+    for (std::size_t i = 0; i < m_sceneObjectCount; ++i)
+    {
+        const SceneObject& object = objects[i];
+        ObjectData& data = m_sceneObjectData[i];
+        data.model = object.GetModelMatrix();
+        data.boundingSphere = glm::vec4(object.GetWorldCenter(data.model), object.GetWorldRadius());
+        data.info.x = scene.IsDynamicObject(object) ? kObjectDynamicFlag : 0u;
+    }
+    RenderStateCache::Get().BindBuffer(GL_SHADER_STORAGE_BUFFER, m_objectBuffer);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER,
+                    0,
+                    static_cast<GLsizeiptr>(m_sceneObjectData.size() * sizeof(ObjectData)),
+                    m_sceneObjectData.data());
+}
+
+void GpuDrivenScene::UploadMaterials()
+{
+    static const Material kDefaultMaterial;
+    std::vector<MaterialData> materialData;
+    materialData.reserve(m_materials.size());
+    for (const Material* material : m_materials)
+    {
+        const Material& source = material != nullptr ? *material : kDefaultMaterial;
+        MaterialData data;
+        data.ambient = glm::vec4(source.GetAmbient(), 0.0f);
+        data.diffuse = glm::vec4(source.GetDiffuse(), 0.0f);
+        data.specular = glm::vec4(source.GetSpecular(), source.GetShininess());
+        materialData.push_back(data);
+    }
+
+    // Materiais quase nunca mudam: só reenvia quando o conteúdo difere do último upload.
+    if (materialData.size() == m_materialData.size() &&
+        std::memcmp(materialData.data(), m_materialData.data(), materialData.size() * sizeof(MaterialData)) == 0)
+    {
+        return;
+    }
+    m_materialData = std::move(materialData);
+    UploadBuffer(GL_SHADER_STORAGE_BUFFER,
+                 m_materialBuffer,
+                 m_materialData.data(),
+                 m_materialData.size() * sizeof(MaterialData),
+                 GL_DYNAMIC_DRAW);
+}
+
+void GpuDrivenScene::Cull(int view, const Frustum& volume, const glm::vec3& cameraPos, bool includeStatic, bool includeDynamic)
+{
+    if (!IsReady() || view < 0 || view >= kMaxViews)
+    {
+        return;
+    }
+
+    // Restaura os comandos da visão (instanceCount = 0) a partir do template antes do compute acumular.
+    RenderStateCache& state = RenderStateCache::Get();
+    const GLsizeiptr commandBytes = static_cast<GLsizeiptr>(m_commandMeshes.size() * sizeof(DrawCommand));
+    const GLintptr viewOffset = static_cast<GLintptr>(view) * commandBytes;
+    state.BindBuffer(GL_COPY_READ_BUFFER, m_commandTemplateBuffer);
+    state.BindBuffer(GL_COPY_WRITE_BUFFER, m_commandBuffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, viewOffset, viewOffset, commandBytes);
+
+    std::array<glm::vec4, 6> planes{};
+    for (int i = 0; i < volume.planeCount; ++i)
+    {
+        planes[i] = glm::vec4(volume.planes[i].normal, volume.planes[i].distance);
+    }
+    const glm::vec4 boundingSphere = volume.hasBoundingSphere ? glm::vec4(volume.sphereCenter, volume.sphereRadius)
+                                                              : glm::vec4(0.0f, 0.0f, 0.0f, -1.0f);
+    const GLuint casterMask = (includeStatic ? kCasterStaticBit : 0u) | (includeDynamic ? kCasterDynamicBit : 0u);
+
+    m_cullShader.Use();
+    glUniform1ui(m_recordCountLoc, static_cast<GLuint>(m_records.size()));
+    glUniform1ui(m_commandBaseLoc, static_cast<GLuint>(view) * static_cast<GLuint>(m_commandMeshes.size()));
+    glUniform4fv(m_planesLoc, static_cast<GLsizei>(planes.size()), &planes[0].x);
+    glUniform1i(m_planeCountLoc, volume.planeCount);
+    glUniform4fv(m_boundingSphereLoc, 1, &boundingSphere.x);
+    glUniform3fv(m_cameraPosLoc, 1, &cameraPos.x);
+    glUniform1ui(m_casterMaskLoc, casterMask);
+
+    state.BindBufferBase(GL_SHADER_STORAGE_BUFFER, kObjectBinding, m_objectBuffer);
+    state.BindBufferBase(GL_SHADER_STORAGE_BUFFER, kRecordBinding, m_recordBuffer);
+    state.BindBufferBase(GL_SHADER_STORAGE_BUFFER, kCommandBinding, m_commandBuffer);
+    state.BindBufferBase(GL_SHADER_STORAGE_BUFFER, kVisibleBinding, m_visibleBuffer);
+
+    const GLuint groupCount = (static_cast<GLuint>(m_records.size()) + kCullWorkGroupSize - 1) / kCullWorkGroupSize;
+    glDispatchCompute(groupCount, 1, 1);
+    // Os comandos são lidos como parâmetros de draw e os pares visíveis como atributo de vértice.
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+    ++m_stats.cullDispatches;
+}
+
+void GpuDrivenScene::DrawDepth(int view)
+{
+    if (!IsReady() || view < 0 || view >= kMaxViews)
+    {
+        return;
+    }
+
+    RenderStateCache& state = RenderStateCache::Get();
+    state.BindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandBuffer);
+    state.BindBufferBase(GL_SHADER_STORAGE_BUFFER, kObjectBinding, m_objectBuffer);
+    state.BindBufferBase(GL_SHADER_STORAGE_BUFFER, kMeshBinding, m_meshBuffer);
+
+    const std::size_t commandCount = m_commandMeshes.size();
+    const GLintptr viewOffset = static_cast<GLintptr>(view) * static_cast<GLintptr>(commandCount * sizeof(DrawCommand));
+    std::size_t runBegin = 0;
+    while (runBegin < commandCount)
+    {
+        std::size_t runEnd = runBegin + 1;
+        while (runEnd < commandCount && ShareGeometryLayout(runBegin, runEnd))
+        {
+            ++runEnd;
+        }
+
+        const GeometryAllocation& geometry = m_commandMeshes[runBegin]->GetGeometry();
+        state.BindVertexArray(m_depthVAOs[static_cast<std::size_t>(geometry.format)]);
+        const GLintptr runOffset = viewOffset + static_cast<GLintptr>(runBegin * sizeof(DrawCommand));
+        glMultiDrawElementsIndirect(GL_TRIANGLES,
+                                    geometry.indexType,
+                                    reinterpret_cast<const void*>(runOffset),
+                                    static_cast<GLsizei>(runEnd - runBegin),
+                                    sizeof(DrawCommand));
+        ++m_stats.multiDraws;
+        runBegin = runEnd;
+    }
+}
+
+void GpuDrivenScene::DrawShaded(int view, GLuint fallbackTexture)
+{
+    if (!IsReady() || view < 0 || view >= kMaxViews)
+    {
+        return;
+    }
+
+    RenderStateCache& state = RenderStateCache::Get();
+    state.BindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandBuffer);
+    state.BindBufferBase(GL_SHADER_STORAGE_BUFFER, kObjectBinding, m_objectBuffer);
+    state.BindBufferBase(GL_SHADER_STORAGE_BUFFER, kMaterialBinding, m_materialBuffer);
+    state.BindBufferBase(GL_SHADER_STORAGE_BUFFER, kMeshBinding, m_meshBuffer);
+
+    // Sem bindless a textura difusa ainda é estado: um multi-draw por sequência contígua de comandos com o
+    // mesmo formato e a mesma textura (ordenados assim no Rebuild; com override quase tudo vira um por formato).
+    const std::size_t commandCount = m_commandMeshes.size();
+    const GLintptr viewOffset = static_cast<GLintptr>(view) * static_cast<GLintptr>(commandCount * sizeof(DrawCommand));
+    std::size_t runBegin = 0;
+    while (runBegin < commandCount)
+    {
+        const GLuint texture = ResolveTexture(m_commandMeshes[runBegin]->GetMaterial(), fallbackTexture);
+        std::size_t runEnd = runBegin + 1;
+        while (runEnd < commandCount && ShareGeometryLayout(runBegin, runEnd) &&
+               ResolveTexture(m_commandMeshes[runEnd]->GetMaterial(), fallbackTexture) == texture)
+        {
+            ++runEnd;
+        }
+
+        const GeometryAllocation& geometry = m_commandMeshes[runBegin]->GetGeometry();
+        state.BindVertexArray(m_shadedVAOs[static_cast<std::size_t>(geometry.format)]);
+        state.BindTextureUnit(GL_TEXTURE0, GL_TEXTURE_2D, texture);
+        const GLintptr runOffset = viewOffset + static_cast<GLintptr>(runBegin * sizeof(DrawCommand));
+        glMultiDrawElementsIndirect(GL_TRIANGLES,
+                                    geometry.indexType,
+                                    reinterpret_cast<const void*>(runOffset),
+                                    static_cast<GLsizei>(runEnd - runBegin),
+                                    sizeof(DrawCommand));
+        ++m_stats.multiDraws;
+        runBegin = runEnd;
+    }
+}
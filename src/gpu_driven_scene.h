@@ -0,0 +1,167 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "shader_program.h"
+#include "vertex_format.h"
+
+class Material;
+class Mesh;
+class Scene;
+struct Frustum;
+
+struct GpuDrivenStats
+{
+    std::size_t objects = 0;     ///< Objetos da cena + instâncias dos batches no SSBO.
+    std::size_t drawRecords = 0; ///< Pares objeto x (LOD, mesh) testados pelo compute a cada culling.
+    std::size_t commands = 0;    ///< Comandos indiretos por visão (um por mesh).
+    std::size_t cullDispatches = 0;
+    std::size_t multiDraws = 0;
+};
+
+/// @brief Caminho GPU-driven (GL 4.3): desenha direto dos buffers do GeometryPool (faixas com baseVertex e
+/// firstIndex de cada mesh), com transforms, esferas, decodificação dos meshes e materiais em SSBOs.
+/// Um compute por visão faz frustum culling e seleção de LOD e preenche comandos DrawElementsIndirect;
+/// cada passada os consome com um glMultiDrawElementsIndirect por formato de vértice e tipo de índice.
+/// O par (objeto, mesh) de cada instância chega ao vertex shader como atributo com divisor 1,
+/// deslocado pelo baseInstance do comando (gl_DrawID exigiria GL 4.6).
+class GpuDrivenScene
+{
+public:
+    /// Comandos e instâncias visíveis separados por visão do frame: câmera e uma por cascata.
+    static constexpr int kCameraView = 0;
+    static constexpr int kFirstCascadeView = 1;
+    static constexpr int kMaxViews = 5;
+
+    /// Bindings dos SSBOs (layout(binding) em gpu_cull_compute.glsl e nos vertex shaders gpu_*).
+    static constexpr GLuint kObjectBinding = 0;
+    static constexpr GLuint kRecordBinding = 1;
+    static constexpr GLuint kCommandBinding = 2;
+    static constexpr GLuint kVisibleBinding = 3;
+    static constexpr GLuint kMaterialBinding = 4;
+    static constexpr GLuint kMeshBinding = 5;
+
+    /// @brief true se o contexto expõe compute, SSBO e multi-draw indireto (GL 4.3).
+    static bool IsSupported();
+
+    GpuDrivenScene() = default;
+    ~GpuDrivenScene();
+
+    GpuDrivenScene(const GpuDrivenScene&) = delete;
+    GpuDrivenScene& operator=(const GpuDrivenScene&) = delete;
+
+    bool Create();
+    void Destroy();
+
+    /// @brief Refaz comandos e tabelas quando a cena muda de revisão; a cada frame reenvia as transforms
+    /// dos objetos da cena e os materiais. Retorna false se não há o que desenhar.
+    bool Prepare(const Scene& scene);
+
+    /// @brief Zera os comandos da visão e roda o culling contra o volume. Deixa o programa de compute ativo.
+    void Cull(int view, const Frustum& volume, const glm::vec3& cameraPos, bool includeStatic, bool includeDynamic);
+
+    /// @brief Multi-draws com o stream só de posições, um por formato; o programa de depth já deve estar ativo.
+    void DrawDepth(int view);
+    /// @brief Multi-draws do stream completo, um por sequência de comandos com o mesmo formato e textura difusa.
+    void DrawShaded(int view, GLuint fallbackTexture);
+
+    bool IsReady() const { return m_cullShader.program != 0 && !m_records.empty(); }
+    const GpuDrivenStats& GetStats() const { return m_stats; }
+    void ResetFrameStats();
+
+private:
+    /// Layouts std430 espelhados nos shaders.
+    struct ObjectData
+    {
+        glm::mat4 model{ 1.0f };
+        glm::vec4 boundingSphere{ 0.0f };
+        glm::uvec4 info{ 0u };
+    };
+
+    struct MaterialData
+    {
+        glm::vec4 ambient{ 0.0f };
+        glm::vec4 diffuse{ 0.0f };
+        glm::vec4 specular{ 0.0f }; ///< w: shininess
+    };
+
+    /// Um por comando: VertexDecode do mesh e, em info.x, o índice do material.
+    struct MeshData
+    {
+        glm::vec4 positionScale{ 1.0f, 1.0f, 1.0f, 0.0f };
+        glm::vec4 positionBias{ 0.0f };
+        glm::uvec4 info{ 0u };
+    };
+
+    struct DrawRecord
+    {
+        std::uint32_t objectIndex = 0;
+        std::uint32_t commandIndex = 0;
+        float lodMinDistance = 0.0f;
+        float lodMaxDistance = 0.0f;
+    };
+
+    struct DrawCommand
+    {
+        GLuint count = 0;
+        GLuint instanceCount = 0;
+        GLuint firstIndex = 0;
+        GLint baseVertex = 0;
+        GLuint baseInstance = 0;
+    };
+
+    static_assert(sizeof(ObjectData) == 96, "ObjectData deve seguir o layout std430 do shader");
+    static_assert(sizeof(MaterialData) == 48, "MaterialData deve seguir o layout std430 do shader");
+    static_assert(sizeof(MeshData) == 48, "MeshData deve seguir o layout std430 do shader");
+    static_assert(sizeof(DrawRecord) == 16, "DrawRecord deve seguir o layout std430 do shader");
+    static_assert(sizeof(DrawCommand) == 20, "DrawCommand deve seguir DrawElementsIndirectCommand");
+
+    void Rebuild(const Scene& scene);
+    void UpdateSceneObjects(const Scene& scene);
+    void UploadMaterials();
+    /// @brief Refaz os VAOs sobre os buffers atuais do pool (que são recriados quando crescem).
+    void SetupVertexArrays();
+    /// @brief true se os comandos a e b podem ir no mesmo multi-draw (mesmo VAO e tipo de índice).
+    bool ShareGeometryLayout(std::size_t a, std::size_t b) const;
+    void DestroyBuffers();
+
+    ShaderProgram m_cullShader;
+    GLint m_recordCountLoc = -1;
+    GLint m_commandBaseLoc = -1;
+    GLint m_planesLoc = -1;
+    GLint m_planeCountLoc = -1;
+    GLint m_boundingSphereLoc = -1;
+    GLint m_cameraPosLoc = -1;
+    GLint m_casterMaskLoc = -1;
+
+    /// VAOs próprios por formato: atributos do pool mais o par (objeto, mesh) por instância.
+    std::array<GLuint, kVertexFormatCount> m_shadedVAOs{};
+    std::array<GLuint, kVertexFormatCount> m_depthVAOs{};
+    std::uint64_t m_poolRevision = 0;
+    bool m_vertexArraysReady = false;
+    GLuint m_objectBuffer = 0;
+    GLuint m_materialBuffer = 0;
+    GLuint m_meshBuffer = 0;
+    GLuint m_recordBuffer = 0;
+    GLuint m_commandBuffer = 0;
+    GLuint m_commandTemplateBuffer = 0;
+    GLuint m_visibleBuffer = 0;
+
+    bool m_built = false;
+    std::uint64_t m_sceneRevision = 0;
+    std::size_t m_sceneObjectCount = 0;
+    std::size_t m_objectCount = 0;
+    /// Ordenados por formato, tipo de índice e textura: cada sequência igual vira um multi-draw.
+    std::vector<const Mesh*> m_commandMeshes;
+    std::vector<const Material*> m_materials; ///< Índice 0 é o material padrão (meshes sem material).
+    std::vector<DrawRecord> m_records;
+    std::vector<ObjectData> m_sceneObjectData;
+    std::vector<MaterialData> m_materialData;
+    GpuDrivenStats m_stats{};
+};
@@ -0,0 +1,374 @@
+#include "hiz_occlusion.h"
+
+#include "render_state.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <utility>
+
+namespace
+{
+// Cantos com w abaixo disso estão no plano da câmera ou atrás: a projeção não limita a esfera.
+constexpr float kMinClipW = 1e-5f;
+
+int ToPixel(float ndc, int size)
+{
+    const int pixel = static_cast<int>((ndc * 0.5f + 0.5f) * static_cast<float>(size));
+    return std::clamp(pixel, 0, size - 1);
+}
+
+/// Mesmo mapeamento do shader de redução: o último texel absorve o resto de uma origem ímpar.
+int ToCoarseIndex(int index, int shift, int size)
+{
+    return std::min(index >> shift, size - 1);
+}
+}
+
+HiZOcclusion::~HiZOcclusion()
+{
+    Destroy();
+}
+
+bool HiZOcclusion::Create()
+{
+    Destroy();
+    if (!m_downsampleShader.Create("assets/shaders/postprocess_vertex.glsl",
+                                   "assets/shaders/hiz_downsample_fragment.glsl"))
+    {
+        std::cerr << "Falha ao criar shader de redução Hi-Z." << std::endl;
+        return false;
+    }
+    m_downsampleShader.Use();
+    glUniform1i(glGetUniformLocation(m_downsampleShader.program, "sourceDepth"), 0);
+    m_sourceSizeLoc = glGetUniformLocation(m_downsampleShader.program, "uSourceSize");
+
+    glGenFramebuffers(1, &m_framebuffer);
+    for (ReadbackSlot& slot : m_slots)
+    {
+        glGenBuffers(1, &slot.buffer);
+    }
+    const bool buffersReady =
+        std::all_of(m_slots.begin(), m_slots.end(), [](const ReadbackSlot& slot) { return slot.buffer != 0; });
+    if (m_framebuffer == 0 || !buffersReady)
+    {
+        std::cerr << "Falha ao criar framebuffer/PBOs da pirâmide Hi-Z." << std::endl;
+        Destroy();
+        return false;
+    }
+    return true;
+}
+
+void HiZOcclusion::Destroy()
+{
+    RenderStateCache& state = RenderStateCache::Get();
+    for (ReadbackSlot& slot : m_slots)
+    {
+        ReleaseSlot(slot);
+        state.DeleteBuffer(slot.buffer);
+        slot = ReadbackSlot{};
+    }
+    DestroyPyramid();
+    state.DeleteFramebuffer(m_framebuffer);
+    m_framebuffer = 0;
+    m_downsampleShader.Destroy();
+    m_sourceSizeLoc = -1;
+    m_nextSlot = 0;
+    m_cpuLevels.clear();
+}
+
+void HiZOcclusion::DestroyPyramid()
+{
+    RenderStateCache::Get().DeleteTexture(m_pyramid);
+    m_pyramid = 0;
+    m_levelSizes.clear();
+    m_readbackLevel = 0;
+    m_sourceWidth = 0;
+    m_sourceHeight = 0;
+}
+
+void HiZOcclusion::ReleaseSlot(ReadbackSlot& slot)
+{
+    if (slot.fence != nullptr)
+    {
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+    }
+}
+
+void HiZOcclusion::Invalidate()
+{
+    for (ReadbackSlot& slot : m_slots)
+    {
+        ReleaseSlot(slot);
+    }
+    m_cpuLevels.clear();
+}
+
+bool HiZOcclusion::EnsurePyramid(int width, int height)
+{
+    if (m_pyramid != 0 && width == m_sourceWidth && height == m_sourceHeight)
+    {
+        return true;
+    }
+    DestroyPyramid();
+
+    // Nível 0 já é metade da depth; a cadeia segue até 1x1 com os tamanhos padrão de mipmap.
+    glm::ivec2 size(std::max(width / 2, 1), std::max(height / 2, 1));
+    m_levelSizes.push_back(size);
+    while (size.x > 1 || size.y > 1)
+    {
+        size = glm::ivec2(std::max(size.x / 2, 1), std::max(size.y / 2, 1));
+        m_levelSizes.push_back(size);
+    }
+    m_readbackLevel = static_cast<int>(m_levelSizes.size()) - 1;
+    for (std::size_t level = 0; level < m_levelSizes.size(); ++level)
+    {
+        if (m_levelSizes[level].x <= kReadbackMaxWidth)
+        {
+            m_readbackLevel = static_cast<int>(level);
+            break;
+        }
+    }
+
+    RenderStateCache& state = RenderStateCache::Get();
+    glGenTextures(1, &m_pyramid);
+    state.ActiveTexture(GL_TEXTURE0);
+    state.BindTexture(GL_TEXTURE_2D, m_pyramid);
+    for (std::size_t level = 0; level < m_levelSizes.size(); ++level)
+    {
+        glTexImage2D(GL_TEXTURE_2D,
+                     static_cast<GLint>(level),
+                     GL_R32F,
+                     m_levelSizes[level].x,
+                     m_levelSizes[level].y,
+                     0,
+                     GL_RED,
+                     GL_FLOAT,
+                     nullptr);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    state.BindTexture(GL_TEXTURE_2D, 0);
+
+    m_sourceWidth = width;
+    m_sourceHeight = height;
+    return true;
+}
+
+void HiZOcclusion::Build(GLuint depthTexture, int width, int height, const glm::mat4& viewProjection, GLuint quadVAO)
+{
+    if (depthTexture == 0 || m_downsampleShader.program == 0 || width <= 0 || height <= 0)
+    {
+        return;
+    }
+    // Todas as leituras ainda em voo: a GPU está atrasada, não empilha mais trabalho.
+    ReadbackSlot& slot = m_slots[static_cast<std::size_t>(m_nextSlot)];
+    if (slot.fence != nullptr || !EnsurePyramid(width, height))
+    {
+        return;
+    }
+
+    RenderStateCache& state = RenderStateCache::Get();
+    state.BindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+    state.Disable(GL_DEPTH_TEST);
+    m_downsampleShader.Use();
+    state.BindVertexArray(quadVAO);
+    state.ActiveTexture(GL_TEXTURE0);
+
+    glm::ivec2 sourceSize(width, height);
+    for (std::size_t level = 0; level < m_levelSizes.size(); ++level)
+    {
+        if (level == 0)
+        {
+            state.BindTexture(GL_TEXTURE_2D, depthTexture);
+        }
+        else
+        {
+            // Lê só o nível anterior enquanto escreve o atual: sem laço de feedback na mesma textura.
+            state.BindTexture(GL_TEXTURE_2D, m_pyramid);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, static_cast<GLint>(level - 1));
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(level - 1));
+        }
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_pyramid, static_cast<GLint>(level));
+        const glm::ivec2& targetSize = m_levelSizes[level];
+        state.Viewport(0, 0, targetSize.x, targetSize.y);
+        glUniform2i(m_sourceSizeLoc, sourceSize.x, sourceSize.y);
+        glDrawArrays(GL_TRIANGLES, 0, 6);
+
+        if (static_cast<int>(level) == m_readbackLevel)
+        {
+            slot.width = targetSize.x;
+            slot.height = targetSize.y;
+            slot.byteCount = static_cast<std::size_t>(targetSize.x) * static_cast<std::size_t>(targetSize.y) * sizeof(float);
+            state.BindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+            glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(slot.byteCount), nullptr, GL_STREAM_READ);
+            glReadPixels(0, 0, targetSize.x, targetSize.y, GL_RED, GL_FLOAT, nullptr);
+            state.BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            slot.viewProjection = viewProjection;
+            slot.sourceWidth = width;
+            slot.sourceHeight = height;
+            slot.shift = m_readbackLevel + 1;
+            slot.serial = m_nextSerial++;
+            m_nextSlot = (m_nextSlot + 1) % kReadbackSlots;
+        }
+        sourceSize = targetSize;
+    }
+
+    state.BindTexture(GL_TEXTURE_2D, 0);
+    state.Enable(GL_DEPTH_TEST);
+    state.BindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void HiZOcclusion::ResolveReadback()
+{
+    ReadbackSlot* newest = nullptr;
+    for (ReadbackSlot& slot : m_slots)
+    {
+        if (slot.fence == nullptr)
+        {
+            continue;
+        }
+        const GLenum status = glClientWaitSync(slot.fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+        {
+            continue;
+        }
+        if (newest == nullptr || slot.serial > newest->serial)
+        {
+            newest = &slot;
+        }
+    }
+    if (newest == nullptr)
+    {
+        return;
+    }
+
+    RenderStateCache& state = RenderStateCache::Get();
+    state.BindBuffer(GL_PIXEL_PACK_BUFFER, newest->buffer);
+    const void* mapped =
+        glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(newest->byteCount), GL_MAP_READ_BIT);
+    if (mapped != nullptr)
+    {
+        m_cpuLevels.resize(1);
+        CpuLevel& base = m_cpuLevels[0];
+        base.width = newest->width;
+        base.height = newest->height;
+        base.depth.resize(newest->byteCount / sizeof(float));
+        std::memcpy(base.depth.data(), mapped, newest->byteCount);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+
+        m_cpuViewProjection = newest->viewProjection;
+        m_cpuSourceWidth = newest->sourceWidth;
+        m_cpuSourceHeight = newest->sourceHeight;
+        m_cpuShift = newest->shift;
+
+        // Completa a cadeia até 1x1 com a mesma redução do shader.
+        while (m_cpuLevels.back().width > 1 || m_cpuLevels.back().height > 1)
+        {
+            const CpuLevel& source = m_cpuLevels.back();
+            CpuLevel target;
+            target.width = std::max(source.width / 2, 1);
+            target.height = std::max(source.height / 2, 1);
+            target.depth.resize(static_cast<std::size_t>(target.width) * static_cast<std::size_t>(target.height));
+            for (int y = 0; y < target.height; ++y)
+            {
+                const int lastY = y == target.height - 1 ? source.height - 1 : std::min(y * 2 + 1, source.height - 1);
+                for (int x = 0; x < target.width; ++x)
+                {
+                    const int lastX = x == target.width - 1 ? source.width - 1 : std::min(x * 2 + 1, source.width - 1);
+                    float farthest = 0.0f;
+                    for (int sy = y * 2; sy <= lastY; ++sy)
+                    {
+                        for (int sx = x * 2; sx <= lastX; ++sx)
+                        {
+                            farthest = std::max(farthest, source.depth[static_cast<std::size_t>(sy * source.width + sx)]);
+                        }
+                    }
+                    target.depth[static_cast<std::size_t>(y * target.width + x)] = farthest;
+                }
+            }
+            m_cpuLevels.push_back(std::move(target));
+        }
+    }
+    state.BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    // Leituras anteriores à adotada ficaram obsoletas.
+    const std::size_t adoptedSerial = newest->serial;
+    for (ReadbackSlot& slot : m_slots)
+    {
+        if (slot.fence != nullptr && slot.serial <= adoptedSerial)
+        {
+            ReleaseSlot(slot);
+        }
+    }
+}
+
+bool HiZOcclusion::IsSphereOccluded(const glm::vec3& center, float radius) const
+{
+    if (m_cpuLevels.empty())
+    {
+        return false;
+    }
+
+    // Retângulo de tela e depth mais próxima da AABB da esfera na projeção do frame lido.
+    glm::vec2 ndcMin(std::numeric_limits<float>::max());
+    glm::vec2 ndcMax(-std::numeric_limits<float>::max());
+    float nearestNdcZ = std::numeric_limits<float>::max();
+    for (int corner = 0; corner < 8; ++corner)
+    {
+        const glm::vec3 offset((corner & 1) != 0 ? radius : -radius,
+                               (corner & 2) != 0 ? radius : -radius,
+                               (corner & 4) != 0 ? radius : -radius);
+        const glm::vec4 clip = m_cpuViewProjection * glm::vec4(center + offset, 1.0f);
+        if (clip.w <= kMinClipW)
+        {
+            return false;
+        }
+        const glm::vec3 ndc = glm::vec3(clip) / clip.w;
+        ndcMin = glm::min(ndcMin, glm::vec2(ndc.x, ndc.y));
+        ndcMax = glm::max(ndcMax, glm::vec2(ndc.x, ndc.y));
+        nearestNdcZ = std::min(nearestNdcZ, ndc.z);
+    }
+    // Cruza o near plane ou estava fora da vista lida: não há depth que prove a oclusão.
+    if (nearestNdcZ < -1.0f || ndcMax.x < -1.0f || ndcMin.x > 1.0f || ndcMax.y < -1.0f || ndcMin.y > 1.0f)
+    {
+        return false;
+    }
+    const float nearestDepth = nearestNdcZ * 0.5f + 0.5f;
+
+    const CpuLevel& base = m_cpuLevels.front();
+    const int x0 = ToCoarseIndex(ToPixel(ndcMin.x, m_cpuSourceWidth), m_cpuShift, base.width);
+    const int x1 = ToCoarseIndex(ToPixel(ndcMax.x, m_cpuSourceWidth), m_cpuShift, base.width);
+    const int y0 = ToCoarseIndex(ToPixel(ndcMin.y, m_cpuSourceHeight), m_cpuShift, base.height);
+    const int y1 = ToCoarseIndex(ToPixel(ndcMax.y, m_cpuSourceHeight), m_cpuShift, base.height);
+
+    // Nível em que o retângulo cabe em poucos texels (no máximo 3x3).
+    const int extent = std::max(x1 - x0, y1 - y0);
+    int level = 0;
+    while (level + 1 < static_cast<int>(m_cpuLevels.size()) && (extent >> level) > 1)
+    {
+        ++level;
+    }
+
+    const CpuLevel& selected = m_cpuLevels[static_cast<std::size_t>(level)];
+    const int levelX0 = ToCoarseIndex(x0, level, selected.width);
+    const int levelX1 = ToCoarseIndex(x1, level, selected.width);
+    const int levelY0 = ToCoarseIndex(y0, level, selected.height);
+    const int levelY1 = ToCoarseIndex(y1, level, selected.height);
+    for (int y = levelY0; y <= levelY1; ++y)
+    {
+        for (int x = levelX0; x <= levelX1; ++x)
+        {
+            if (selected.depth[static_cast<std::size_t>(y * selected.width + x)] >= nearestDepth)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include "shader_program.h"
+
+/// @brief Oclusão por pirâmide hierárquica de depth (Hi-Z) com um frame de atraso.
+/// Depois da passada de cena a depth é reduzida por máximo até 1x1 na GPU; um nível grosso é lido por PBO
+/// e, assim que a fence sinaliza, a CPU completa a cadeia e testa esferas reprojetadas com a
+/// view-projection do frame que gerou a depth. Só descarta o que está garantidamente atrás dela.
+class HiZOcclusion
+{
+public:
+    /// Nível lido de volta: o primeiro da pirâmide com largura até este limite.
+    static constexpr int kReadbackMaxWidth = 128;
+    static constexpr int kReadbackSlots = 3;
+
+    HiZOcclusion() = default;
+    ~HiZOcclusion();
+
+    HiZOcclusion(const HiZOcclusion&) = delete;
+    HiZOcclusion& operator=(const HiZOcclusion&) = delete;
+
+    bool Create();
+    void Destroy();
+
+    /// @brief Adota a leitura mais recente já concluída pela GPU; chamado no começo do frame.
+    void ResolveReadback();
+    /// @brief Reduz a depth (textura de depth do alvo, width x height) e agenda a leitura do nível grosso.
+    /// Altera viewport, programa, VAO e a textura da unidade 0; termina no framebuffer padrão.
+    void Build(GLuint depthTexture, int width, int height, const glm::mat4& viewProjection, GLuint quadVAO);
+    /// @brief Descarta a pirâmide da CPU e as leituras pendentes (ex.: oclusão desligada ou cena trocada).
+    void Invalidate();
+
+    bool HasData() const { return !m_cpuLevels.empty(); }
+    /// @brief true se a esfera está inteira atrás da depth do frame lido; sem dados, nunca oclui.
+    bool IsSphereOccluded(const glm::vec3& center, float radius) const;
+
+private:
+    struct ReadbackSlot
+    {
+        GLuint buffer = 0;
+        GLsync fence = nullptr;
+        glm::mat4 viewProjection{ 1.0f };
+        int width = 0;      ///< Tamanho do nível lido.
+        int height = 0;
+        int sourceWidth = 0; ///< Tamanho da depth que gerou a pirâmide.
+        int sourceHeight = 0;
+        int shift = 0;       ///< Pixels da depth por texel lido = 2^shift em cada eixo.
+        std::size_t byteCount = 0;
+        std::size_t serial = 0;
+    };
+
+    struct CpuLevel
+    {
+        int width = 0;
+        int height = 0;
+        std::vector<float> depth;
+    };
+
+    bool EnsurePyramid(int width, int height);
+    void DestroyPyramid();
+    void ReleaseSlot(ReadbackSlot& slot);
+
+    ShaderProgram m_downsampleShader;
+    GLint m_sourceSizeLoc = -1;
+    GLuint m_framebuffer = 0;
+    GLuint m_pyramid = 0;
+    std::vector<glm::ivec2> m_levelSizes;
+    int m_readbackLevel = 0;
+    int m_sourceWidth = 0;
+    int m_sourceHeight = 0;
+
+    std::array<ReadbackSlot, kReadbackSlots> m_slots{};
+    int m_nextSlot = 0;
+    std::size_t m_nextSerial = 1;
+
+    // Cadeia da CPU: nível 0 é o nível lido da GPU.
+    std::vector<CpuLevel> m_cpuLevels;
+    glm::mat4 m_cpuViewProjection{ 1.0f };
+    int m_cpuSourceWidth = 0;
+    int m_cpuSourceHeight = 0;
+    int m_cpuShift = 0;
+};
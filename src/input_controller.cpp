@@ -1,5 +1,7 @@
 #include "input_controller.h"
 
+#include "render_state.h"
+
 #include <iostream>
 
 InputController* InputController::s_instance = nullptr;
@@ -52,7 +54,7 @@ void InputController::ProcessInput(float deltaTime)
 
 void InputController::FramebufferSizeCallback(GLFWwindow*, int width, int height)
 {
-    glViewport(0, 0, width, height);
+    RenderStateCache::Get().Viewport(0, 0, width, height);
 }
 
 void InputController::MouseCallback(GLFWwindow* window, double xpos, double ypos)
@@ -0,0 +1,350 @@
+#include "light_clusters.h"
+
+#include "render_state.h"
+
+#include <xmmintrin.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <future>
+#include <iostream>
+#include <thread>
+
+namespace
+{
+constexpr int kTilesPerSlice = LightClusterGrid::kTilesX * LightClusterGrid::kTilesY;
+// Abaixo disso o custo de acordar as threads supera a atribuição em si.
+constexpr std::size_t kParallelLightThreshold = 64;
+constexpr unsigned int kMaxAssignTasks = 4;
+
+static_assert(kTilesPerSlice % 4 == 0, "Tiles por fatia precisam ser múltiplos de 4 para o teste SSE");
+
+GLuint CreateBufferTexture(GLuint& buffer, GLenum internalFormat)
+{
+    RenderStateCache& state = RenderStateCache::Get();
+    glGenBuffers(1, &buffer);
+    state.BindBuffer(GL_TEXTURE_BUFFER, buffer);
+    glBufferData(GL_TEXTURE_BUFFER, 16, nullptr, GL_STREAM_DRAW);
+
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    state.BindTexture(GL_TEXTURE_BUFFER, texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, internalFormat, buffer);
+    return texture;
+}
+
+void UploadBufferData(GLuint buffer, const void* data, std::size_t size)
+{
+    // Orphaning: o driver entrega storage novo enquanto o frame anterior ainda lê o antigo.
+    const GLsizeiptr byteCount = static_cast<GLsizeiptr>(std::max<std::size_t>(size, 16));
+    RenderStateCache::Get().BindBuffer(GL_TEXTURE_BUFFER, buffer);
+    glBufferData(GL_TEXTURE_BUFFER, byteCount, nullptr, GL_STREAM_DRAW);
+    if (size > 0)
+    {
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, static_cast<GLsizeiptr>(size), data);
+    }
+}
+}
+
+LightClusterGrid::~LightClusterGrid()
+{
+    Destroy();
+}
+
+bool LightClusterGrid::Create()
+{
+    Destroy();
+    if (glTexBuffer == nullptr)
+    {
+        std::cerr << "Texture buffers indisponíveis; clustered lighting desativado." << std::endl;
+        return false;
+    }
+
+    m_lightDataTexture = CreateBufferTexture(m_lightDataBuffer, GL_RGBA32F);
+    m_rangesTexture = CreateBufferTexture(m_rangesBuffer, GL_RG32UI);
+    m_indicesTexture = CreateBufferTexture(m_indicesBuffer, GL_R32UI);
+    if (m_lightDataTexture == 0 || m_rangesTexture == 0 || m_indicesTexture == 0)
+    {
+        std::cerr << "Falha ao criar texture buffers do clustered lighting." << std::endl;
+        Destroy();
+        return false;
+    }
+
+    m_clusterCounts.assign(kClusterCount, 0);
+    m_clusterScratch.assign(static_cast<std::size_t>(kClusterCount) * kMaxLightsPerCluster, 0);
+    m_clusterRanges.assign(static_cast<std::size_t>(kClusterCount) * 2, 0);
+    m_boundsKey = glm::vec4(0.0f);
+    return true;
+}
+
+void LightClusterGrid::Destroy()
+{
+    for (GLuint* texture : { &m_lightDataTexture, &m_rangesTexture, &m_indicesTexture })
+    {
+        if (*texture != 0)
+        {
+            RenderStateCache::Get().DeleteTexture(*texture);
+            *texture = 0;
+        }
+    }
+    for (GLuint* buffer : { &m_lightDataBuffer, &m_rangesBuffer, &m_indicesBuffer })
+    {
+        if (*buffer != 0)
+        {
+            RenderStateCache::Get().DeleteBuffer(*buffer);
+            *buffer = 0;
+        }
+    }
+}
+
+void LightClusterGrid::RebuildClusterBounds(float tanHalfFovX, float tanHalfFovY, float nearPlane, float farPlane)
+{
+    m_nearPlane = nearPlane;
+    m_farPlane = farPlane;
+    const float logRatio = std::log(farPlane / nearPlane);
+    m_sliceScale = static_cast<float>(kSlicesZ) / logRatio;
+    m_sliceBias = static_cast<float>(kSlicesZ) * std::log(nearPlane) / logRatio;
+
+    m_sliceNear.resize(kSlicesZ);
+    m_sliceFar.resize(kSlicesZ);
+    m_boundsMinX.resize(kClusterCount);
+    m_boundsMaxX.resize(kClusterCount);
+    m_boundsMinY.resize(kClusterCount);
+    m_boundsMaxY.resize(kClusterCount);
+
+    for (int slice = 0; slice < kSlicesZ; ++slice)
+    {
+        // Fatias exponenciais: cada uma cobre a mesma razão far/near, clusters quase cúbicos.
+        const float sliceNear = nearPlane * std::pow(farPlane / nearPlane, static_cast<float>(slice) / kSlicesZ);
+        const float sliceFar = nearPlane * std::pow(farPlane / nearPlane, static_cast<float>(slice + 1) / kSlicesZ);
+        m_sliceNear[slice] = sliceNear;
+        m_sliceFar[slice] = sliceFar;
+
+        for (int tileY = 0; tileY < kTilesY; ++tileY)
+        {
+            const float ndcY0 = -1.0f + 2.0f * static_cast<float>(tileY) / kTilesY;
+            const float ndcY1 = -1.0f + 2.0f * static_cast<float>(tileY + 1) / kTilesY;
+            for (int tileX = 0; tileX < kTilesX; ++tileX)
+            {
+                const float ndcX0 = -1.0f + 2.0f * static_cast<float>(tileX) / kTilesX;
+                const float ndcX1 = -1.0f + 2.0f * static_cast<float>(tileX + 1) / kTilesX;
+                const int cluster = tileX + kTilesX * (tileY + kTilesY * slice);
+
+                // O tile abre com a profundidade: a AABB envolve as seções nas duas pontas da fatia.
+                m_boundsMinX[cluster] = std::min(ndcX0 * tanHalfFovX * sliceNear, ndcX0 * tanHalfFovX * sliceFar);
+                m_boundsMaxX[cluster] = std::max(ndcX1 * tanHalfFovX * sliceNear, ndcX1 * tanHalfFovX * sliceFar);
+                m_boundsMinY[cluster] = std::min(ndcY0 * tanHalfFovY * sliceNear, ndcY0 * tanHalfFovY * sliceFar);
+                m_boundsMaxY[cluster] = std::max(ndcY1 * tanHalfFovY * sliceNear, ndcY1 * tanHalfFovY * sliceFar);
+            }
+        }
+    }
+}
+
+int LightClusterGrid::SliceForDepth(float depth) const
+{
+    if (depth <= m_nearPlane)
+    {
+        return 0;
+    }
+    const int slice = static_cast<int>(std::floor(std::log(depth) * m_sliceScale - m_sliceBias));
+    return std::clamp(slice, 0, kSlicesZ - 1);
+}
+
+void LightClusterGrid::Build(const glm::mat4& view,
+                             float fovYRadians,
+                             float aspectRatio,
+                             float nearPlane,
+                             float farPlane,
+                             const std::vector<PointLight>& lights)
+{
+    const auto startTime = std::chrono::steady_clock::now();
+    if (m_clusterCounts.empty())
+    {
+        return;
+    }
+
+    const float tanHalfFovY = std::tan(fovYRadians * 0.5f);
+    const float tanHalfFovX = tanHalfFovY * aspectRatio;
+    const glm::vec4 boundsKey(tanHalfFovX, tanHalfFovY, nearPlane, farPlane);
+    if (boundsKey != m_boundsKey)
+    {
+        RebuildClusterBounds(tanHalfFovX, tanHalfFovY, nearPlane, farPlane);
+        m_boundsKey = boundsKey;
+    }
+
+    m_viewLights.clear();
+    m_viewLightIndices.clear();
+    for (std::size_t i = 0; i < lights.size(); ++i)
+    {
+        const PointLight& light = lights[i];
+        const glm::vec4 viewPosition = view * glm::vec4(light.position, 1.0f);
+        const float depth = -viewPosition.z;
+        if (light.range <= 0.0f || depth + light.range < nearPlane || depth - light.range > farPlane)
+        {
+            continue;
+        }
+        m_viewLights.emplace_back(viewPosition.x, viewPosition.y, depth, light.range);
+        m_viewLightIndices.push_back(static_cast<std::uint32_t>(i));
+    }
+
+    std::fill(m_clusterCounts.begin(), m_clusterCounts.end(), 0u);
+
+    // Cada tarefa é dona de um bloco contíguo de fatias: nenhum cluster é escrito por duas threads.
+    const unsigned int hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+    const unsigned int taskCount =
+        m_viewLights.size() >= kParallelLightThreshold ? std::min(hardwareThreads, kMaxAssignTasks) : 1u;
+    const int slicesPerTask = (kSlicesZ + static_cast<int>(taskCount) - 1) / static_cast<int>(taskCount);
+    std::vector<std::future<void>> tasks;
+    tasks.reserve(taskCount);
+    for (unsigned int task = 1; task < taskCount; ++task)
+    {
+        const int firstSlice = static_cast<int>(task) * slicesPerTask;
+        const int lastSlice = std::min(firstSlice + slicesPerTask, kSlicesZ) - 1;
+        if (firstSlice <= lastSlice)
+        {
+            tasks.push_back(std::async(std::launch::async, [this, firstSlice, lastSlice]() {
+                AssignSlices(firstSlice, lastSlice);
+            }));
+        }
+    }
+    AssignSlices(0, std::min(slicesPerTask, kSlicesZ) - 1);
+    for (auto& task : tasks)
+    {
+        task.get();
+    }
+
+    // Compacta as listas de tamanho fixo em (offset, count) + um array único de índices.
+    m_stats = {};
+    m_stats.lights = lights.size();
+    m_lightIndices.clear();
+    for (int cluster = 0; cluster < kClusterCount; ++cluster)
+    {
+        const std::uint32_t count = m_clusterCounts[cluster];
+        m_clusterRanges[cluster * 2] = static_cast<std::uint32_t>(m_lightIndices.size());
+        m_clusterRanges[cluster * 2 + 1] = std::min<std::uint32_t>(count, kMaxLightsPerCluster);
+        if (count == 0)
+        {
+            continue;
+        }
+        const auto first = m_clusterScratch.begin() + static_cast<std::ptrdiff_t>(cluster) * kMaxLightsPerCluster;
+        m_lightIndices.insert(m_lightIndices.end(), first, first + std::min<std::uint32_t>(count, kMaxLightsPerCluster));
+        ++m_stats.occupiedClusters;
+        m_stats.maxLightsInCluster = std::max<std::size_t>(m_stats.maxLightsInCluster, count);
+        if (count > kMaxLightsPerCluster)
+        {
+            ++m_stats.overflowedClusters;
+        }
+    }
+    m_stats.lightReferences = m_lightIndices.size();
+    m_stats.assignMs =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+void LightClusterGrid::AssignSlices(int firstSlice, int lastSlice)
+{
+    const __m128 zero = _mm_setzero_ps();
+    for (std::size_t i = 0; i < m_viewLights.size(); ++i)
+    {
+        const glm::vec4& light = m_viewLights[i];
+        const int lightFirstSlice = std::max(SliceForDepth(light.z - light.w), firstSlice);
+        const int lightLastSlice = std::min(SliceForDepth(light.z + light.w), lastSlice);
+        if (lightFirstSlice > lightLastSlice)
+        {
+            continue;
+        }
+
+        const std::uint32_t lightIndex = m_viewLightIndices[i];
+        const float radiusSquared = light.w * light.w;
+        const __m128 centerX = _mm_set1_ps(light.x);
+        const __m128 centerY = _mm_set1_ps(light.y);
+        const __m128 radiusSq = _mm_set1_ps(radiusSquared);
+
+        for (int slice = lightFirstSlice; slice <= lightLastSlice; ++slice)
+        {
+            const float dz = std::max({ 0.0f, m_sliceNear[slice] - light.z, light.z - m_sliceFar[slice] });
+            const float dzSquared = dz * dz;
+            if (dzSquared > radiusSquared)
+            {
+                continue;
+            }
+            const __m128 distanceZ = _mm_set1_ps(dzSquared);
+            const int sliceBase = slice * kTilesPerSlice;
+
+            // Esfera x AABB para quatro clusters por iteração: distância ao quadrado até a caixa <= raio².
+            for (int tile = 0; tile < kTilesPerSlice; tile += 4)
+            {
+                const int cluster = sliceBase + tile;
+                __m128 dx = _mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&m_boundsMinX[cluster]), centerX),
+                                       _mm_sub_ps(centerX, _mm_loadu_ps(&m_boundsMaxX[cluster])));
+                __m128 dy = _mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&m_boundsMinY[cluster]), centerY),
+                                       _mm_sub_ps(centerY, _mm_loadu_ps(&m_boundsMaxY[cluster])));
+                dx = _mm_max_ps(dx, zero);
+                dy = _mm_max_ps(dy, zero);
+                const __m128 distanceSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), distanceZ);
+                const int mask = _mm_movemask_ps(_mm_cmple_ps(distanceSq, radiusSq));
+                if (mask == 0)
+                {
+                    continue;
+                }
+                for (int lane = 0; lane < 4; ++lane)
+                {
+                    if ((mask & (1 << lane)) == 0)
+                    {
+                        continue;
+                    }
+                    std::uint32_t& count = m_clusterCounts[cluster + lane];
+                    if (count < kMaxLightsPerCluster)
+                    {
+                        m_clusterScratch[static_cast<std::size_t>(cluster + lane) * kMaxLightsPerCluster + count] = lightIndex;
+                    }
+                    ++count;
+                }
+            }
+        }
+    }
+}
+
+void LightClusterGrid::Upload(const std::vector<PointLight>& lights)
+{
+    if (!IsValid())
+    {
+        return;
+    }
+
+    m_gpuLights.resize(lights.size());
+    for (std::size_t i = 0; i < lights.size(); ++i)
+    {
+        const PointLight& light = lights[i];
+        PointLightStd140& target = m_gpuLights[i];
+        target.position = light.position;
+        target.constant = light.constant;
+        target.ambient = light.ambient;
+        target.linear = light.linear;
+        target.diffuse = light.diffuse;
+        target.quadratic = light.quadratic;
+        target.specular = light.specular;
+        target.range = light.range;
+    }
+
+    UploadBufferData(m_lightDataBuffer, m_gpuLights.data(), m_gpuLights.size() * sizeof(PointLightStd140));
+    UploadBufferData(m_rangesBuffer, m_clusterRanges.data(), m_clusterRanges.size() * sizeof(std::uint32_t));
+    UploadBufferData(m_indicesBuffer, m_lightIndices.data(), m_lightIndices.size() * sizeof(std::uint32_t));
+}
+
+void LightClusterGrid::Bind() const
+{
+    RenderStateCache& state = RenderStateCache::Get();
+    state.BindTextureUnit(GL_TEXTURE0 + kLightDataTextureUnit, GL_TEXTURE_BUFFER, m_lightDataTexture);
+    state.BindTextureUnit(GL_TEXTURE0 + kRangesTextureUnit, GL_TEXTURE_BUFFER, m_rangesTexture);
+    state.BindTextureUnit(GL_TEXTURE0 + kIndicesTextureUnit, GL_TEXTURE_BUFFER, m_indicesTexture);
+}
+
+void LightClusterGrid::WriteUniforms(LightUniformBlock& block, int viewportWidth, int viewportHeight) const
+{
+    block.pointCount = IsValid() ? static_cast<int>(m_gpuLights.size()) : 0;
+    block.clusterGrid = glm::ivec4(kTilesX, kTilesY, kSlicesZ, 0);
+    block.clusterDepthParams = glm::vec4(m_sliceScale, m_sliceBias, m_nearPlane, m_farPlane);
+    block.clusterTileSize = glm::vec2(static_cast<float>(std::max(viewportWidth, 1)) / kTilesX,
+                                      static_cast<float>(std::max(viewportHeight, 1)) / kTilesY);
+}
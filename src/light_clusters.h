@@ -0,0 +1,101 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "light_manager.h"
+
+struct LightClusterStats
+{
+    std::size_t lights = 0;
+    std::size_t lightReferences = 0;
+    std::size_t occupiedClusters = 0;
+    std::size_t maxLightsInCluster = 0;
+    std::size_t overflowedClusters = 0;
+    double assignMs = 0.0;
+};
+
+/// @brief Clustered forward: divide o frustum da câmera em tiles de tela x fatias exponenciais de profundidade
+/// e atribui as point lights a cada cluster na CPU (SSE, fatias repartidas entre threads).
+/// As listas vão para a GPU em texture buffers; o fragment shader avalia só as luzes do seu cluster.
+class LightClusterGrid
+{
+public:
+    static constexpr int kTilesX = 16;
+    static constexpr int kTilesY = 9;
+    static constexpr int kSlicesZ = 24;
+    static constexpr int kClusterCount = kTilesX * kTilesY * kSlicesZ;
+    static constexpr int kMaxLightsPerCluster = 256;
+
+    /// Unidades de textura dos samplers pointLightData, clusterRanges e clusterLightIndices.
+    static constexpr GLint kLightDataTextureUnit = 3;
+    static constexpr GLint kRangesTextureUnit = 4;
+    static constexpr GLint kIndicesTextureUnit = 5;
+
+    LightClusterGrid() = default;
+    ~LightClusterGrid();
+
+    LightClusterGrid(const LightClusterGrid&) = delete;
+    LightClusterGrid& operator=(const LightClusterGrid&) = delete;
+
+    bool Create();
+    void Destroy();
+
+    /// @brief Atribui as luzes aos clusters do frustum descrito (projeção perspectiva simétrica).
+    void Build(const glm::mat4& view,
+               float fovYRadians,
+               float aspectRatio,
+               float nearPlane,
+               float farPlane,
+               const std::vector<PointLight>& lights);
+
+    /// @brief Envia dados das luzes, faixas por cluster e lista de índices do último Build.
+    void Upload(const std::vector<PointLight>& lights);
+    void Bind() const;
+
+    /// @brief Preenche os parâmetros do grid no bloco LightData para a resolução do alvo de render.
+    void WriteUniforms(LightUniformBlock& block, int viewportWidth, int viewportHeight) const;
+
+    bool IsValid() const { return m_lightDataBuffer != 0; }
+    const LightClusterStats& GetStats() const { return m_stats; }
+
+private:
+    void RebuildClusterBounds(float tanHalfFovX, float tanHalfFovY, float nearPlane, float farPlane);
+    void AssignSlices(int firstSlice, int lastSlice);
+    int SliceForDepth(float depth) const;
+
+    GLuint m_lightDataBuffer = 0;
+    GLuint m_lightDataTexture = 0;
+    GLuint m_rangesBuffer = 0;
+    GLuint m_rangesTexture = 0;
+    GLuint m_indicesBuffer = 0;
+    GLuint m_indicesTexture = 0;
+
+    // AABBs dos clusters em espaço de vista (profundidade positiva), SoA para o teste SSE.
+    std::vector<float> m_boundsMinX;
+    std::vector<float> m_boundsMaxX;
+    std::vector<float> m_boundsMinY;
+    std::vector<float> m_boundsMaxY;
+    std::vector<float> m_sliceNear;
+    std::vector<float> m_sliceFar;
+    glm::vec4 m_boundsKey{ 0.0f };
+    float m_nearPlane = 0.1f;
+    float m_farPlane = 100.0f;
+    float m_sliceScale = 0.0f;
+    float m_sliceBias = 0.0f;
+
+    // Luzes em espaço de vista do frame corrente, já filtradas pela faixa de profundidade do frustum.
+    std::vector<glm::vec4> m_viewLights;
+    std::vector<std::uint32_t> m_viewLightIndices;
+
+    std::vector<std::uint32_t> m_clusterCounts;
+    std::vector<std::uint32_t> m_clusterScratch;
+    std::vector<std::uint32_t> m_clusterRanges;
+    std::vector<std::uint32_t> m_lightIndices;
+    std::vector<PointLightStd140> m_gpuLights;
+    LightClusterStats m_stats{};
+};
@@ -24,21 +24,18 @@ void DirectionalLightManager::AddLight(const DirectionalLight& light)
     }
 }
 
-void DirectionalLightManager::Upload(GLuint program, float time) const
+void DirectionalLightManager::WriteUniforms(LightUniformBlock& block, float time) const
 {
-    const GLint directionalCountLoc = glGetUniformLocation(program, "directionalCount");
-    const int count = GetCount();
-    glUniform1i(directionalCountLoc, count);
+    const int count = std::min(GetCount(), kMaxDirectionalLights);
+    block.directionalCount = count;
 
     for (int i = 0; i < count; ++i) {
         const DirectionalLight& light = m_lights[i];
-        const glm::vec3 direction = light.GetDirection(time);
-
-        const std::string base = "dirLights[" + std::to_string(i) + "]";
-        glUniform3fv(glGetUniformLocation(program, (base + ".direction").c_str()), 1, glm::value_ptr(direction));
-        glUniform3fv(glGetUniformLocation(program, (base + ".ambient").c_str()), 1, glm::value_ptr(light.ambient));
-        glUniform3fv(glGetUniformLocation(program, (base + ".diffuse").c_str()), 1, glm::value_ptr(light.diffuse));
-        glUniform3fv(glGetUniformLocation(program, (base + ".specular").c_str()), 1, glm::value_ptr(light.specular));
+        DirectionalLightStd140& target = block.dirLights[i];
+        target.direction = light.GetDirection(time);
+        target.ambient = light.ambient;
+        target.diffuse = light.diffuse;
+        target.specular = light.specular;
     }
 }
 
@@ -89,27 +86,6 @@ int PointLightManager::GetCount() const
     return static_cast<int>(std::min(m_lights.size(), static_cast<size_t>(m_maxLights)));
 }
 
-void PointLightManager::Upload(GLuint program) const
-{
-    const GLint pointCountLoc = glGetUniformLocation(program, "pointCount");
-    const int count = GetCount();
-    glUniform1i(pointCountLoc, count);
-
-    for (int i = 0; i < count; ++i) {
-        const PointLight& light = m_lights[i];
-        const std::string base = "pointLights[" + std::to_string(i) + "]";
-
-        glUniform3fv(glGetUniformLocation(program, (base + ".position").c_str()), 1, glm::value_ptr(light.position));
-        glUniform3fv(glGetUniformLocation(program, (base + ".ambient").c_str()), 1, glm::value_ptr(light.ambient));
-        glUniform3fv(glGetUniformLocation(program, (base + ".diffuse").c_str()), 1, glm::value_ptr(light.diffuse));
-        glUniform3fv(glGetUniformLocation(program, (base + ".specular").c_str()), 1, glm::value_ptr(light.specular));
-        glUniform1f(glGetUniformLocation(program, (base + ".constant").c_str()), light.constant);
-        glUniform1f(glGetUniformLocation(program, (base + ".linear").c_str()), light.linear);
-        glUniform1f(glGetUniformLocation(program, (base + ".quadratic").c_str()), light.quadratic);
-        glUniform1f(glGetUniformLocation(program, (base + ".range").c_str()), light.range);
-    }
-}
-
 void PointLightManager::Clear()
 {
     m_lights.clear();
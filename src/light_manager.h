@@ -7,6 +7,10 @@
 #include <algorithm>
 #include <string>
 
+constexpr int kMaxDirectionalLights = 4;
+// Point lights vão por texture buffer e são avaliadas só nos clusters que tocam (LightClusterGrid).
+constexpr int kMaxPointLights = 1024;
+
 struct DirectionalLight
 {
     glm::vec3 direction;
@@ -47,13 +51,59 @@ struct SpotLight
     float range = 15.0f;
 };
 
+/// @brief Layout std140 de DirectionalLight em fragment.glsl (vec3 ocupa 16 bytes).
+struct DirectionalLightStd140
+{
+    glm::vec3 direction{ 0.0f };
+    float padding0 = 0.0f;
+    glm::vec3 ambient{ 0.0f };
+    float padding1 = 0.0f;
+    glm::vec3 diffuse{ 0.0f };
+    float padding2 = 0.0f;
+    glm::vec3 specular{ 0.0f };
+    float padding3 = 0.0f;
+};
+
+/// @brief PointLight no texture buffer pointLightData: quatro texels RGBA32F, escalares no lugar do padding.
+struct PointLightStd140
+{
+    glm::vec3 position{ 0.0f };
+    float constant = 1.0f;
+    glm::vec3 ambient{ 0.0f };
+    float linear = 0.0f;
+    glm::vec3 diffuse{ 0.0f };
+    float quadratic = 0.0f;
+    glm::vec3 specular{ 0.0f };
+    float range = 0.0f;
+};
+
+/// @brief Conteúdo do uniform block LightData (binding UniformBlockBinding::Lights).
+struct LightUniformBlock
+{
+    DirectionalLightStd140 dirLights[kMaxDirectionalLights];
+    glm::vec3 pointShadowLightPos{ 0.0f };
+    float shadowFarPlane = 0.0f;
+    int directionalCount = 0;
+    int pointCount = 0;
+    int shadowPointIndex = -1;
+    int padding = 0;
+    glm::ivec4 clusterGrid{ 0 };          ///< Tiles X, tiles Y, fatias Z.
+    glm::vec4 clusterDepthParams{ 0.0f }; ///< Escala e bias de log(profundidade) para a fatia, near, far.
+    glm::vec2 clusterTileSize{ 1.0f };    ///< Tamanho do tile em pixels.
+    glm::vec2 padding1{ 0.0f };
+};
+
+static_assert(sizeof(DirectionalLightStd140) == 64, "DirectionalLightStd140 fora do layout std140");
+static_assert(sizeof(PointLightStd140) == 64, "PointLightStd140 fora do layout std140");
+
 class DirectionalLightManager
 {
 public:
     explicit DirectionalLightManager(int maxLights);
 
     void AddLight(const DirectionalLight& light);
-    void Upload(GLuint program, float time) const;
+    /// @brief Preenche dirLights/directionalCount do bloco de luzes.
+    void WriteUniforms(LightUniformBlock& block, float time) const;
     void Clear();
     int GetCount() const;
 
@@ -71,7 +121,7 @@ public:
     PointLight* GetLightMutable(int index);
     const PointLight* GetLight(int index) const;
     int GetCount() const;
-    void Upload(GLuint program) const;
+    const std::vector<PointLight>& GetLights() const { return m_lights; }
     void Clear();
 
 private:
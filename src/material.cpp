@@ -1,6 +1,6 @@
 #include "material.h"
 
-#include <glm/gtc/type_ptr.hpp>
+#include "render_state.h"
 
 Material::Material(const glm::vec3& ambient,
                    const glm::vec3& diffuse,
@@ -14,17 +14,26 @@ Material::Material(const glm::vec3& ambient,
     , m_diffuseTexture(diffuseTexture)
 {}
 
-void Material::Apply(GLuint program) const
+void Material::Apply() const
 {
-    const GLint ambientLoc = glGetUniformLocation(program, "material.ambient");
-    const GLint diffuseLoc = glGetUniformLocation(program, "material.diffuse");
-    const GLint specularLoc = glGetUniformLocation(program, "material.specular");
-    const GLint shininessLoc = glGetUniformLocation(program, "material.shininess");
+    if (!m_uniformBuffer.IsValid()) {
+        if (!m_uniformBuffer.Create(sizeof(MaterialUniformBlock), UniformBlockBinding::Material)) {
+            return;
+        }
+        m_uniformsDirty = true;
+    }
+
+    if (m_uniformsDirty) {
+        MaterialUniformBlock block;
+        block.ambient = m_ambient;
+        block.diffuse = m_diffuse;
+        block.specular = m_specular;
+        block.shininess = m_shininess;
+        m_uniformBuffer.Update(&block, sizeof(block));
+        m_uniformsDirty = false;
+    }
 
-    glUniform3fv(ambientLoc, 1, glm::value_ptr(m_ambient));
-    glUniform3fv(diffuseLoc, 1, glm::value_ptr(m_diffuse));
-    glUniform3fv(specularLoc, 1, glm::value_ptr(m_specular));
-    glUniform1f(shininessLoc, m_shininess);
+    m_uniformBuffer.Bind();
 }
 
 void Material::BindTexture(GLenum textureUnit) const
@@ -32,8 +41,7 @@ void Material::BindTexture(GLenum textureUnit) const
     if (Texture* activeTexture = GetActiveTexture()) {
         activeTexture->Bind(textureUnit);
     } else {
-        glActiveTexture(textureUnit);
-        glBindTexture(GL_TEXTURE_2D, 0);
+        RenderStateCache::Get().BindTextureUnit(textureUnit, GL_TEXTURE_2D, 0);
     }
 }
 
@@ -4,6 +4,18 @@
 #include <glm/glm.hpp>
 
 #include "texture.h"
+#include "uniform_buffer.h"
+
+/// @brief Layout std140 do uniform block MaterialData em fragment.glsl.
+struct MaterialUniformBlock
+{
+    glm::vec3 ambient{ 0.0f };
+    float padding0 = 0.0f;
+    glm::vec3 diffuse{ 0.0f };
+    float padding1 = 0.0f;
+    glm::vec3 specular{ 0.0f };
+    float shininess = 0.0f;
+};
 
 /// @brief Representa um material Phong com texturas opcionais.
 class Material
@@ -16,19 +28,24 @@ public:
              float shininess,
              Texture* diffuseTexture = nullptr);
 
-    void SetAmbient(const glm::vec3& value) { m_ambient = value; }
-    void SetDiffuse(const glm::vec3& value) { m_diffuse = value; }
-    void SetSpecular(const glm::vec3& value) { m_specular = value; }
-    void SetShininess(float value) { m_shininess = value; }
+    void SetAmbient(const glm::vec3& value) { m_ambient = value; m_uniformsDirty = true; }
+    void SetDiffuse(const glm::vec3& value) { m_diffuse = value; m_uniformsDirty = true; }
+    void SetSpecular(const glm::vec3& value) { m_specular = value; m_uniformsDirty = true; }
+    void SetShininess(float value) { m_shininess = value; m_uniformsDirty = true; }
+    const glm::vec3& GetAmbient() const { return m_ambient; }
+    const glm::vec3& GetDiffuse() const { return m_diffuse; }
+    const glm::vec3& GetSpecular() const { return m_specular; }
+    float GetShininess() const { return m_shininess; }
 
     void SetDiffuseTexture(Texture* texture) { m_diffuseTexture = texture; }
     void SetDiffuseOverride(Texture* texture) { m_overrideTexture = texture; }
     void ClearDiffuseOverride() { m_overrideTexture = nullptr; }
+    Texture* GetDiffuseTexture() const { return m_diffuseTexture; }
     Texture* GetActiveTexture() const { return m_overrideTexture ? m_overrideTexture : m_diffuseTexture; }
     bool HasTexture() const { return GetActiveTexture() != nullptr; }
 
-    /// @brief Aplica os uniforms do material ao shader ativo.
-    void Apply(GLuint program) const;
+    /// @brief Vincula o UBO do material ao binding MaterialData, reenviando os dados só após alterações.
+    void Apply() const;
 
     /// @brief Vincula a textura difusa (se existir) na unidade indicada.
     void BindTexture(GLenum textureUnit = GL_TEXTURE0) const;
@@ -40,5 +57,7 @@ private:
     float m_shininess{ 32.0f };
     Texture* m_diffuseTexture{ nullptr }; // não possui a textura, apenas referência
     Texture* m_overrideTexture{ nullptr };
+    mutable UniformBuffer m_uniformBuffer;
+    mutable bool m_uniformsDirty{ true };
 };
 
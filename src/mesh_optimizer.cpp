@@ -0,0 +1,339 @@
+#include "mesh_optimizer.h"
+
+#include "content_hash.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <unordered_map>
+
+namespace
+{
+// Ordem por overdraw aceita se o ACMR não passar deste fator do resultado do Tipsify.
+constexpr float kOverdrawAcmrThreshold = 1.05f;
+constexpr unsigned int kInvalidIndex = 0xFFFFFFFFu;
+
+// Vértice como palavras de 32 bits: igualdade e hash bit a bit, independentes de -0/+0 e NaN.
+struct VertexKey
+{
+    std::array<std::uint32_t, sizeof(Vertex) / sizeof(std::uint32_t)> words{};
+
+    bool operator==(const VertexKey& other) const { return words == other.words; }
+};
+
+static_assert(sizeof(Vertex) % sizeof(std::uint32_t) == 0, "Vertex deve ser múltiplo de 4 bytes");
+
+struct VertexKeyHash
+{
+    std::size_t operator()(const VertexKey& key) const
+    {
+        return static_cast<std::size_t>(HashBytes(key.words.data(), sizeof(key.words)));
+    }
+};
+
+VertexKey MakeKey(const Vertex& vertex)
+{
+    VertexKey key;
+    std::memcpy(key.words.data(), &vertex, sizeof(Vertex));
+    return key;
+}
+
+// Triângulos adjacentes de cada vértice em CSR: offsets[v]..offsets[v + 1] dentro de triangles.
+struct Adjacency
+{
+    std::vector<unsigned int> offsets;
+    std::vector<unsigned int> triangles;
+};
+
+Adjacency BuildAdjacency(const std::vector<unsigned int>& indices, std::size_t vertexCount)
+{
+    Adjacency adjacency;
+    adjacency.offsets.assign(vertexCount + 1, 0);
+    for (unsigned int index : indices)
+    {
+        ++adjacency.offsets[index + 1];
+    }
+    std::partial_sum(adjacency.offsets.begin(), adjacency.offsets.end(), adjacency.offsets.begin());
+
+    adjacency.triangles.resize(indices.size());
+    std::vector<unsigned int> cursor(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+    for (std::size_t i = 0; i < indices.size(); ++i)
+    {
+        adjacency.triangles[cursor[indices[i]]++] = static_cast<unsigned int>(i / 3);
+    }
+    return adjacency;
+}
+}
+
+MeshOptimizationStats MeshOptimizer::Optimize(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+{
+    MeshOptimizationStats stats;
+    stats.verticesBefore = vertices.size();
+    stats.triangles = indices.size() / 3;
+    if (vertices.empty() || indices.size() < 3 || indices.size() % 3 != 0)
+    {
+        stats.verticesAfter = vertices.size();
+        return stats;
+    }
+
+    const std::size_t missesBefore = CountCacheMisses(indices, vertices.size());
+    stats.acmrBefore = static_cast<float>(missesBefore) / static_cast<float>(stats.triangles);
+    stats.atvrBefore = static_cast<float>(missesBefore) / static_cast<float>(vertices.size());
+
+    WeldVertices(vertices, indices);
+
+    std::vector<std::size_t> clusterStarts;
+    std::vector<unsigned int> cacheOrder = OptimizeVertexCache(indices, vertices.size(), clusterStarts);
+    stats.overdrawClusters = clusterStarts.size();
+
+    std::vector<unsigned int> overdrawOrder = OptimizeOverdraw(cacheOrder, vertices, clusterStarts);
+    const std::size_t cacheMisses = CountCacheMisses(cacheOrder, vertices.size());
+    const std::size_t overdrawMisses = CountCacheMisses(overdrawOrder, vertices.size());
+    stats.overdrawApplied =
+        static_cast<float>(overdrawMisses) <= static_cast<float>(cacheMisses) * kOverdrawAcmrThreshold;
+    indices = stats.overdrawApplied ? std::move(overdrawOrder) : std::move(cacheOrder);
+
+    OptimizeVertexFetch(vertices, indices);
+
+    const std::size_t missesAfter = CountCacheMisses(indices, vertices.size());
+    stats.verticesAfter = vertices.size();
+    stats.acmrAfter = static_cast<float>(missesAfter) / static_cast<float>(stats.triangles);
+    stats.atvrAfter = static_cast<float>(missesAfter) / static_cast<float>(vertices.size());
+    return stats;
+}
+
+std::size_t MeshOptimizer::CountCacheMisses(const std::vector<unsigned int>& indices, std::size_t vertexCount)
+{
+    // FIFO como nos caches pós-transformação clássicos: acerto não renova a posição.
+    std::vector<std::size_t> insertedAt(vertexCount, 0);
+    std::size_t timestamp = kCacheSize + 1;
+    std::size_t misses = 0;
+    for (unsigned int index : indices)
+    {
+        if (timestamp - insertedAt[index] > kCacheSize)
+        {
+            insertedAt[index] = timestamp++;
+            ++misses;
+        }
+    }
+    return misses;
+}
+
+void MeshOptimizer::WeldVertices(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+{
+    // Primeira ocorrência define o novo índice: a ordem de saída segue a entrada, não o hash.
+    std::unordered_map<VertexKey, unsigned int, VertexKeyHash> unique;
+    unique.reserve(vertices.size());
+    std::vector<unsigned int> remap(vertices.size(), kInvalidIndex);
+    std::vector<Vertex> welded;
+    welded.reserve(vertices.size());
+    for (std::size_t i = 0; i < vertices.size(); ++i)
+    {
+        const auto inserted = unique.emplace(MakeKey(vertices[i]), static_cast<unsigned int>(welded.size()));
+        if (inserted.second)
+        {
+            welded.push_back(vertices[i]);
+        }
+        remap[i] = inserted.first->second;
+    }
+    for (unsigned int& index : indices)
+    {
+        index = remap[index];
+    }
+    vertices = std::move(welded);
+}
+
+std::vector<unsigned int> MeshOptimizer::OptimizeVertexCache(const std::vector<unsigned int>& indices,
+                                                             std::size_t vertexCount,
+                                                             std::vector<std::size_t>& clusterStarts)
+{
+    const std::size_t triangleCount = indices.size() / 3;
+    const Adjacency adjacency = BuildAdjacency(indices, vertexCount);
+
+    std::vector<unsigned int> liveTriangles(vertexCount);
+    for (std::size_t v = 0; v < vertexCount; ++v)
+    {
+        liveTriangles[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+    }
+    std::vector<std::size_t> cacheTime(vertexCount, 0);
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<unsigned int> deadEnd;
+    std::vector<unsigned int> candidates;
+    std::vector<unsigned int> output;
+    output.reserve(indices.size());
+    clusterStarts.clear();
+
+    std::size_t timestamp = kCacheSize + 1;
+    std::size_t scanCursor = 0;
+    unsigned int fanning = 0;
+    bool newCluster = true;
+    while (fanning != kInvalidIndex)
+    {
+        // Emite todos os triângulos ainda vivos ao redor do vértice de leque.
+        candidates.clear();
+        for (unsigned int a = adjacency.offsets[fanning]; a < adjacency.offsets[fanning + 1]; ++a)
+        {
+            const unsigned int triangle = adjacency.triangles[a];
+            if (emitted[triangle])
+            {
+                continue;
+            }
+            if (newCluster)
+            {
+                clusterStarts.push_back(output.size() / 3);
+                newCluster = false;
+            }
+            for (int corner = 0; corner < 3; ++corner)
+            {
+                const unsigned int v = indices[triangle * 3 + corner];
+                output.push_back(v);
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                --liveTriangles[v];
+                if (timestamp - cacheTime[v] > kCacheSize)
+                {
+                    cacheTime[v] = timestamp++;
+                }
+            }
+            emitted[triangle] = true;
+        }
+
+        // Próximo leque: o candidato que ainda estará no cache depois dos seus triângulos, o mais antigo primeiro.
+        unsigned int next = kInvalidIndex;
+        long bestPriority = -1;
+        for (unsigned int v : candidates)
+        {
+            if (liveTriangles[v] == 0)
+            {
+                continue;
+            }
+            long priority = 0;
+            const std::size_t age = timestamp - cacheTime[v];
+            if (age + 2 * liveTriangles[v] <= kCacheSize)
+            {
+                priority = static_cast<long>(age);
+            }
+            if (priority > bestPriority)
+            {
+                bestPriority = priority;
+                next = v;
+            }
+        }
+        if (next != kInvalidIndex)
+        {
+            fanning = next;
+            continue;
+        }
+
+        // Beco sem saída: vértices recentes com triângulos pendentes, depois varredura em ordem.
+        // Daqui em diante o cache não ajuda; vira uma fronteira de cluster para a ordem de overdraw.
+        newCluster = true;
+        while (!deadEnd.empty() && next == kInvalidIndex)
+        {
+            const unsigned int v = deadEnd.back();
+            deadEnd.pop_back();
+            if (liveTriangles[v] > 0)
+            {
+                next = v;
+            }
+        }
+        while (next == kInvalidIndex && scanCursor < vertexCount)
+        {
+            if (liveTriangles[scanCursor] > 0)
+            {
+                next = static_cast<unsigned int>(scanCursor);
+            }
+            ++scanCursor;
+        }
+        fanning = next;
+    }
+    return output;
+}
+
+std::vector<unsigned int> MeshOptimizer::OptimizeOverdraw(const std::vector<unsigned int>& indices,
+                                                          const std::vector<Vertex>& vertices,
+                                                          const std::vector<std::size_t>& clusterStarts)
+{
+    const std::size_t triangleCount = indices.size() / 3;
+    if (clusterStarts.size() < 2)
+    {
+        return indices;
+    }
+
+    glm::vec3 meshCenter(0.0f);
+    for (const Vertex& vertex : vertices)
+    {
+        meshCenter += vertex.position;
+    }
+    meshCenter /= static_cast<float>(vertices.size());
+
+    // Clusters voltados para fora (centroide à frente do próprio plano médio) primeiro: tendem a ocultar os
+    // de dentro e de trás, independentemente do ponto de vista (Sander et al., ordenação linear).
+    struct Cluster
+    {
+        std::size_t first = 0;
+        std::size_t end = 0;
+        float sortKey = 0.0f;
+    };
+    std::vector<Cluster> clusters(clusterStarts.size());
+    for (std::size_t c = 0; c < clusterStarts.size(); ++c)
+    {
+        Cluster& cluster = clusters[c];
+        cluster.first = clusterStarts[c];
+        cluster.end = c + 1 < clusterStarts.size() ? clusterStarts[c + 1] : triangleCount;
+
+        glm::vec3 centroid(0.0f);
+        glm::vec3 normal(0.0f);
+        float area = 0.0f;
+        for (std::size_t t = cluster.first; t < cluster.end; ++t)
+        {
+            const glm::vec3& p0 = vertices[indices[t * 3 + 0]].position;
+            const glm::vec3& p1 = vertices[indices[t * 3 + 1]].position;
+            const glm::vec3& p2 = vertices[indices[t * 3 + 2]].position;
+            const glm::vec3 cross = glm::cross(p1 - p0, p2 - p0);
+            const float triangleArea = glm::length(cross);
+            centroid += (p0 + p1 + p2) * (triangleArea / 3.0f);
+            normal += cross;
+            area += triangleArea;
+        }
+        const float normalLength = glm::length(normal);
+        if (area > 0.0f && normalLength > 0.0f)
+        {
+            centroid /= area;
+            cluster.sortKey = glm::dot(centroid - meshCenter, normal / normalLength);
+        }
+    }
+
+    // stable_sort: empates mantêm a ordem do Tipsify, então a saída é determinística.
+    std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b) {
+        return a.sortKey > b.sortKey;
+    });
+
+    std::vector<unsigned int> output;
+    output.reserve(indices.size());
+    for (const Cluster& cluster : clusters)
+    {
+        output.insert(output.end(), indices.begin() + cluster.first * 3, indices.begin() + cluster.end * 3);
+    }
+    return output;
+}
+
+void MeshOptimizer::OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+{
+    // Ordem de primeiro uso: o fetch percorre o VBO quase sequencialmente. Vértices sem uso são descartados.
+    std::vector<unsigned int> remap(vertices.size(), kInvalidIndex);
+    std::vector<Vertex> reordered;
+    reordered.reserve(vertices.size());
+    for (unsigned int& index : indices)
+    {
+        if (remap[index] == kInvalidIndex)
+        {
+            remap[index] = static_cast<unsigned int>(reordered.size());
+            reordered.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+    vertices = std::move(reordered);
+}
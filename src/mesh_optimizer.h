@@ -0,0 +1,49 @@
+#pragma once
+
+#include "vertex_format.h"
+
+#include <cstddef>
+#include <vector>
+
+/// @brief Métricas do cache pós-transformação (FIFO de kCacheSize entradas) antes e depois da otimização.
+/// ACMR: vértices transformados por triângulo (ideal ~0.5). ATVR: transformados por vértice único (ideal 1).
+struct MeshOptimizationStats
+{
+    std::size_t verticesBefore = 0;
+    std::size_t verticesAfter = 0;
+    std::size_t triangles = 0;
+    std::size_t overdrawClusters = 0;
+    bool overdrawApplied = false; ///< false se a ordem por oclusão piorou o ACMR além do limite.
+    float acmrBefore = 0.0f;
+    float acmrAfter = 0.0f;
+    float atvrBefore = 0.0f;
+    float atvrAfter = 0.0f;
+};
+
+/// @brief Pipeline de importação, sempre na mesma ordem e sem depender de endereços ou hashes de ponteiro
+/// (mesma entrada, mesma saída, pronto para cache):
+/// 1. funde vértices idênticos bit a bit;
+/// 2. reordena triângulos para o cache de vértices (Tipsify, Sander et al. 2007);
+/// 3. ordena os clusters do Tipsify de fora para dentro para reduzir overdraw, se o ACMR piorar no máximo 5%;
+/// 4. renumera os vértices na ordem de primeiro uso para localidade de fetch.
+class MeshOptimizer
+{
+public:
+    static constexpr std::size_t kCacheSize = 16;
+
+    static MeshOptimizationStats Optimize(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
+
+    /// @brief Simula o cache FIFO sobre a lista de índices e devolve os vértices transformados.
+    static std::size_t CountCacheMisses(const std::vector<unsigned int>& indices, std::size_t vertexCount);
+
+private:
+    static void WeldVertices(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
+    /// @brief Reordena em Tipsify; clusterStarts recebe o primeiro triângulo de cada trecho sem vizinhança.
+    static std::vector<unsigned int> OptimizeVertexCache(const std::vector<unsigned int>& indices,
+                                                         std::size_t vertexCount,
+                                                         std::vector<std::size_t>& clusterStarts);
+    static std::vector<unsigned int> OptimizeOverdraw(const std::vector<unsigned int>& indices,
+                                                      const std::vector<Vertex>& vertices,
+                                                      const std::vector<std::size_t>& clusterStarts);
+    static void OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
+};
@@ -1,6 +1,11 @@
 #include "model.h"
 
+#include "asset_cache.h"
+#include "mesh_optimizer.h"
+#include "render_state.h"
+
 #include <cstddef>
+#include <cstdint>
 #include <iostream>
 #include <vector>
 #include <algorithm>
@@ -11,57 +16,49 @@
 #include <glm/gtx/compatibility.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
-Mesh::Mesh(std::vector<Vertex>&& vertices,
-           std::vector<unsigned int>&& indices,
-           Material* material)
-    : m_vertices(std::move(vertices))
-    , m_indices(std::move(indices))
-    , m_material(material)
-    , m_VAO(0)
-    , m_VBO(0)
-    , m_EBO(0)
+Assimp::IOStream* RecordingIOSystem::Open(const char* file, const char* mode)
 {
-    SetupMesh();
+    Assimp::IOStream* stream = Assimp::DefaultIOSystem::Open(file, mode);
+    if (stream) {
+        m_openedFiles.emplace_back(file);
+    }
+    return stream;
 }
 
-Mesh::~Mesh()
+Mesh::Mesh(const std::vector<Vertex>& vertices,
+           const std::vector<unsigned int>& indices,
+           Material* material,
+           const QuantizedVertices* quantized)
+    : m_material(material)
+    , m_decode(quantized != nullptr ? quantized->decode : VertexDecode{})
+    , m_geometry(quantized != nullptr ? GeometryPool::Get().Allocate(*quantized, indices)
+                                      : GeometryPool::Get().Allocate(vertices, indices))
 {
-    if (m_VAO) glDeleteVertexArrays(1, &m_VAO);
-    if (m_VBO) glDeleteBuffers(1, &m_VBO);
-    if (m_EBO) glDeleteBuffers(1, &m_EBO);
 }
 
-void Mesh::SetupMesh()
+Mesh::Mesh(const BakedMesh& baked, Material* material)
+    : m_material(material)
+    , m_decode(baked.decode)
+    , m_geometry(GeometryPool::Get().Allocate(baked.format,
+                                              baked.vertexBlob,
+                                              baked.positionBlob,
+                                              baked.vertexCount,
+                                              baked.indexBlob,
+                                              baked.indexCount,
+                                              baked.indexType))
 {
-    glGenVertexArrays(1, &m_VAO);
-    glGenBuffers(1, &m_VBO);
-    glGenBuffers(1, &m_EBO);
-
-    glBindVertexArray(m_VAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
-    glBufferData(GL_ARRAY_BUFFER, m_vertices.size() * sizeof(Vertex), m_vertices.data(), GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_indices.size() * sizeof(unsigned int), m_indices.data(), GL_STATIC_DRAW);
-
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, position));
-
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
-
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, texCoords));
+}
 
-    glBindVertexArray(0);
+Mesh::~Mesh()
+{
+    GeometryPool::Get().Free(m_geometry);
 }
 
-void Mesh::Draw(GLuint program, GLuint fallbackTextureID) const
+void Mesh::Draw(GLuint fallbackTextureID) const
 {
     bool hasTextureBound = false;
     if (m_material) {
-        m_material->Apply(program);
+        m_material->Apply();
         if (m_material->HasTexture()) {
             m_material->BindTexture(GL_TEXTURE0);
             hasTextureBound = true;
@@ -69,16 +66,31 @@ void Mesh::Draw(GLuint program, GLuint fallbackTextureID) const
     }
 
     if (!hasTextureBound && fallbackTextureID != 0) {
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, fallbackTextureID);
+        RenderStateCache::Get().BindTextureUnit(GL_TEXTURE0, GL_TEXTURE_2D, fallbackTextureID);
     }
 
-    glBindVertexArray(m_VAO);
-    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(m_indices.size()), GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
+    RenderStateCache::Get().BindVertexArray(GetVertexArray());
+    DrawElements();
 }
 
-void Mesh::DrawInstanced(GLuint program, GLuint fallbackTextureID, GLuint instanceVBO, GLsizei instanceCount) const
+void Mesh::DrawElements() const
+{
+    if (!m_geometry.IsValid()) {
+        return;
+    }
+    GeometryPool::Get().ApplyDecode(m_decode);
+    glDrawElementsBaseVertex(GL_TRIANGLES,
+                             m_geometry.indexCount,
+                             m_geometry.indexType,
+                             m_geometry.GetIndexOffset(),
+                             m_geometry.baseVertex);
+}
+
+void Mesh::DrawInstanced(GLuint fallbackTextureID,
+                         GLuint instanceVBO,
+                         GLsizei instanceCount,
+                         GLintptr instanceByteOffset,
+                         InstanceAttributeLayout layout) const
 {
     if (instanceCount <= 0) {
         return;
@@ -86,7 +98,7 @@ void Mesh::DrawInstanced(GLuint program, GLuint fallbackTextureID, GLuint instan
 
     bool hasTextureBound = false;
     if (m_material) {
-        m_material->Apply(program);
+        m_material->Apply();
         if (m_material->HasTexture()) {
             m_material->BindTexture(GL_TEXTURE0);
             hasTextureBound = true;
@@ -94,26 +106,107 @@ void Mesh::DrawInstanced(GLuint program, GLuint fallbackTextureID, GLuint instan
     }
 
     if (!hasTextureBound && fallbackTextureID != 0) {
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, fallbackTextureID);
+        RenderStateCache::Get().BindTextureUnit(GL_TEXTURE0, GL_TEXTURE_2D, fallbackTextureID);
+    }
+
+    RenderStateCache::Get().BindVertexArray(GetVertexArray());
+    DrawInstancedRange(instanceVBO, instanceByteOffset, instanceCount, true, layout);
+}
+
+void Mesh::DrawInstancedRange(GLuint instanceVBO,
+                              GLintptr byteOffset,
+                              GLsizei instanceCount,
+                              bool bindAttributes,
+                              InstanceAttributeLayout layout) const
+{
+    if (instanceCount <= 0 || !m_geometry.IsValid()) {
+        return;
+    }
+    GeometryPool::Get().ApplyDecode(m_decode);
+
+    if (SupportsBaseInstance()) {
+        if (bindAttributes) {
+            BindInstanceAttributes(instanceVBO, 0, layout);
+        }
+        const GLintptr stride = layout == InstanceAttributeLayout::Matrices
+                                    ? static_cast<GLintptr>(sizeof(glm::mat4))
+                                    : static_cast<GLintptr>(sizeof(GLuint));
+        glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES,
+                                                      m_geometry.indexCount,
+                                                      m_geometry.indexType,
+                                                      m_geometry.GetIndexOffset(),
+                                                      instanceCount,
+                                                      m_geometry.baseVertex,
+                                                      static_cast<GLuint>(byteOffset / stride));
+        return;
+    }
+
+    BindInstanceAttributes(instanceVBO, byteOffset, layout);
+    glDrawElementsInstancedBaseVertex(GL_TRIANGLES,
+                                      m_geometry.indexCount,
+                                      m_geometry.indexType,
+                                      m_geometry.GetIndexOffset(),
+                                      instanceCount,
+                                      m_geometry.baseVertex);
+}
+
+void Mesh::DrawDepth() const
+{
+    RenderStateCache::Get().BindVertexArray(GetDepthVertexArray());
+    DrawElements();
+}
+
+void Mesh::DrawDepthInstanced(GLuint instanceVBO,
+                              GLsizei instanceCount,
+                              GLintptr instanceByteOffset,
+                              InstanceAttributeLayout layout) const
+{
+    if (instanceCount <= 0) {
+        return;
     }
 
-    glBindVertexArray(m_VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    RenderStateCache::Get().BindVertexArray(GetDepthVertexArray());
+    DrawInstancedRange(instanceVBO, instanceByteOffset, instanceCount, true, layout);
+}
+
+void Mesh::BindInstanceAttributes(GLuint instanceVBO, GLintptr byteOffset, InstanceAttributeLayout layout) const
+{
+    RenderStateCache::Get().BindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+
+    // Atributos do outro layout ficam desligados: com divisor e base instance apontariam além do buffer.
+    if (layout == InstanceAttributeLayout::TransformIndices) {
+        for (int i = 0; i < 4; ++i) {
+            glDisableVertexAttribArray(3 + i);
+        }
+        glEnableVertexAttribArray(7);
+        glVertexAttribIPointer(7, 1, GL_UNSIGNED_INT, sizeof(GLuint), reinterpret_cast<const void*>(byteOffset));
+        glVertexAttribDivisor(7, 1);
+        return;
+    }
 
+    glDisableVertexAttribArray(7);
     const std::size_t vec4Size = sizeof(glm::vec4);
     for (int i = 0; i < 4; ++i) {
+        const std::size_t attributeOffset = static_cast<std::size_t>(byteOffset) + static_cast<std::size_t>(i) * vec4Size;
         glEnableVertexAttribArray(3 + i);
-        glVertexAttribPointer(3 + i, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), reinterpret_cast<const void*>(static_cast<std::size_t>(i) * vec4Size));
+        glVertexAttribPointer(3 + i, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), reinterpret_cast<const void*>(attributeOffset));
         glVertexAttribDivisor(3 + i, 1);
     }
+}
 
-    glDrawElementsInstanced(GL_TRIANGLES,
-                            static_cast<GLsizei>(m_indices.size()),
-                            GL_UNSIGNED_INT,
-                            nullptr,
-                            instanceCount);
-    glBindVertexArray(0);
+unsigned int Model::GetImportFlags(bool filterNodes)
+{
+    unsigned int importFlags =
+        aiProcess_Triangulate |
+        aiProcess_GenSmoothNormals |
+        aiProcess_OptimizeMeshes |
+        aiProcess_OptimizeGraph;
+
+    if (filterNodes)
+    {
+        importFlags &= ~aiProcess_OptimizeGraph;
+    }
+    return importFlags;
 }
 
 bool Model::LoadFromFile(const std::string& filePath)
@@ -129,17 +222,19 @@ bool Model::LoadFromFile(const std::string& filePath, const std::vector<std::str
         directory = filePath.substr(0, lastSlash);
     }
 
-    unsigned int importFlags =
-        aiProcess_Triangulate |
-        aiProcess_GenSmoothNormals |
-        aiProcess_OptimizeMeshes |
-        aiProcess_OptimizeGraph;
+    const unsigned int importFlags = GetImportFlags(!allowedNodes.empty());
 
-    if (!allowedNodes.empty())
-    {
-        importFlags &= ~aiProcess_OptimizeGraph;
+    // O Assimp só roda quando o bake falta, não confere com as opções atuais ou alguma dependência mudou.
+    const BakedModelKey bakedKey = BakedModelFile::MakeKey(filePath, importFlags, allowedNodes);
+    if (LoadFromBakedCache(bakedKey)) {
+        return true;
     }
 
+    if (!m_importFiles) {
+        m_importFiles = new RecordingIOSystem();
+        m_importer.SetIOHandler(m_importFiles);
+    }
+    m_importFiles->ClearOpenedFiles();
     const aiScene* scene = m_importer.ReadFile(filePath, importFlags);
 
     if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
@@ -148,7 +243,13 @@ bool Model::LoadFromFile(const std::string& filePath, const std::vector<std::str
         return false;
     }
 
-    return LoadFromScene(scene, directory, allowedNodes);
+    if (!LoadFromScene(scene, directory, allowedNodes)) {
+        return false;
+    }
+    WriteBakedCache(bakedKey, m_importFiles->GetOpenedFiles());
+    ReleaseImportData();
+    m_importer.FreeScene();
+    return true;
 }
 
 bool Model::LoadFromScene(const aiScene* scene, const std::string& directory, const std::vector<std::string>& allowedNodes)
@@ -161,7 +262,10 @@ bool Model::LoadFromScene(const aiScene* scene, const std::string& directory, co
 
     m_meshes.clear();
     m_materials.clear();
-    m_ownedTextures.clear();
+    m_textures.clear();
+    m_textureSources.clear();
+    m_pendingGeometry.clear();
+    m_bakedFile.reset();
     m_directory = directory;
     m_allowedNames.clear();
     m_useNodeFilter = !allowedNodes.empty();
@@ -176,21 +280,171 @@ bool Model::LoadFromScene(const aiScene* scene, const std::string& directory, co
     }
 
     ResetBounds();
+    m_quantizationReport = {};
     ProcessNode(scene->mRootNode, scene, glm::mat4(1.0f), false);
 
-    if (m_hasBounds) {
-        m_boundingCenter = (m_aabbMin + m_aabbMax) * 0.5f;
-        m_boundingRadius = glm::length(m_aabbMax - m_boundingCenter);
-    } else {
-        m_boundingCenter = glm::vec3(0.0f);
-        m_boundingRadius = 0.0f;
+    const ModelQuantizationReport& report = m_quantizationReport;
+    if (report.meshes > 0) {
+        std::cout << "Quantização de vértices (" << (directory.empty() ? "." : directory) << "): "
+                  << report.quantizedMeshes << "/" << report.meshes << " meshes, "
+                  << report.floatBytes / 1024 << "KB -> " << report.packedBytes / 1024 << "KB; erro máx posição "
+                  << report.maxError.position << ", normal " << report.maxError.normalDegrees << " graus, UV "
+                  << report.maxError.texCoord << std::endl;
     }
 
+    UpdateBoundingSphere();
+
     m_useNodeFilter = false;
     m_allowedNames.clear();
     return !m_meshes.empty();
 }
 
+bool Model::LoadFromBakedCache(const BakedModelKey& key)
+{
+    auto bakedFile = std::make_unique<BakedModelFile>();
+    if (!bakedFile->Open(key) || bakedFile->GetData().meshes.empty()) {
+        return false;
+    }
+    const BakedModelData& data = bakedFile->GetData();
+
+    m_meshes.clear();
+    m_materials.clear();
+    m_textures.clear();
+    m_textureSources.clear();
+    m_pendingGeometry.clear();
+    m_quantizationReport = {};
+
+    // Texturas repetidas (no bake ou em outros modelos) saem uma vez só do TextureCache.
+    for (const BakedMesh& baked : data.meshes) {
+        auto material = std::make_unique<Material>(baked.ambient, baked.diffuse, baked.specular, baked.shininess);
+        const BakedTextureSource& source = baked.texture;
+        if (source.kind == BakedTextureSource::Kind::File) {
+            material->SetDiffuseTexture(
+                LoadTextureFromPath(std::string(reinterpret_cast<const char*>(source.data), source.size)));
+        } else if (source.kind == BakedTextureSource::Kind::Compressed) {
+            material->SetDiffuseTexture(LoadTextureFromMemory(source.data, source.size));
+        } else if (source.kind == BakedTextureSource::Kind::Raw) {
+            material->SetDiffuseTexture(LoadTextureFromRawData(source.data, source.width, source.height));
+        }
+
+        m_meshes.emplace_back(std::make_unique<Mesh>(baked, material.get()));
+        m_materials.emplace_back(std::move(material));
+
+        const bool quantized = baked.format == VertexFormat::Quantized;
+        const std::size_t indexSize = baked.indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+        ++m_quantizationReport.meshes;
+        m_quantizationReport.quantizedMeshes += quantized ? 1 : 0;
+        m_quantizationReport.floatBytes +=
+            baked.vertexCount * (sizeof(Vertex) + sizeof(glm::vec3)) + baked.indexCount * sizeof(unsigned int);
+        m_quantizationReport.packedBytes +=
+            baked.vertexCount * (quantized ? sizeof(PackedVertex) + sizeof(PackedPosition) : sizeof(Vertex) + sizeof(glm::vec3)) +
+            baked.indexCount * indexSize;
+    }
+
+    m_aabbMin = data.aabbMin;
+    m_aabbMax = data.aabbMax;
+    m_hasBounds = data.hasBounds;
+    UpdateBoundingSphere();
+    m_textureSources.clear();
+    m_bakedFile = std::move(bakedFile);
+
+    std::cout << "Modelo carregado do cache " << key.cachePath << ": " << m_meshes.size() << " meshes, "
+              << m_quantizationReport.packedBytes / 1024 << "KB de geometria" << std::endl;
+    return true;
+}
+
+bool Model::WriteBakedCache(const BakedModelKey& key, const std::vector<std::string>& importedFiles)
+{
+    if (m_pendingGeometry.size() != m_meshes.size()) {
+        std::cerr << "Geometria da importação indisponível; cache de modelo não gravado: " << key.cachePath << std::endl;
+        return false;
+    }
+
+    // Blobs no layout exato do pool, a partir da geometria guardada por ProcessMesh.
+    struct MeshBlobs
+    {
+        std::vector<glm::vec3> positions;
+        std::vector<GLushort> shortIndices;
+    };
+    std::vector<MeshBlobs> blobs(m_meshes.size());
+
+    BakedModelData data;
+    data.aabbMin = m_aabbMin;
+    data.aabbMax = m_aabbMax;
+    data.hasBounds = m_hasBounds;
+    data.dependencies = importedFiles;
+    for (const auto& source : m_textureSources) {
+        if (source.second.kind == BakedTextureSource::Kind::File) {
+            data.dependencies.emplace_back(source.second.bytes.begin(), source.second.bytes.end());
+        }
+    }
+    data.meshes.reserve(m_meshes.size());
+    for (std::size_t i = 0; i < m_meshes.size(); ++i) {
+        const Mesh& mesh = *m_meshes[i];
+        const GeometryAllocation& geometry = mesh.GetGeometry();
+        const PendingGeometry& pending = m_pendingGeometry[i];
+        if (!geometry.IsValid()) {
+            std::cerr << "Mesh sem geometria no pool; cache de modelo não gravado: " << key.cachePath << std::endl;
+            return false;
+        }
+        MeshBlobs& meshBlobs = blobs[i];
+
+        BakedMesh baked;
+        baked.format = geometry.format;
+        baked.indexType = geometry.indexType;
+        baked.vertexCount = geometry.vertexCount;
+        baked.indexCount = static_cast<std::uint32_t>(pending.indices.size());
+        baked.decode = mesh.GetVertexDecode();
+        if (geometry.format == VertexFormat::Quantized) {
+            baked.vertexBlob = pending.quantized.vertices.data();
+            baked.positionBlob = pending.quantized.positions.data();
+        } else {
+            meshBlobs.positions.reserve(pending.vertices.size());
+            for (const Vertex& vertex : pending.vertices) {
+                meshBlobs.positions.push_back(vertex.position);
+            }
+            baked.vertexBlob = pending.vertices.data();
+            baked.positionBlob = meshBlobs.positions.data();
+        }
+        if (geometry.indexType == GL_UNSIGNED_SHORT) {
+            meshBlobs.shortIndices.assign(pending.indices.begin(), pending.indices.end());
+            baked.indexBlob = meshBlobs.shortIndices.data();
+        } else {
+            baked.indexBlob = pending.indices.data();
+        }
+
+        if (const Material* material = mesh.GetMaterial()) {
+            baked.ambient = material->GetAmbient();
+            baked.diffuse = material->GetDiffuse();
+            baked.specular = material->GetSpecular();
+            baked.shininess = material->GetShininess();
+            const auto source = m_textureSources.find(material->GetDiffuseTexture());
+            if (source != m_textureSources.end()) {
+                baked.texture.kind = source->second.kind;
+                baked.texture.data = source->second.bytes.data();
+                baked.texture.size = source->second.bytes.size();
+                baked.texture.width = source->second.width;
+                baked.texture.height = source->second.height;
+            }
+        }
+        data.meshes.push_back(baked);
+    }
+
+    const bool written = BakedModelFile::Write(key, data);
+    ReleaseImportData();
+    if (written) {
+        std::cout << "Cache de modelo gravado: " << key.cachePath << std::endl;
+    }
+    return written;
+}
+
+void Model::ReleaseImportData()
+{
+    m_textureSources.clear();
+    m_pendingGeometry.clear();
+    m_pendingGeometry.shrink_to_fit();
+}
+
 glm::vec3 Model::GetBoundingHalfExtents() const
 {
     if (!m_hasBounds)
@@ -200,17 +454,31 @@ glm::vec3 Model::GetBoundingHalfExtents() const
     return (m_aabbMax - m_aabbMin) * 0.5f;
 }
 
-void Model::Draw(GLuint program, GLuint fallbackTextureID) const
+void Model::Draw(GLuint fallbackTextureID) const
 {
     for (const auto& mesh : m_meshes) {
-        mesh->Draw(program, fallbackTextureID);
+        mesh->Draw(fallbackTextureID);
     }
 }
 
-void Model::DrawInstanced(GLuint program, GLuint fallbackTextureID, GLuint instanceVBO, GLsizei instanceCount) const
+void Model::DrawInstanced(GLuint fallbackTextureID,
+                          GLuint instanceVBO,
+                          GLsizei instanceCount,
+                          GLintptr instanceByteOffset,
+                          InstanceAttributeLayout layout) const
 {
     for (const auto& mesh : m_meshes) {
-        mesh->DrawInstanced(program, fallbackTextureID, instanceVBO, instanceCount);
+        mesh->DrawInstanced(fallbackTextureID, instanceVBO, instanceCount, instanceByteOffset, layout);
+    }
+}
+
+void Model::DrawDepthInstanced(GLuint instanceVBO,
+                               GLsizei instanceCount,
+                               GLintptr instanceByteOffset,
+                               InstanceAttributeLayout layout) const
+{
+    for (const auto& mesh : m_meshes) {
+        mesh->DrawDepthInstanced(instanceVBO, instanceCount, instanceByteOffset, layout);
     }
 }
 
@@ -291,7 +559,51 @@ std::unique_ptr<Mesh> Model::ProcessMesh(aiMesh* mesh, const aiScene* scene, con
         m_materials.emplace_back(std::move(defaultMaterial));
     }
 
-    return std::make_unique<Mesh>(std::move(vertices), std::move(indices), meshMaterial);
+    // Solda, cache de vértices, overdraw e fetch antes de quantizar: a ordem final é a que vai para o pool.
+    const MeshOptimizationStats optimization = MeshOptimizer::Optimize(vertices, indices);
+    if (optimization.triangles > 0) {
+        std::cout << "Mesh '" << mesh->mName.C_Str() << "': " << optimization.verticesBefore << " -> "
+                  << optimization.verticesAfter << " vértices, " << optimization.triangles << " triângulos, ACMR "
+                  << optimization.acmrBefore << " -> " << optimization.acmrAfter << ", ATVR "
+                  << optimization.atvrBefore << " -> " << optimization.atvrAfter << ", overdraw "
+                  << (optimization.overdrawApplied ? "aplicado" : "descartado") << " ("
+                  << optimization.overdrawClusters << " clusters)" << std::endl;
+    }
+
+    // Formato compacto só se o erro medido ficar dentro dos limites; senão o mesh segue em float.
+    VertexQuantizationError quantizationError;
+    QuantizedVertices quantized = QuantizeVertices(vertices, quantizationError);
+    const bool useQuantized = IsQuantizationAcceptable(quantizationError);
+    const std::size_t floatBytes = vertices.size() * (sizeof(Vertex) + sizeof(glm::vec3));
+    ++m_quantizationReport.meshes;
+    m_quantizationReport.floatBytes += floatBytes;
+    if (useQuantized) {
+        ++m_quantizationReport.quantizedMeshes;
+        m_quantizationReport.packedBytes += vertices.size() * (sizeof(PackedVertex) + sizeof(PackedPosition));
+        VertexQuantizationError& worst = m_quantizationReport.maxError;
+        worst.position = std::max(worst.position, quantizationError.position);
+        worst.normalDegrees = std::max(worst.normalDegrees, quantizationError.normalDegrees);
+        worst.texCoord = std::max(worst.texCoord, quantizationError.texCoord);
+    } else {
+        m_quantizationReport.packedBytes += floatBytes;
+        std::cerr << "Mesh '" << mesh->mName.C_Str() << "' mantido em float: erro de quantização normal "
+                  << quantizationError.normalDegrees << " graus, UV " << quantizationError.texCoord << std::endl;
+    }
+
+    auto created = std::make_unique<Mesh>(vertices, indices, meshMaterial, useQuantized ? &quantized : nullptr);
+    m_quantizationReport.floatBytes += indices.size() * sizeof(unsigned int);
+    m_quantizationReport.packedBytes += indices.size() * created->GetGeometry().GetIndexSize();
+
+    // O pool já tem a geometria; a cópia da CPU só vive até WriteBakedCache.
+    PendingGeometry pending;
+    if (useQuantized) {
+        pending.quantized = std::move(quantized);
+    } else {
+        pending.vertices = std::move(vertices);
+    }
+    pending.indices = std::move(indices);
+    m_pendingGeometry.push_back(std::move(pending));
+    return created;
 }
 
 namespace
@@ -440,13 +752,36 @@ void Model::ForEachMaterial(const std::function<void(Material&)>& callback)
 
 Texture* Model::LoadTextureFromPath(const std::string& filepath)
 {
-    auto texture = std::make_unique<Texture>();
-    if (texture->LoadFromFile(filepath)) {
-        Texture* texturePtr = texture.get();
-        m_ownedTextures.emplace_back(std::move(texture));
-        return texturePtr;
+    Texture* texture = AddTexture(TextureCache::Get().LoadFromFile(filepath));
+    if (texture) {
+        TextureSource& source = m_textureSources[texture];
+        source.kind = BakedTextureSource::Kind::File;
+        source.bytes.assign(filepath.begin(), filepath.end());
     }
-    return nullptr;
+    return texture;
+}
+
+Texture* Model::LoadTextureFromMemory(const unsigned char* data, std::size_t size)
+{
+    return AddTexture(TextureCache::Get().LoadFromMemory(data, size));
+}
+
+Texture* Model::LoadTextureFromRawData(const unsigned char* data, int width, int height)
+{
+    return AddTexture(TextureCache::Get().LoadFromRawData(data, width, height, 4));
+}
+
+Texture* Model::AddTexture(std::shared_ptr<Texture> texture)
+{
+    if (!texture) {
+        return nullptr;
+    }
+    Texture* texturePtr = texture.get();
+    const auto sameTexture = [texturePtr](const std::shared_ptr<Texture>& held) { return held.get() == texturePtr; };
+    if (std::none_of(m_textures.begin(), m_textures.end(), sameTexture)) {
+        m_textures.emplace_back(std::move(texture));
+    }
+    return texturePtr;
 }
 
 Texture* Model::LoadEmbeddedTexture(const aiScene* scene, const std::string& identifier)
@@ -460,12 +795,14 @@ Texture* Model::LoadEmbeddedTexture(const aiScene* scene, const std::string& ide
         return nullptr;
     }
 
-    auto texture = std::make_unique<Texture>();
-    bool loaded = false;
+    Texture* texture = nullptr;
+    TextureSource source;
     if (embedded->mHeight == 0) {
         const unsigned char* data = reinterpret_cast<const unsigned char*>(embedded->pcData);
         const std::size_t size = static_cast<std::size_t>(embedded->mWidth);
-        loaded = texture->LoadFromMemory(data, size);
+        texture = LoadTextureFromMemory(data, size);
+        source.kind = BakedTextureSource::Kind::Compressed;
+        source.bytes.assign(data, data + size);
     } else {
         const std::size_t pixelCount = static_cast<std::size_t>(embedded->mWidth) * static_cast<std::size_t>(embedded->mHeight);
         if (pixelCount == 0) {
@@ -479,16 +816,21 @@ Texture* Model::LoadEmbeddedTexture(const aiScene* scene, const std::string& ide
             pixels[i * 4 + 2] = texel.b;
             pixels[i * 4 + 3] = texel.a;
         }
-        loaded = texture->LoadFromRawData(pixels.data(), embedded->mWidth, embedded->mHeight, 4);
+        texture = LoadTextureFromRawData(pixels.data(),
+                                         static_cast<int>(embedded->mWidth),
+                                         static_cast<int>(embedded->mHeight));
+        source.kind = BakedTextureSource::Kind::Raw;
+        source.bytes = std::move(pixels);
+        source.width = static_cast<int>(embedded->mWidth);
+        source.height = static_cast<int>(embedded->mHeight);
     }
 
-    if (!loaded) {
+    if (!texture) {
         return nullptr;
     }
 
-    Texture* texturePtr = texture.get();
-    m_ownedTextures.emplace_back(std::move(texture));
-    return texturePtr;
+    m_textureSources[texture] = std::move(source);
+    return texture;
 }
 
 glm::mat4 Model::ConvertMatrix(const aiMatrix4x4& matrix)
@@ -510,6 +852,17 @@ void Model::ResetBounds()
     m_hasBounds = false;
 }
 
+void Model::UpdateBoundingSphere()
+{
+    if (m_hasBounds) {
+        m_boundingCenter = (m_aabbMin + m_aabbMax) * 0.5f;
+        m_boundingRadius = glm::length(m_aabbMax - m_boundingCenter);
+    } else {
+        m_boundingCenter = glm::vec3(0.0f);
+        m_boundingRadius = 0.0f;
+    }
+}
+
 void Model::UpdateBounds(const glm::vec3& position)
 {
     if (!m_hasBounds) {
@@ -3,55 +3,135 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <assimp/Importer.hpp>
+#include <assimp/DefaultIOSystem.h>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 #include <vector>
 #include <memory>
 #include <string>
 #include <functional>
+#include <unordered_map>
 #include <unordered_set>
 
+#include "baked_model.h"
+#include "geometry_pool.h"
 #include "texture.h"
 #include "material.h"
+#include "vertex_format.h"
 
-struct Vertex
+/// @brief Conteúdo do buffer de instâncias: uma mat4 por instância (atributos 3-6) ou um índice uint
+/// (atributo 7) para as matrizes do texture buffer estático.
+enum class InstanceAttributeLayout
 {
-    glm::vec3 position{ 0.0f };
-    glm::vec3 normal{ 0.0f };
-    glm::vec2 texCoords{ 0.0f };
+    Matrices,
+    TransformIndices
 };
 
 class Mesh
 {
 public:
-    Mesh(std::vector<Vertex>&& vertices,
-         std::vector<unsigned int>&& indices,
-         Material* material);
+    /// @brief Envia a geometria ao pool (no formato compacto se quantized != nullptr); nada fica na CPU.
+    Mesh(const std::vector<Vertex>& vertices,
+         const std::vector<unsigned int>& indices,
+         Material* material,
+         const QuantizedVertices* quantized = nullptr);
+    /// @brief Mesh de um bake: blobs enviados direto do mapeamento.
+    Mesh(const BakedMesh& baked, Material* material);
     ~Mesh();
 
-    void Draw(GLuint program, GLuint fallbackTextureID) const;
-    void DrawInstanced(GLuint program, GLuint fallbackTextureID, GLuint instanceVBO, GLsizei instanceCount) const;
+    Mesh(const Mesh&) = delete;
+    Mesh& operator=(const Mesh&) = delete;
 
-private:
-    void SetupMesh();
+    void Draw(GLuint fallbackTextureID) const;
+    void DrawInstanced(GLuint fallbackTextureID,
+                       GLuint instanceVBO,
+                       GLsizei instanceCount,
+                       GLintptr instanceByteOffset = 0,
+                       InstanceAttributeLayout layout = InstanceAttributeLayout::Matrices) const;
+    /// @brief Desenha instanceCount instâncias cujos dados começam em byteOffset no buffer de instâncias.
+    /// Com base instance os atributos ficam em offset 0 e o deslocamento vai no draw; sem suporte, os
+    /// ponteiros são refeitos. Espera o VAO vinculado; bindAttributes=false reaproveita ponteiros já em offset 0.
+    void DrawInstancedRange(GLuint instanceVBO,
+                            GLintptr byteOffset,
+                            GLsizei instanceCount,
+                            bool bindAttributes = true,
+                            InstanceAttributeLayout layout = InstanceAttributeLayout::Matrices) const;
+    /// @brief Aponta os atributos por instância do layout para instanceVBO a partir de byteOffset e desliga
+    /// os do outro layout. Espera o VAO do mesh já vinculado.
+    void BindInstanceAttributes(GLuint instanceVBO,
+                                GLintptr byteOffset,
+                                InstanceAttributeLayout layout = InstanceAttributeLayout::Matrices) const;
+    /// @brief glDrawElementsBaseVertex da faixa do mesh; espera um dos VAOs do pool vinculado.
+    void DrawElements() const;
+    /// @brief Draw só de depth: stream compacto de posições, sem material nem textura.
+    void DrawDepth() const;
+    void DrawDepthInstanced(GLuint instanceVBO,
+                            GLsizei instanceCount,
+                            GLintptr instanceByteOffset = 0,
+                            InstanceAttributeLayout layout = InstanceAttributeLayout::Matrices) const;
+
+    const Material* GetMaterial() const { return m_material; }
+    /// @brief VAO compartilhado do pool de geometria: igual para todos os meshes do mesmo formato.
+    GLuint GetVertexArray() const { return GeometryPool::Get().GetVertexArray(m_geometry.format); }
+    /// @brief VAO com apenas o atributo 0 (posições compactas) e o mesmo EBO.
+    GLuint GetDepthVertexArray() const { return GeometryPool::Get().GetDepthVertexArray(m_geometry.format); }
+    GLsizei GetIndexCount() const { return m_geometry.indexCount; }
+    const GeometryAllocation& GetGeometry() const { return m_geometry; }
+    const VertexDecode& GetVertexDecode() const { return m_decode; }
 
-    std::vector<Vertex> m_vertices;
-    std::vector<unsigned int> m_indices;
+    /// @brief true se o contexto expõe glDrawElementsInstancedBaseVertexBaseInstance (GL 4.2 / ARB_base_instance).
+    static bool SupportsBaseInstance() { return GeometryPool::SupportsBaseInstance(); }
+
+private:
     Material* m_material;
+    VertexDecode m_decode;
+    GeometryAllocation m_geometry;
+};
+
+/// @brief Resumo da quantização dos meshes de um modelo no último carregamento.
+struct ModelQuantizationReport
+{
+    std::size_t meshes = 0;
+    std::size_t quantizedMeshes = 0;
+    std::size_t floatBytes = 0;  ///< Vértices, posições de depth e índices se tudo ficasse em float/uint32.
+    std::size_t packedBytes = 0; ///< O que foi de fato para o pool.
+    VertexQuantizationError maxError; ///< Pior caso entre os meshes quantizados.
+};
+
+/// @brief IOSystem do Assimp que anota cada arquivo aberto na importação (fonte, buffers externos do glTF,
+/// .mtl), para o bake conferir todos eles. O Importer assume a posse via SetIOHandler.
+class RecordingIOSystem : public Assimp::DefaultIOSystem
+{
+public:
+    Assimp::IOStream* Open(const char* file, const char* mode = "rb") override;
+    const std::vector<std::string>& GetOpenedFiles() const { return m_openedFiles; }
+    void ClearOpenedFiles() { m_openedFiles.clear(); }
 
-    GLuint m_VAO;
-    GLuint m_VBO;
-    GLuint m_EBO;
+private:
+    std::vector<std::string> m_openedFiles;
 };
 
 class Model
 {
 public:
+    /// @brief Flags do Assimp usadas por LoadFromFile; com filtro de nós o grafo não é achatado.
+    static unsigned int GetImportFlags(bool filterNodes);
+
+    /// @brief Carrega do bake (<arquivo>.<opções>.bake) quando válido; senão importa com o Assimp e grava o bake.
     bool LoadFromFile(const std::string& filePath);
     bool LoadFromFile(const std::string& filePath, const std::vector<std::string>& allowedNodes);
-    void Draw(GLuint program, GLuint fallbackTextureID) const;
-    void DrawInstanced(GLuint program, GLuint fallbackTextureID, GLuint instanceVBO, GLsizei instanceCount) const;
+    void Draw(GLuint fallbackTextureID) const;
+    void DrawInstanced(GLuint fallbackTextureID,
+                       GLuint instanceVBO,
+                       GLsizei instanceCount,
+                       GLintptr instanceByteOffset = 0,
+                       InstanceAttributeLayout layout = InstanceAttributeLayout::Matrices) const;
+    void DrawDepthInstanced(GLuint instanceVBO,
+                            GLsizei instanceCount,
+                            GLintptr instanceByteOffset = 0,
+                            InstanceAttributeLayout layout = InstanceAttributeLayout::Matrices) const;
     bool HasMeshes() const { return !m_meshes.empty(); }
+    const std::vector<std::unique_ptr<Mesh>>& GetMeshes() const { return m_meshes; }
     void OverrideAllTextures(Texture* texture);
     void ClearTextureOverrides();
     void ApplyTextureIfMissing(Texture* texture);
@@ -60,7 +140,18 @@ public:
     float GetBoundingRadius() const { return m_boundingRadius; }
     bool HasBounds() const { return m_hasBounds; }
     glm::vec3 GetBoundingHalfExtents() const;
+    const ModelQuantizationReport& GetQuantizationReport() const { return m_quantizationReport; }
+    /// @brief Texturas referenciadas pelos materiais, compartilhadas pelo TextureCache.
+    const std::vector<std::shared_ptr<Texture>>& GetTextures() const { return m_textures; }
     bool LoadFromScene(const aiScene* scene, const std::string& directory, const std::vector<std::string>& allowedNodes);
+    /// @brief Substitui o conteúdo pelo bake da chave, mantendo o arquivo mapeado enquanto o modelo viver.
+    /// false (modelo intacto) se o bake não existe ou não confere com a chave.
+    bool LoadFromBakedCache(const BakedModelKey& key);
+    /// @brief Grava o bake do último LoadFromScene e descarta a geometria e as origens de textura guardadas para ele.
+    /// importedFiles: arquivos que o Assimp abriu na importação; junto das texturas em arquivo viram dependências do bake.
+    bool WriteBakedCache(const BakedModelKey& key, const std::vector<std::string>& importedFiles);
+    /// @brief Descarta a cópia da importação guardada para o bake (geometria e origens de textura) sem gravá-lo.
+    void ReleaseImportData();
 
 private:
     void ProcessNode(aiNode* node, const aiScene* scene, const glm::mat4& parentTransform, bool parentIncluded);
@@ -69,22 +160,49 @@ private:
     Texture* LoadMaterialTexture(aiMaterial* material, aiTextureType type, const aiScene* scene);
     Texture* LoadEmbeddedTexture(const aiScene* scene, const std::string& identifier);
     Texture* LoadTextureFromPath(const std::string& filepath);
+    Texture* LoadTextureFromMemory(const unsigned char* data, std::size_t size);
+    Texture* LoadTextureFromRawData(const unsigned char* data, int width, int height);
+    Texture* AddTexture(std::shared_ptr<Texture> texture);
     static glm::mat4 ConvertMatrix(const aiMatrix4x4& matrix);
     void ResetBounds();
     void UpdateBounds(const glm::vec3& position);
     bool ShouldIncludeNode(const std::string& nodeName) const;
     static std::string NormalizeIdentifier(const std::string& name);
+    void UpdateBoundingSphere();
+
+    /// De onde veio cada textura importada, para o bake referenciar o arquivo ou embutir os bytes.
+    struct TextureSource
+    {
+        BakedTextureSource::Kind kind = BakedTextureSource::Kind::None;
+        std::vector<unsigned char> bytes;
+        int width = 0;
+        int height = 0;
+    };
 
     std::vector<std::unique_ptr<Mesh>> m_meshes;
     std::vector<std::unique_ptr<Material>> m_materials;
-    std::vector<std::unique_ptr<Texture>> m_ownedTextures;
+    std::vector<std::shared_ptr<Texture>> m_textures;
+    std::unordered_map<const Texture*, TextureSource> m_textureSources;
+    /// Geometria de cada mesh, como foi para o pool, guardada da importação até WriteBakedCache.
+    struct PendingGeometry
+    {
+        std::vector<Vertex> vertices; ///< Só em meshes float; os quantizados ficam em quantized.
+        QuantizedVertices quantized;
+        std::vector<unsigned int> indices;
+    };
+    std::vector<PendingGeometry> m_pendingGeometry;
+    /// Mapeamento do bake carregado: os meshes apontam para ele.
+    std::unique_ptr<BakedModelFile> m_bakedFile;
     std::string m_directory;
     Assimp::Importer m_importer;
+    /// IOSystem instalado em m_importer (que é o dono) no primeiro LoadFromFile.
+    RecordingIOSystem* m_importFiles = nullptr;
     glm::vec3 m_aabbMin{ 0.0f };
     glm::vec3 m_aabbMax{ 0.0f };
     glm::vec3 m_boundingCenter{ 0.0f };
     float m_boundingRadius = 0.0f;
     bool m_hasBounds = false;
+    ModelQuantizationReport m_quantizationReport;
     bool m_useNodeFilter = false;
     std::unordered_set<std::string> m_allowedNames;
 };
@@ -0,0 +1,207 @@
+#include "occlusion_queries.h"
+
+#include "geometry_pool.h"
+#include "render_state.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <array>
+#include <iostream>
+
+namespace
+{
+// Cubo unitário [-1, 1]; a matriz do teste escala para a caixa do objeto.
+constexpr std::array<GLfloat, 24> kBoxVertices{
+    -1.0f, -1.0f, -1.0f,  1.0f, -1.0f, -1.0f, -1.0f, 1.0f, -1.0f,  1.0f, 1.0f, -1.0f,
+    -1.0f, -1.0f,  1.0f,  1.0f, -1.0f,  1.0f, -1.0f, 1.0f,  1.0f,  1.0f, 1.0f,  1.0f,
+};
+
+// Cantos indexados por bits (x = bit 0, y = bit 1, z = bit 2), como no rasterizador por software.
+constexpr std::array<GLuint, 36> kBoxIndices{
+    0, 2, 6, 0, 6, 4, // -X
+    1, 5, 7, 1, 7, 3, // +X
+    0, 4, 5, 0, 5, 1, // -Y
+    2, 3, 7, 2, 7, 6, // +Y
+    0, 1, 3, 0, 3, 2, // -Z
+    4, 6, 7, 4, 7, 5, // +Z
+};
+}
+
+OcclusionQuerySet::~OcclusionQuerySet()
+{
+    Destroy();
+}
+
+bool OcclusionQuerySet::Create()
+{
+    Destroy();
+    // A variante conservadora (GL 4.3) pode responder "visível" a mais, mas custa menos que a exata.
+    m_target = GLAD_GL_VERSION_4_3 ? GL_ANY_SAMPLES_PASSED_CONSERVATIVE : GL_ANY_SAMPLES_PASSED;
+
+    RenderStateCache& state = RenderStateCache::Get();
+    glGenVertexArrays(1, &m_boxVAO);
+    glGenBuffers(1, &m_boxVBO);
+    glGenBuffers(1, &m_boxEBO);
+    if (m_boxVAO == 0 || m_boxVBO == 0 || m_boxEBO == 0)
+    {
+        std::cerr << "Falha ao criar a caixa das queries de oclusão." << std::endl;
+        Destroy();
+        return false;
+    }
+
+    state.BindVertexArray(m_boxVAO);
+    state.BindBuffer(GL_ARRAY_BUFFER, m_boxVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(kBoxVertices), kBoxVertices.data(), GL_STATIC_DRAW);
+    state.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_boxEBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(kBoxIndices), kBoxIndices.data(), GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), nullptr);
+    state.BindVertexArray(0);
+    return true;
+}
+
+void OcclusionQuerySet::Destroy()
+{
+    ReleaseQueries();
+    RenderStateCache& state = RenderStateCache::Get();
+    state.DeleteVertexArray(m_boxVAO);
+    state.DeleteBuffer(m_boxVBO);
+    state.DeleteBuffer(m_boxEBO);
+    m_boxVAO = 0;
+    m_boxVBO = 0;
+    m_boxEBO = 0;
+}
+
+void OcclusionQuerySet::ReleaseQueries()
+{
+    for (Slot& slot : m_slots)
+    {
+        if (slot.query != 0)
+        {
+            glDeleteQueries(1, &slot.query);
+        }
+    }
+    m_slots.clear();
+    m_pending.clear();
+}
+
+void OcclusionQuerySet::BeginFrame(std::size_t objectCount, std::uint64_t sceneRevision)
+{
+    if (sceneRevision != m_sceneRevision || objectCount != m_slots.size())
+    {
+        ReleaseQueries();
+        m_slots.resize(objectCount);
+        m_sceneRevision = sceneRevision;
+    }
+    ++m_frame;
+    m_pending.clear();
+    m_stats = {};
+}
+
+GLuint OcclusionQuerySet::AcquireConditionQuery(std::size_t objectIndex, std::size_t drawCount)
+{
+    if (objectIndex >= m_slots.size())
+    {
+        return 0;
+    }
+    // Só o resultado do frame imediatamente anterior vale: um mais velho pode ser de outro ponto de vista.
+    Slot& slot = m_slots[objectIndex];
+    if (slot.query == 0 || slot.issuedFrame + 1 != m_frame)
+    {
+        return 0;
+    }
+    if (slot.conditionFrame != m_frame)
+    {
+        slot.conditionFrame = m_frame;
+        slot.conditionDraws = 0;
+    }
+    slot.conditionDraws += drawCount;
+    return slot.query;
+}
+
+void OcclusionQuerySet::Request(std::size_t objectIndex,
+                                const glm::mat4& transform,
+                                const glm::vec3& center,
+                                const glm::vec3& halfExtents)
+{
+    if (objectIndex >= m_slots.size() || m_slots[objectIndex].requestedFrame == m_frame)
+    {
+        return;
+    }
+    m_slots[objectIndex].requestedFrame = m_frame;
+    ++m_stats.candidates;
+
+    glm::mat4 box(1.0f);
+    box[0][0] = halfExtents.x;
+    box[1][1] = halfExtents.y;
+    box[2][2] = halfExtents.z;
+    box[3] = glm::vec4(center, 1.0f);
+    m_pending.push_back(PendingBox{ objectIndex, transform * box });
+}
+
+void OcclusionQuerySet::HarvestResult(Slot& slot)
+{
+    if (slot.conditionFrame != m_frame)
+    {
+        return;
+    }
+    // A query ainda é a do frame anterior; consultar a disponibilidade não bloqueia.
+    GLuint available = GL_FALSE;
+    glGetQueryObjectuiv(slot.query, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (available == GL_FALSE)
+    {
+        ++m_stats.pending;
+        return;
+    }
+    GLuint anySamples = GL_TRUE;
+    glGetQueryObjectuiv(slot.query, GL_QUERY_RESULT, &anySamples);
+    if (anySamples == GL_FALSE)
+    {
+        m_stats.skippedDraws += slot.conditionDraws;
+    }
+}
+
+void OcclusionQuerySet::IssuePending(GLuint program, GLint modelLocation)
+{
+    if (m_pending.empty() || m_boxVAO == 0 || program == 0)
+    {
+        return;
+    }
+
+    RenderStateCache& state = RenderStateCache::Get();
+    state.UseProgram(program);
+    state.BindVertexArray(m_boxVAO);
+    // O programa é o de meshes: a caixa está em float, sem decodificação de posição.
+    GeometryPool::Get().ApplyDecode(VertexDecode{});
+    state.ColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    state.DepthMask(GL_FALSE);
+    state.DepthFunc(GL_LEQUAL);
+
+    for (const PendingBox& pending : m_pending)
+    {
+        Slot& slot = m_slots[pending.objectIndex];
+        if (slot.query == 0)
+        {
+            glGenQueries(1, &slot.query);
+        }
+        else
+        {
+            HarvestResult(slot);
+        }
+
+        if (modelLocation >= 0)
+        {
+            glUniformMatrix4fv(modelLocation, 1, GL_FALSE, glm::value_ptr(pending.boxToWorld));
+        }
+        glBeginQuery(m_target, slot.query);
+        glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(kBoxIndices.size()), GL_UNSIGNED_INT, nullptr);
+        glEndQuery(m_target);
+        slot.issuedFrame = m_frame;
+        ++m_stats.queries;
+    }
+    m_pending.clear();
+
+    state.ColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    state.DepthFunc(GL_LESS);
+    state.DepthMask(GL_TRUE);
+}
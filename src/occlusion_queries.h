@@ -0,0 +1,78 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct OcclusionQueryStats
+{
+    std::size_t candidates = 0;   ///< Objetos marcados com "occlusionQuery" que passaram pelo culling.
+    std::size_t queries = 0;      ///< Caixas testadas neste frame (resultado usado no próximo).
+    std::size_t skippedDraws = 0; ///< Draws condicionais descartados pela GPU (query sem amostras).
+    std::size_t pending = 0;      ///< Resultados ainda não prontos no fim do frame: desenharam sem condição.
+};
+
+/// @brief Queries de oclusão de hardware para meshes caros ("occlusionQuery" no JSON da cena).
+/// Depois da passada de cena a caixa de cada objeto é rasterizada sem cor nem escrita de depth dentro de uma
+/// query GL_ANY_SAMPLES_PASSED(_CONSERVATIVE); no frame seguinte o mesh real é desenhado sob
+/// glBeginConditionalRender com GL_QUERY_NO_WAIT. A CPU nunca espera: coerência temporal de um frame.
+class OcclusionQuerySet
+{
+public:
+    OcclusionQuerySet() = default;
+    ~OcclusionQuerySet();
+
+    OcclusionQuerySet(const OcclusionQuerySet&) = delete;
+    OcclusionQuerySet& operator=(const OcclusionQuerySet&) = delete;
+
+    bool Create();
+    void Destroy();
+
+    /// @brief Avança o frame; uma cena de outra revisão descarta as queries (índices mudaram).
+    void BeginFrame(std::size_t objectCount, std::uint64_t sceneRevision);
+
+    /// @brief Query emitida no frame anterior para o objeto, ou 0 (desenho incondicional).
+    /// drawCount são os draws que ficam condicionados a ela, somados às estatísticas se forem descartados;
+    /// passadas que repetem o objeto no mesmo frame (pré-passe) informam 0.
+    GLuint AcquireConditionQuery(std::size_t objectIndex, std::size_t drawCount);
+    /// @brief Agenda o teste da caixa center +- halfExtents, em espaço local de transform; uma vez por frame.
+    void Request(std::size_t objectIndex, const glm::mat4& transform, const glm::vec3& center, const glm::vec3& halfExtents);
+    /// @brief Emite as queries agendadas contra a depth atual com o programa só de posições informado.
+    /// Termina com color mask ligada, depth LESS e escrita de depth ligada.
+    void IssuePending(GLuint program, GLint modelLocation);
+
+    bool IsConservative() const { return m_target == GL_ANY_SAMPLES_PASSED_CONSERVATIVE; }
+    const OcclusionQueryStats& GetStats() const { return m_stats; }
+
+private:
+    struct Slot
+    {
+        GLuint query = 0;
+        std::uint64_t issuedFrame = 0;
+        std::uint64_t requestedFrame = 0;
+        std::uint64_t conditionFrame = 0;
+        std::size_t conditionDraws = 0;
+    };
+
+    struct PendingBox
+    {
+        std::size_t objectIndex = 0;
+        glm::mat4 boxToWorld{ 1.0f };
+    };
+
+    void ReleaseQueries();
+    void HarvestResult(Slot& slot);
+
+    GLenum m_target = GL_ANY_SAMPLES_PASSED;
+    GLuint m_boxVAO = 0;
+    GLuint m_boxVBO = 0;
+    GLuint m_boxEBO = 0;
+    std::vector<Slot> m_slots;
+    std::vector<PendingBox> m_pending;
+    std::uint64_t m_frame = 0;
+    std::uint64_t m_sceneRevision = 0;
+    OcclusionQueryStats m_stats{};
+};
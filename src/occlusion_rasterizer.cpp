@@ -0,0 +1,245 @@
+#include "occlusion_rasterizer.h"
+
+#include <xmmintrin.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+static_assert(OcclusionDepthBuffer::kWidth % 4 == 0, "Largura da depth precisa ser múltipla de 4 para o SSE");
+
+// Cantos indexados por bits (x = bit 0, y = bit 1, z = bit 2); duas faces por quad, sem descarte de verso.
+constexpr std::array<std::array<int, 3>, 12> kBoxTriangles{ {
+    { 0, 2, 6 }, { 0, 6, 4 }, // -X
+    { 1, 5, 7 }, { 1, 7, 3 }, // +X
+    { 0, 4, 5 }, { 0, 5, 1 }, // -Y
+    { 2, 3, 7 }, { 2, 7, 6 }, // +Y
+    { 0, 1, 3 }, { 0, 3, 2 }, // -Z
+    { 4, 6, 7 }, { 4, 7, 5 }, // +Z
+} };
+
+std::array<glm::vec4, 8> ProjectBoxCorners(const glm::mat4& viewProjection,
+                                           const glm::mat4& transform,
+                                           const glm::vec3& center,
+                                           const glm::vec3& halfExtents)
+{
+    const glm::mat4 toClip = viewProjection * transform;
+    std::array<glm::vec4, 8> corners{};
+    for (int i = 0; i < 8; ++i)
+    {
+        const glm::vec3 offset((i & 1) != 0 ? halfExtents.x : -halfExtents.x,
+                               (i & 2) != 0 ? halfExtents.y : -halfExtents.y,
+                               (i & 4) != 0 ? halfExtents.z : -halfExtents.z);
+        corners[i] = toClip * glm::vec4(center + offset, 1.0f);
+    }
+    return corners;
+}
+
+glm::vec3 ToScreen(const glm::vec4& clip)
+{
+    const float inverseW = 1.0f / clip.w;
+    return glm::vec3((clip.x * inverseW * 0.5f + 0.5f) * static_cast<float>(OcclusionDepthBuffer::kWidth),
+                     (clip.y * inverseW * 0.5f + 0.5f) * static_cast<float>(OcclusionDepthBuffer::kHeight),
+                     clip.z * inverseW * 0.5f + 0.5f);
+}
+
+/// Distância ao near plane em clip space (z = -w); negativa atrás dele.
+float NearDistance(const glm::vec4& clip)
+{
+    return clip.z + clip.w;
+}
+}
+
+OcclusionDepthBuffer::OcclusionDepthBuffer()
+    : m_depth(static_cast<std::size_t>(kWidth * kHeight), 1.0f)
+{
+}
+
+void OcclusionDepthBuffer::Clear(const glm::mat4& viewProjection)
+{
+    m_viewProjection = viewProjection;
+    m_triangles = 0;
+    std::fill(m_depth.begin(), m_depth.end(), 1.0f);
+}
+
+void OcclusionDepthBuffer::RasterizeBox(const glm::mat4& transform, const glm::vec3& center, const glm::vec3& halfExtents)
+{
+    const std::array<glm::vec4, 8> corners = ProjectBoxCorners(m_viewProjection, transform, center, halfExtents);
+    for (const auto& triangle : kBoxTriangles)
+    {
+        RasterizeClippedTriangle(corners[triangle[0]], corners[triangle[1]], corners[triangle[2]]);
+    }
+}
+
+void OcclusionDepthBuffer::RasterizeClippedTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c)
+{
+    // Sutherland-Hodgman só contra o near plane: x/y fora da tela são limitados pelo retângulo do raster.
+    const std::array<glm::vec4, 3> input{ a, b, c };
+    std::array<glm::vec4, 4> clipped{};
+    int clippedCount = 0;
+    for (int i = 0; i < 3; ++i)
+    {
+        const glm::vec4& current = input[i];
+        const glm::vec4& next = input[(i + 1) % 3];
+        const float currentDistance = NearDistance(current);
+        const float nextDistance = NearDistance(next);
+        if (currentDistance >= 0.0f)
+        {
+            clipped[clippedCount++] = current;
+        }
+        if ((currentDistance >= 0.0f) != (nextDistance >= 0.0f))
+        {
+            const float t = currentDistance / (currentDistance - nextDistance);
+            clipped[clippedCount++] = current + (next - current) * t;
+        }
+    }
+    if (clippedCount < 3)
+    {
+        return;
+    }
+
+    const glm::vec3 first = ToScreen(clipped[0]);
+    for (int i = 1; i + 1 < clippedCount; ++i)
+    {
+        RasterizeTriangle(first, ToScreen(clipped[i]), ToScreen(clipped[i + 1]));
+    }
+}
+
+void OcclusionDepthBuffer::RasterizeTriangle(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c)
+{
+    glm::vec3 v0 = a;
+    glm::vec3 v1 = b;
+    glm::vec3 v2 = c;
+    float area = (v1.x - v0.x) * (v2.y - v0.y) - (v2.x - v0.x) * (v1.y - v0.y);
+    if (std::abs(area) < 1e-6f)
+    {
+        return;
+    }
+    if (area < 0.0f)
+    {
+        std::swap(v1, v2);
+        area = -area;
+    }
+
+    const int minX = std::max(static_cast<int>(std::floor(std::min({ v0.x, v1.x, v2.x }))), 0);
+    const int maxX = std::min(static_cast<int>(std::ceil(std::max({ v0.x, v1.x, v2.x }))), kWidth - 1);
+    const int minY = std::max(static_cast<int>(std::floor(std::min({ v0.y, v1.y, v2.y }))), 0);
+    const int maxY = std::min(static_cast<int>(std::ceil(std::max({ v0.y, v1.y, v2.y }))), kHeight - 1);
+    if (minX > maxX || minY > maxY)
+    {
+        return;
+    }
+    ++m_triangles;
+
+    // Funções de aresta A*x + B*y + C, positivas no interior (ordem anti-horária).
+    const std::array<glm::vec3, 3> vertices{ v0, v1, v2 };
+    std::array<float, 3> edgeA{};
+    std::array<float, 3> edgeB{};
+    std::array<float, 3> edgeC{};
+    for (int i = 0; i < 3; ++i)
+    {
+        const glm::vec3& from = vertices[i];
+        const glm::vec3& to = vertices[(i + 1) % 3];
+        edgeA[i] = from.y - to.y;
+        edgeB[i] = to.x - from.x;
+        edgeC[i] = -(edgeA[i] * from.x + edgeB[i] * from.y);
+    }
+
+    // Plano de depth; cada pixel guarda o valor mais distante que o triângulo atinge dentro dele.
+    const float dzdx = ((v1.z - v0.z) * (v2.y - v0.y) - (v2.z - v0.z) * (v1.y - v0.y)) / area;
+    const float dzdy = ((v2.z - v0.z) * (v1.x - v0.x) - (v1.z - v0.z) * (v2.x - v0.x)) / area;
+    const float depthSlack = 0.5f * (std::abs(dzdx) + std::abs(dzdy));
+    const float depthLimit = std::max({ v0.z, v1.z, v2.z });
+
+    const __m128 laneOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 depthStepX = _mm_set1_ps(dzdx);
+    const __m128 maxDepth = _mm_set1_ps(depthLimit);
+    const int firstColumn = minX & ~3;
+    for (int y = minY; y <= maxY; ++y)
+    {
+        const float pixelY = static_cast<float>(y) + 0.5f;
+        const float rowDepth = v0.z + dzdy * (pixelY - v0.y) + depthSlack;
+        float* row = &m_depth[static_cast<std::size_t>(y * kWidth)];
+        for (int x = firstColumn; x <= maxX; x += 4)
+        {
+            const __m128 pixelX = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), laneOffsets);
+            __m128 inside = _mm_cmpeq_ps(zero, zero);
+            for (int edge = 0; edge < 3; ++edge)
+            {
+                const __m128 value = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(edgeA[edge]), pixelX),
+                                                _mm_set1_ps(edgeB[edge] * pixelY + edgeC[edge]));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(value, zero));
+            }
+            if (_mm_movemask_ps(inside) == 0)
+            {
+                continue;
+            }
+            const __m128 depth = _mm_min_ps(
+                _mm_add_ps(_mm_set1_ps(rowDepth), _mm_mul_ps(depthStepX, _mm_sub_ps(pixelX, _mm_set1_ps(v0.x)))),
+                maxDepth);
+            const __m128 stored = _mm_loadu_ps(row + x);
+            const __m128 nearest = _mm_min_ps(stored, depth);
+            _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, stored)));
+        }
+    }
+}
+
+bool OcclusionDepthBuffer::IsBoxVisible(const glm::mat4& transform,
+                                           const glm::vec3& center,
+                                           const glm::vec3& halfExtents) const
+{
+    const std::array<glm::vec4, 8> corners = ProjectBoxCorners(m_viewProjection, transform, center, halfExtents);
+    glm::vec2 screenMin(std::numeric_limits<float>::max());
+    glm::vec2 screenMax(-std::numeric_limits<float>::max());
+    float nearestDepth = std::numeric_limits<float>::max();
+    for (const glm::vec4& corner : corners)
+    {
+        if (NearDistance(corner) < 0.0f)
+        {
+            return true;
+        }
+        const glm::vec3 screen = ToScreen(corner);
+        screenMin = glm::min(screenMin, glm::vec2(screen.x, screen.y));
+        screenMax = glm::max(screenMax, glm::vec2(screen.x, screen.y));
+        nearestDepth = std::min(nearestDepth, screen.z);
+    }
+    if (screenMax.x < 0.0f || screenMax.y < 0.0f || screenMin.x >= static_cast<float>(kWidth) ||
+        screenMin.y >= static_cast<float>(kHeight))
+    {
+        return true;
+    }
+
+    const int minX = std::clamp(static_cast<int>(std::floor(screenMin.x)), 0, kWidth - 1);
+    const int maxX = std::clamp(static_cast<int>(std::floor(screenMax.x)), 0, kWidth - 1);
+    const int minY = std::clamp(static_cast<int>(std::floor(screenMin.y)), 0, kHeight - 1);
+    const int maxY = std::clamp(static_cast<int>(std::floor(screenMax.y)), 0, kHeight - 1);
+
+    // Visível assim que algum pixel do retângulo tiver depth atrás (ou no mesmo ponto) da caixa.
+    const __m128 boxDepth = _mm_set1_ps(nearestDepth);
+    const int firstColumn = minX & ~3;
+    for (int y = minY; y <= maxY; ++y)
+    {
+        const float* row = &m_depth[static_cast<std::size_t>(y * kWidth)];
+        for (int x = firstColumn; x <= maxX; x += 4)
+        {
+            int laneMask = _mm_movemask_ps(_mm_cmpge_ps(_mm_loadu_ps(row + x), boxDepth));
+            if (x < minX)
+            {
+                laneMask &= 0xF << (minX - x);
+            }
+            if (x + 3 > maxX)
+            {
+                laneMask &= 0xF >> (x + 3 - maxX);
+            }
+            if (laneMask != 0)
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
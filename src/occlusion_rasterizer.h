@@ -0,0 +1,39 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <vector>
+
+/// @brief Depth de baixa resolução para oclusão na CPU: caixas oclusoras rasterizadas quatro pixels por passo
+/// em SSE e caixas testadas contra o resultado. Só depende do glm: roda e é testada sem contexto GL.
+/// Cobertura amostrada no centro do pixel, como na GPU; a depth guardada é a mais distante dentro do pixel.
+class OcclusionDepthBuffer
+{
+public:
+    static constexpr int kWidth = 256;
+    static constexpr int kHeight = 128;
+
+    OcclusionDepthBuffer();
+
+    /// @brief Limpa a depth (1 = far) e fixa a view-projection usada pelas chamadas seguintes.
+    void Clear(const glm::mat4& viewProjection);
+    /// @brief Rasteriza a caixa center +- halfExtents, em espaço local de transform, como oclusora.
+    /// Só deve receber volumes sólidos contidos na geometria real que representam.
+    void RasterizeBox(const glm::mat4& transform, const glm::vec3& center, const glm::vec3& halfExtents);
+    /// @brief false só se toda a área da caixa na tela está atrás da depth rasterizada.
+    /// Caixas que cruzam o near plane ou estão fora da tela contam como visíveis (o frustum decide).
+    bool IsBoxVisible(const glm::mat4& transform, const glm::vec3& center, const glm::vec3& halfExtents) const;
+
+    float GetDepth(int x, int y) const { return m_depth[static_cast<std::size_t>(y * kWidth + x)]; }
+    /// @brief Triângulos rasterizados desde o último Clear, após o recorte no near plane.
+    std::size_t GetTriangleCount() const { return m_triangles; }
+
+private:
+    void RasterizeTriangle(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c);
+    void RasterizeClippedTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c);
+
+    std::vector<float> m_depth;
+    glm::mat4 m_viewProjection{ 1.0f };
+    std::size_t m_triangles = 0;
+};
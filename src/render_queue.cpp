@@ -0,0 +1,321 @@
+#include "render_queue.h"
+
+#include "material.h"
+#include "model.h"
+#include "render_state.h"
+
+#include <algorithm>
+
+#include <glm/gtc/type_ptr.hpp>
+
+namespace
+{
+// Layout da chave (MSB -> LSB): programa | material | textura | VAO | profundidade.
+// O estado fica nos bits altos para agrupar binds; a profundidade ordena front-to-back
+// dentro de cada grupo, favorecendo o early-z nos draws opacos.
+constexpr std::uint32_t kProgramBits = 8;
+constexpr std::uint32_t kMaterialBits = 16;
+constexpr std::uint32_t kTextureBits = 12;
+constexpr std::uint32_t kVertexArrayBits = 12;
+constexpr std::uint32_t kDepthBits = 16;
+
+constexpr std::uint32_t kDepthShift = 0;
+constexpr std::uint32_t kVertexArrayShift = kDepthShift + kDepthBits;
+constexpr std::uint32_t kTextureShift = kVertexArrayShift + kVertexArrayBits;
+constexpr std::uint32_t kMaterialShift = kTextureShift + kTextureBits;
+constexpr std::uint32_t kProgramShift = kMaterialShift + kMaterialBits;
+
+static_assert(kProgramShift + kProgramBits == 64, "Chave de ordenação deve ocupar 64 bits");
+
+constexpr std::uint32_t MaxValue(std::uint32_t bits)
+{
+    return (1u << bits) - 1u;
+}
+}
+
+void RenderQueue::Clear()
+{
+    m_items.clear();
+    m_sortedEntries.clear();
+    m_programSlots.clear();
+    m_materialSlots.clear();
+    m_textureSlots.clear();
+    m_vertexArraySlots.clear();
+    m_sorted = false;
+}
+
+void RenderQueue::SetDepthRange(float nearPlane, float farPlane)
+{
+    m_depthNear = nearPlane;
+    m_depthFar = std::max(farPlane, nearPlane + 0.001f);
+}
+
+void RenderQueue::PushModel(const Model& model,
+                            GLuint program,
+                            GLuint fallbackTexture,
+                            const glm::mat4& modelMatrix,
+                            const glm::mat3& normalMatrix,
+                            float viewDepth,
+                            GLuint conditionQuery)
+{
+    for (const auto& mesh : model.GetMeshes())
+    {
+        if (mesh)
+        {
+            Push(*mesh, program, fallbackTexture, modelMatrix, normalMatrix, viewDepth, conditionQuery);
+        }
+    }
+}
+
+void RenderQueue::Push(const Mesh& mesh,
+                       GLuint program,
+                       GLuint fallbackTexture,
+                       const glm::mat4& modelMatrix,
+                       const glm::mat3& normalMatrix,
+                       float viewDepth,
+                       GLuint conditionQuery)
+{
+    RenderQueueItem item;
+    item.program = program;
+    item.modelMatrix = modelMatrix;
+    item.normalMatrix = normalMatrix;
+    item.conditionQuery = conditionQuery;
+    PushItem(item, mesh, fallbackTexture, viewDepth);
+}
+
+void RenderQueue::PushModelInstanced(const Model& model,
+                                     GLuint program,
+                                     GLuint fallbackTexture,
+                                     GLintptr instanceByteOffset,
+                                     GLsizei instanceCount,
+                                     float viewDepth)
+{
+    if (instanceCount <= 0)
+    {
+        return;
+    }
+
+    for (const auto& mesh : model.GetMeshes())
+    {
+        if (!mesh)
+        {
+            continue;
+        }
+        RenderQueueItem item;
+        item.program = program;
+        item.instanceCount = instanceCount;
+        item.instanceByteOffset = instanceByteOffset;
+        PushItem(item, *mesh, fallbackTexture, viewDepth);
+    }
+}
+
+void RenderQueue::PushItem(RenderQueueItem item, const Mesh& mesh, GLuint fallbackTexture, float viewDepth)
+{
+    item.mesh = &mesh;
+    if (m_depthOnly)
+    {
+        // Material e textura nulos: o Flush pula Apply e binds; a chave agrupa só por programa e VAO.
+        item.vertexArray = mesh.GetDepthVertexArray();
+    }
+    else
+    {
+        item.material = mesh.GetMaterial();
+        item.texture = fallbackTexture;
+        if (item.material != nullptr && item.material->HasTexture())
+        {
+            item.texture = item.material->GetActiveTexture()->GetID();
+        }
+        item.vertexArray = mesh.GetVertexArray();
+    }
+    item.sortKey = BuildSortKey(item, viewDepth);
+
+    m_items.push_back(item);
+    m_sorted = false;
+}
+
+void RenderQueue::Sort()
+{
+    m_sortedEntries.resize(m_items.size());
+    for (std::size_t i = 0; i < m_items.size(); ++i)
+    {
+        m_sortedEntries[i] = SortEntry{ m_items[i].sortKey, static_cast<std::uint32_t>(i) };
+    }
+
+    std::sort(m_sortedEntries.begin(), m_sortedEntries.end(), [](const SortEntry& a, const SortEntry& b) {
+        return a.key < b.key;
+    });
+    m_sorted = true;
+}
+
+void RenderQueue::Flush(GLint modelLocation,
+                        GLint normalMatrixLocation,
+                        GLint instancingLocation,
+                        GLuint instanceBuffer,
+                        GLintptr instanceBaseOffset)
+{
+    if (m_items.empty())
+    {
+        return;
+    }
+    if (!m_sorted)
+    {
+        Sort();
+    }
+
+    RenderStateCache& state = RenderStateCache::Get();
+    bool stateKnown = false;
+    GLuint boundProgram = 0;
+    const Material* appliedMaterial = nullptr;
+    GLuint boundTexture = 0;
+    GLuint boundVertexArray = 0;
+    GLuint instanceAttributesVertexArray = 0;
+    bool instancingEnabled = false;
+
+    for (const SortEntry& entry : m_sortedEntries)
+    {
+        const RenderQueueItem& item = m_items[entry.index];
+
+        if (!stateKnown || item.program != boundProgram)
+        {
+            state.UseProgram(item.program);
+            boundProgram = item.program;
+            instancingEnabled = false;
+            if (instancingLocation >= 0)
+            {
+                glUniform1i(instancingLocation, 0);
+            }
+            ++m_stats.programBinds;
+        }
+        else
+        {
+            ++m_stats.skippedBinds;
+        }
+
+        if (item.material != nullptr && (!stateKnown || item.material != appliedMaterial))
+        {
+            item.material->Apply();
+            appliedMaterial = item.material;
+            ++m_stats.materialApplies;
+        }
+        else if (item.material != nullptr)
+        {
+            ++m_stats.skippedBinds;
+        }
+
+        if (item.texture != 0 && (!stateKnown || item.texture != boundTexture))
+        {
+            state.BindTextureUnit(GL_TEXTURE0, GL_TEXTURE_2D, item.texture);
+            boundTexture = item.texture;
+            ++m_stats.textureBinds;
+        }
+        else if (item.texture != 0)
+        {
+            ++m_stats.skippedBinds;
+        }
+
+        if (!stateKnown || item.vertexArray != boundVertexArray)
+        {
+            state.BindVertexArray(item.vertexArray);
+            boundVertexArray = item.vertexArray;
+            ++m_stats.vertexArrayBinds;
+        }
+        else
+        {
+            ++m_stats.skippedBinds;
+        }
+
+        stateKnown = true;
+
+        const bool instanced = item.instanceCount > 0 && instanceBuffer != 0;
+        if (instanced != instancingEnabled && instancingLocation >= 0)
+        {
+            glUniform1i(instancingLocation, instanced ? 1 : 0);
+        }
+        instancingEnabled = instanced;
+
+        if (instanced)
+        {
+            // Com base instance os ponteiros de instância só precisam ser feitos uma vez por VAO.
+            const bool bindAttributes = instanceAttributesVertexArray != item.vertexArray;
+            item.mesh->DrawInstancedRange(instanceBuffer,
+                                          instanceBaseOffset + item.instanceByteOffset,
+                                          item.instanceCount,
+                                          bindAttributes);
+            instanceAttributesVertexArray = item.vertexArray;
+            ++m_stats.instancedDraws;
+            m_stats.instances += static_cast<std::size_t>(item.instanceCount);
+        }
+        else
+        {
+            if (modelLocation >= 0)
+            {
+                glUniformMatrix4fv(modelLocation, 1, GL_FALSE, glm::value_ptr(item.modelMatrix));
+            }
+            if (normalMatrixLocation >= 0)
+            {
+                glUniformMatrix3fv(normalMatrixLocation, 1, GL_FALSE, glm::value_ptr(item.normalMatrix));
+            }
+            if (item.conditionQuery != 0)
+            {
+                // Sem espera: se o resultado ainda não chegou, a GPU desenha normalmente.
+                glBeginConditionalRender(item.conditionQuery, GL_QUERY_NO_WAIT);
+                item.mesh->DrawElements();
+                glEndConditionalRender();
+                ++m_stats.conditionalDraws;
+            }
+            else
+            {
+                item.mesh->DrawElements();
+            }
+        }
+        ++m_stats.draws;
+    }
+
+    if (instancingEnabled && instancingLocation >= 0)
+    {
+        glUniform1i(instancingLocation, 0);
+    }
+}
+
+std::uint64_t RenderQueue::BuildSortKey(const RenderQueueItem& item, float viewDepth)
+{
+    // Draws instanciados trocam o uniform de instancing: tratados como uma variante do programa.
+    const std::uintptr_t programHandle =
+        (static_cast<std::uintptr_t>(item.program) << 1) | (item.instanceCount > 0 ? 1u : 0u);
+    const std::uint64_t programSlot =
+        ResolveSlot(m_programSlots, programHandle, MaxValue(kProgramBits));
+    const std::uint64_t materialSlot =
+        ResolveSlot(m_materialSlots, reinterpret_cast<std::uintptr_t>(item.material), MaxValue(kMaterialBits));
+    const std::uint64_t textureSlot =
+        ResolveSlot(m_textureSlots, static_cast<std::uintptr_t>(item.texture), MaxValue(kTextureBits));
+    const std::uint64_t vertexArraySlot =
+        ResolveSlot(m_vertexArraySlots, static_cast<std::uintptr_t>(item.vertexArray), MaxValue(kVertexArrayBits));
+
+    const float normalizedDepth =
+        std::clamp((viewDepth - m_depthNear) / (m_depthFar - m_depthNear), 0.0f, 1.0f);
+    const std::uint64_t depthBits =
+        static_cast<std::uint64_t>(normalizedDepth * static_cast<float>(MaxValue(kDepthBits)));
+
+    return (programSlot << kProgramShift) |
+           (materialSlot << kMaterialShift) |
+           (textureSlot << kTextureShift) |
+           (vertexArraySlot << kVertexArrayShift) |
+           (depthBits << kDepthShift);
+}
+
+std::uint32_t RenderQueue::ResolveSlot(std::unordered_map<std::uintptr_t, std::uint32_t>& slots,
+                                       std::uintptr_t handle,
+                                       std::uint32_t maxSlot)
+{
+    // Slots compactos por frame: nomes GL/ponteiros viram índices pequenos que cabem nos bits da chave.
+    // Se estourar, os excedentes compartilham o último slot; o Flush compara os valores reais,
+    // então isso custa apenas binds a mais, nunca um draw incorreto.
+    auto it = slots.find(handle);
+    if (it != slots.end())
+    {
+        return it->second;
+    }
+    const std::uint32_t slot = std::min(static_cast<std::uint32_t>(slots.size()), maxSlot);
+    slots.emplace(handle, slot);
+    return slot;
+}
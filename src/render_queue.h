@@ -0,0 +1,120 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class Mesh;
+class Model;
+class Material;
+
+struct RenderQueueItem
+{
+    std::uint64_t sortKey = 0;
+    const Mesh* mesh = nullptr;
+    const Material* material = nullptr;
+    GLuint program = 0;
+    GLuint texture = 0;
+    GLuint vertexArray = 0;
+    glm::mat4 modelMatrix{ 1.0f };
+    glm::mat3 normalMatrix{ 1.0f };
+    GLsizei instanceCount = 0;
+    GLintptr instanceByteOffset = 0;
+    GLuint conditionQuery = 0; ///< Query de oclusão do frame anterior; != 0 desenha sob glBeginConditionalRender.
+};
+
+struct RenderQueueStats
+{
+    std::size_t draws = 0;
+    std::size_t instancedDraws = 0;
+    std::size_t instances = 0;
+    std::size_t programBinds = 0;
+    std::size_t materialApplies = 0;
+    std::size_t textureBinds = 0;
+    std::size_t vertexArrayBinds = 0;
+    std::size_t skippedBinds = 0;
+    std::size_t conditionalDraws = 0;
+};
+
+/// @brief Fila de desenho por frame: coleta os meshes visíveis, ordena por uma chave de 64 bits
+/// (programa, material, textura, VAO e profundidade) e submete pulando binds redundantes.
+class RenderQueue
+{
+public:
+    void Clear();
+    void SetDepthRange(float nearPlane, float farPlane);
+    /// @brief Itens seguintes usam o VAO só de posições e não carregam material nem textura.
+    void SetDepthOnly(bool depthOnly) { m_depthOnly = depthOnly; }
+
+    /// @brief Enfileira todos os meshes do modelo com a mesma matriz e profundidade de visão.
+    /// normalMatrix é a inversa transposta já calculada pelo chamador (uma vez por objeto).
+    /// conditionQuery != 0 condiciona cada draw ao resultado dessa query, sem esperar por ele (GL_QUERY_NO_WAIT).
+    void PushModel(const Model& model,
+                   GLuint program,
+                   GLuint fallbackTexture,
+                   const glm::mat4& modelMatrix,
+                   const glm::mat3& normalMatrix,
+                   float viewDepth,
+                   GLuint conditionQuery = 0);
+    void Push(const Mesh& mesh,
+              GLuint program,
+              GLuint fallbackTexture,
+              const glm::mat4& modelMatrix,
+              const glm::mat3& normalMatrix,
+              float viewDepth,
+              GLuint conditionQuery = 0);
+
+    /// @brief Enfileira um grupo instanciado cujas matrizes já estão no buffer de instâncias a partir de
+    /// instanceByteOffset.
+    void PushModelInstanced(const Model& model,
+                            GLuint program,
+                            GLuint fallbackTexture,
+                            GLintptr instanceByteOffset,
+                            GLsizei instanceCount,
+                            float viewDepth);
+
+    void Sort();
+
+    /// @brief Desenha os itens na ordem da chave. O estado GL de entrada é tratado como desconhecido.
+    /// instanceBaseOffset é somado ao instanceByteOffset de cada item (início do upload no buffer).
+    /// normalMatrixLocation < 0 dispensa o envio da matriz de normais (passadas só de depth).
+    void Flush(GLint modelLocation,
+               GLint normalMatrixLocation = -1,
+               GLint instancingLocation = -1,
+               GLuint instanceBuffer = 0,
+               GLintptr instanceBaseOffset = 0);
+
+    bool IsEmpty() const { return m_items.empty(); }
+    std::size_t GetItemCount() const { return m_items.size(); }
+    const RenderQueueStats& GetStats() const { return m_stats; }
+    void ResetStats() { m_stats = {}; }
+
+private:
+    struct SortEntry
+    {
+        std::uint64_t key = 0;
+        std::uint32_t index = 0;
+    };
+
+    void PushItem(RenderQueueItem item, const Mesh& mesh, GLuint fallbackTexture, float viewDepth);
+    std::uint64_t BuildSortKey(const RenderQueueItem& item, float viewDepth);
+    static std::uint32_t ResolveSlot(std::unordered_map<std::uintptr_t, std::uint32_t>& slots,
+                                     std::uintptr_t handle,
+                                     std::uint32_t maxSlot);
+
+    std::vector<RenderQueueItem> m_items;
+    std::vector<SortEntry> m_sortedEntries;
+    std::unordered_map<std::uintptr_t, std::uint32_t> m_programSlots;
+    std::unordered_map<std::uintptr_t, std::uint32_t> m_materialSlots;
+    std::unordered_map<std::uintptr_t, std::uint32_t> m_textureSlots;
+    std::unordered_map<std::uintptr_t, std::uint32_t> m_vertexArraySlots;
+    float m_depthNear = 0.0f;
+    float m_depthFar = 100.0f;
+    bool m_sorted = false;
+    bool m_depthOnly = false;
+    RenderQueueStats m_stats{};
+};
@@ -0,0 +1,399 @@
+#include "render_state.h"
+
+namespace
+{
+constexpr std::array<GLenum, 9> kBufferTargets{
+    GL_ARRAY_BUFFER,
+    GL_UNIFORM_BUFFER,
+    GL_SHADER_STORAGE_BUFFER,
+    GL_DRAW_INDIRECT_BUFFER,
+    GL_TEXTURE_BUFFER,
+    GL_COPY_READ_BUFFER,
+    GL_COPY_WRITE_BUFFER,
+    GL_PIXEL_PACK_BUFFER,
+    GL_PIXEL_UNPACK_BUFFER,
+};
+
+constexpr std::array<GLenum, 4> kTextureTargets{
+    GL_TEXTURE_2D,
+    GL_TEXTURE_2D_ARRAY,
+    GL_TEXTURE_CUBE_MAP,
+    GL_TEXTURE_BUFFER,
+};
+
+constexpr std::array<GLenum, 6> kCapabilities{
+    GL_DEPTH_TEST,
+    GL_DEPTH_CLAMP,
+    GL_BLEND,
+    GL_CULL_FACE,
+    GL_SCISSOR_TEST,
+    GL_POLYGON_OFFSET_FILL,
+};
+
+RenderStateCache* g_currentCache = nullptr;
+}
+
+RenderStateCache& RenderStateCache::Get()
+{
+    if (g_currentCache != nullptr)
+    {
+        return *g_currentCache;
+    }
+    static RenderStateCache fallbackCache;
+    return fallbackCache;
+}
+
+void RenderStateCache::SetCurrent(RenderStateCache* cache)
+{
+    g_currentCache = cache;
+    // Quem assume não viu as chamadas feitas pelo cache anterior.
+    Get().Invalidate();
+}
+
+void RenderStateCache::Invalidate()
+{
+    const RenderStateStats stats = m_stats;
+    *this = RenderStateCache();
+    m_stats = stats;
+}
+
+int RenderStateCache::BufferTargetSlot(GLenum target)
+{
+    for (std::size_t i = 0; i < kBufferTargets.size(); ++i)
+    {
+        if (kBufferTargets[i] == target)
+        {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+int RenderStateCache::TextureTargetSlot(GLenum target)
+{
+    for (std::size_t i = 0; i < kTextureTargets.size(); ++i)
+    {
+        if (kTextureTargets[i] == target)
+        {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+int RenderStateCache::CapabilitySlot(GLenum capability)
+{
+    for (std::size_t i = 0; i < kCapabilities.size(); ++i)
+    {
+        if (kCapabilities[i] == capability)
+        {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+int RenderStateCache::ResolveActiveUnit()
+{
+    if (!m_activeUnit.known)
+    {
+        GLint activeTexture = GL_TEXTURE0;
+        glGetIntegerv(GL_ACTIVE_TEXTURE, &activeTexture);
+        m_activeUnit.value = activeTexture - GL_TEXTURE0;
+        m_activeUnit.known = true;
+    }
+    return m_activeUnit.value;
+}
+
+void RenderStateCache::UseProgram(GLuint program)
+{
+    if (Update(m_program, program))
+    {
+        glUseProgram(program);
+    }
+}
+
+GLuint RenderStateCache::GetProgram()
+{
+    if (!m_program.known)
+    {
+        GLint program = 0;
+        glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+        m_program.value = static_cast<GLuint>(program);
+        m_program.known = true;
+    }
+    return m_program.value;
+}
+
+void RenderStateCache::BindVertexArray(GLuint vertexArray)
+{
+    if (Update(m_vertexArray, vertexArray))
+    {
+        glBindVertexArray(vertexArray);
+    }
+}
+
+void RenderStateCache::BindBuffer(GLenum target, GLuint buffer)
+{
+    const int slot = BufferTargetSlot(target);
+    if (slot < 0)
+    {
+        ++m_stats.issuedCalls;
+        glBindBuffer(target, buffer);
+        return;
+    }
+    if (Update(m_buffers[static_cast<std::size_t>(slot)], buffer))
+    {
+        glBindBuffer(target, buffer);
+    }
+}
+
+void RenderStateCache::BindBufferBase(GLenum target, GLuint index, GLuint buffer)
+{
+    const int slot = BufferTargetSlot(target);
+    if (target != GL_UNIFORM_BUFFER || index >= static_cast<GLuint>(kMaxUniformBufferBindings))
+    {
+        ++m_stats.issuedCalls;
+        glBindBufferBase(target, index, buffer);
+        if (slot >= 0)
+        {
+            m_buffers[static_cast<std::size_t>(slot)] = { buffer, true };
+        }
+        return;
+    }
+    if (Update(m_uniformBufferBindings[index], buffer))
+    {
+        glBindBufferBase(target, index, buffer);
+        m_buffers[static_cast<std::size_t>(slot)] = { buffer, true };
+    }
+}
+
+void RenderStateCache::ActiveTexture(GLenum textureUnit)
+{
+    const int unit = static_cast<int>(textureUnit - GL_TEXTURE0);
+    if (Update(m_activeUnit, unit))
+    {
+        glActiveTexture(textureUnit);
+    }
+}
+
+void RenderStateCache::BindTexture(GLenum target, GLuint texture)
+{
+    const int unit = ResolveActiveUnit();
+    const int slot = TextureTargetSlot(target);
+    if (slot < 0 || unit < 0 || unit >= kMaxTextureUnits)
+    {
+        ++m_stats.issuedCalls;
+        glBindTexture(target, texture);
+        return;
+    }
+    if (Update(m_textures[static_cast<std::size_t>(unit)][static_cast<std::size_t>(slot)], texture))
+    {
+        glBindTexture(target, texture);
+    }
+}
+
+void RenderStateCache::BindTextureUnit(GLenum textureUnit, GLenum target, GLuint texture)
+{
+    const int unit = static_cast<int>(textureUnit - GL_TEXTURE0);
+    const int slot = TextureTargetSlot(target);
+    if (slot >= 0 && unit >= 0 && unit < kMaxTextureUnits)
+    {
+        const Tracked<GLuint>& bound = m_textures[static_cast<std::size_t>(unit)][static_cast<std::size_t>(slot)];
+        if (bound.known && bound.value == texture)
+        {
+            ++m_stats.skippedCalls;
+            return;
+        }
+    }
+    ActiveTexture(textureUnit);
+    BindTexture(target, texture);
+}
+
+void RenderStateCache::BindFramebuffer(GLenum target, GLuint framebuffer)
+{
+    if (target == GL_FRAMEBUFFER)
+    {
+        const bool drawChanged = !m_drawFramebuffer.known || m_drawFramebuffer.value != framebuffer;
+        const bool readChanged = !m_readFramebuffer.known || m_readFramebuffer.value != framebuffer;
+        if (!drawChanged && !readChanged)
+        {
+            ++m_stats.skippedCalls;
+            return;
+        }
+        m_drawFramebuffer = { framebuffer, true };
+        m_readFramebuffer = { framebuffer, true };
+        ++m_stats.issuedCalls;
+        glBindFramebuffer(target, framebuffer);
+        return;
+    }
+
+    Tracked<GLuint>& tracked = target == GL_READ_FRAMEBUFFER ? m_readFramebuffer : m_drawFramebuffer;
+    if (Update(tracked, framebuffer))
+    {
+        glBindFramebuffer(target, framebuffer);
+    }
+}
+
+void RenderStateCache::SetEnabled(GLenum capability, bool enabled)
+{
+    const int slot = CapabilitySlot(capability);
+    if (slot >= 0 && !Update(m_capabilities[static_cast<std::size_t>(slot)], enabled))
+    {
+        return;
+    }
+    if (slot < 0)
+    {
+        ++m_stats.issuedCalls;
+    }
+    if (enabled)
+    {
+        glEnable(capability);
+    }
+    else
+    {
+        glDisable(capability);
+    }
+}
+
+bool RenderStateCache::IsEnabled(GLenum capability)
+{
+    const int slot = CapabilitySlot(capability);
+    if (slot < 0)
+    {
+        return glIsEnabled(capability) == GL_TRUE;
+    }
+    Tracked<bool>& tracked = m_capabilities[static_cast<std::size_t>(slot)];
+    if (!tracked.known)
+    {
+        tracked = { glIsEnabled(capability) == GL_TRUE, true };
+    }
+    return tracked.value;
+}
+
+void RenderStateCache::DepthFunc(GLenum func)
+{
+    if (Update(m_depthFunc, func))
+    {
+        glDepthFunc(func);
+    }
+}
+
+void RenderStateCache::DepthMask(GLboolean enabled)
+{
+    if (Update(m_depthMask, enabled))
+    {
+        glDepthMask(enabled);
+    }
+}
+
+void RenderStateCache::ColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha)
+{
+    if (Update(m_colorMask, std::array<GLboolean, 4>{ red, green, blue, alpha }))
+    {
+        glColorMask(red, green, blue, alpha);
+    }
+}
+
+void RenderStateCache::BlendFunc(GLenum sourceFactor, GLenum destinationFactor)
+{
+    if (Update(m_blendFunc, std::array<GLenum, 2>{ sourceFactor, destinationFactor }))
+    {
+        glBlendFunc(sourceFactor, destinationFactor);
+    }
+}
+
+void RenderStateCache::Viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    if (Update(m_viewport, std::array<GLint, 4>{ x, y, width, height }))
+    {
+        glViewport(x, y, width, height);
+    }
+}
+
+void RenderStateCache::DeleteTexture(GLuint texture)
+{
+    if (texture == 0)
+    {
+        return;
+    }
+    glDeleteTextures(1, &texture);
+    for (auto& unit : m_textures)
+    {
+        for (Tracked<GLuint>& bound : unit)
+        {
+            if (bound.known && bound.value == texture)
+            {
+                bound.value = 0;
+            }
+        }
+    }
+}
+
+void RenderStateCache::DeleteBuffer(GLuint buffer)
+{
+    if (buffer == 0)
+    {
+        return;
+    }
+    glDeleteBuffers(1, &buffer);
+    for (Tracked<GLuint>& bound : m_buffers)
+    {
+        if (bound.known && bound.value == buffer)
+        {
+            bound.value = 0;
+        }
+    }
+    // Se bindings indexados também voltam a 0 varia entre versões do GL: esquece só os afetados.
+    for (Tracked<GLuint>& bound : m_uniformBufferBindings)
+    {
+        if (bound.known && bound.value == buffer)
+        {
+            bound.known = false;
+        }
+    }
+}
+
+void RenderStateCache::DeleteVertexArray(GLuint vertexArray)
+{
+    if (vertexArray == 0)
+    {
+        return;
+    }
+    glDeleteVertexArrays(1, &vertexArray);
+    if (m_vertexArray.known && m_vertexArray.value == vertexArray)
+    {
+        m_vertexArray.value = 0;
+    }
+}
+
+void RenderStateCache::DeleteFramebuffer(GLuint framebuffer)
+{
+    if (framebuffer == 0)
+    {
+        return;
+    }
+    glDeleteFramebuffers(1, &framebuffer);
+    if (m_drawFramebuffer.known && m_drawFramebuffer.value == framebuffer)
+    {
+        m_drawFramebuffer.value = 0;
+    }
+    if (m_readFramebuffer.known && m_readFramebuffer.value == framebuffer)
+    {
+        m_readFramebuffer.value = 0;
+    }
+}
+
+void RenderStateCache::DeleteProgram(GLuint program)
+{
+    if (program == 0)
+    {
+        return;
+    }
+    glDeleteProgram(program);
+    // Um programa em uso só é liberado quando deixa de ser corrente; o nome pode voltar num glCreateProgram.
+    if (m_program.known && m_program.value == program)
+    {
+        m_program.known = false;
+    }
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <array>
+#include <cstddef>
+
+struct RenderStateStats
+{
+    std::size_t issuedCalls = 0;
+    std::size_t skippedCalls = 0;
+};
+
+/// @brief Espelho do estado GL de binding e pipeline: programa, VAO, buffers, unidades de textura,
+/// capacidades (depth/blend/cull), máscaras, framebuffers e viewport. Chamadas que não mudam nada são
+/// descartadas e contadas. Estado nunca observado é desconhecido e sempre emitido; Invalidate volta tudo a esse ponto.
+/// O Renderer possui a instância ativa; Get() a expõe para model, material, texture e os demais módulos que fazem binds.
+class RenderStateCache
+{
+public:
+    static constexpr int kMaxTextureUnits = 16;
+    static constexpr int kMaxUniformBufferBindings = 8;
+
+    /// @brief Cache ativo; antes do Renderer registrar o seu, uma instância interna faz o mesmo papel.
+    static RenderStateCache& Get();
+    /// @brief Registra (ou remove, com nullptr) o cache ativo. O cache que assume começa invalidado.
+    static void SetCurrent(RenderStateCache* cache);
+
+    void Invalidate();
+
+    void UseProgram(GLuint program);
+    /// @brief Programa corrente; consulta o driver se ainda desconhecido.
+    GLuint GetProgram();
+    void BindVertexArray(GLuint vertexArray);
+    /// @brief GL_ELEMENT_ARRAY_BUFFER é estado do VAO: sempre repassado ao driver.
+    void BindBuffer(GLenum target, GLuint buffer);
+    /// @brief Binding indexado de UBO; também altera o binding genérico do alvo, como no GL.
+    void BindBufferBase(GLenum target, GLuint index, GLuint buffer);
+    void ActiveTexture(GLenum textureUnit);
+    /// @brief Vincula na unidade ativa.
+    void BindTexture(GLenum target, GLuint texture);
+    /// @brief Vincula na unidade indicada (GL_TEXTURE0 + n), trocando a unidade ativa só se o binding mudar.
+    void BindTextureUnit(GLenum textureUnit, GLenum target, GLuint texture);
+    void BindFramebuffer(GLenum target, GLuint framebuffer);
+    void SetEnabled(GLenum capability, bool enabled);
+    void Enable(GLenum capability) { SetEnabled(capability, true); }
+    void Disable(GLenum capability) { SetEnabled(capability, false); }
+    bool IsEnabled(GLenum capability);
+    void DepthFunc(GLenum func);
+    void DepthMask(GLboolean enabled);
+    void ColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha);
+    void BlendFunc(GLenum sourceFactor, GLenum destinationFactor);
+    void Viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+
+    /// @brief Apagar um objeto vinculado volta o binding a 0 no GL; estas versões mantêm o espelho coerente.
+    void DeleteTexture(GLuint texture);
+    void DeleteBuffer(GLuint buffer);
+    void DeleteVertexArray(GLuint vertexArray);
+    void DeleteFramebuffer(GLuint framebuffer);
+    void DeleteProgram(GLuint program);
+
+    const RenderStateStats& GetStats() const { return m_stats; }
+    void ResetStats() { m_stats = {}; }
+
+private:
+    static constexpr int kBufferTargetCount = 9;
+    static constexpr int kTextureTargetCount = 4;
+    static constexpr int kCapabilityCount = 6;
+
+    /// Valor espelhado; known=false força a próxima chamada.
+    template <typename T>
+    struct Tracked
+    {
+        T value{};
+        bool known = false;
+    };
+
+    static int BufferTargetSlot(GLenum target);
+    static int TextureTargetSlot(GLenum target);
+    static int CapabilitySlot(GLenum capability);
+    int ResolveActiveUnit();
+
+    /// @brief Atualiza o espelho; retorna true se a chamada precisa ir ao driver.
+    template <typename T>
+    bool Update(Tracked<T>& tracked, const T& value)
+    {
+        if (tracked.known && tracked.value == value)
+        {
+            ++m_stats.skippedCalls;
+            return false;
+        }
+        tracked.value = value;
+        tracked.known = true;
+        ++m_stats.issuedCalls;
+        return true;
+    }
+
+    Tracked<GLuint> m_program;
+    Tracked<GLuint> m_vertexArray;
+    std::array<Tracked<GLuint>, kBufferTargetCount> m_buffers{};
+    std::array<Tracked<GLuint>, kMaxUniformBufferBindings> m_uniformBufferBindings{};
+    Tracked<int> m_activeUnit;
+    std::array<std::array<Tracked<GLuint>, kTextureTargetCount>, kMaxTextureUnits> m_textures{};
+    Tracked<GLuint> m_drawFramebuffer;
+    Tracked<GLuint> m_readFramebuffer;
+    std::array<Tracked<bool>, kCapabilityCount> m_capabilities{};
+    Tracked<GLenum> m_depthFunc;
+    Tracked<GLboolean> m_depthMask;
+    Tracked<std::array<GLboolean, 4>> m_colorMask;
+    Tracked<std::array<GLenum, 2>> m_blendFunc;
+    Tracked<std::array<GLint, 4>> m_viewport;
+    RenderStateStats m_stats{};
+};
@@ -1,30 +1,60 @@
 #include "renderer.h"
 
+#include "content_hash.h"
+#include "frustum.h"
+#include "geometry_pool.h"
 #include "physics_system.h"
 
 #include <algorithm>
 #include <array>
 #include <cmath>
-#include <fstream>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
+#include <numeric>
 #include <sstream>
+#include <utility>
 #include <iomanip>
 
+#include <glm/gtc/matrix_inverse.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
-#include <glm/gtc/matrix_access.hpp>
 
 namespace
 {
-constexpr int kMaxDirectionalLights = 4;
-constexpr int kMaxPointLights = 4;
-constexpr unsigned int kShadowMapWidth = 2048;
-constexpr unsigned int kShadowMapHeight = 2048;
 constexpr unsigned int kPointShadowSize = 1024;
-constexpr float kShadowNearPlane = 1.0f;
-constexpr float kShadowFarPlane = 60.0f;
+constexpr int kMinShadowCascadeResolution = 256;
+constexpr int kMaxShadowCascadeResolution = 8192;
+// Raio das cascatas arredondado para este passo: o tamanho do texel não oscila com a câmera.
+constexpr float kCascadeBoundingRadiusStep = 1.0f / 16.0f;
+// Folga da janela de cada cascata sobre a esfera da fatia; maior folga = menos re-renders do cache, menos resolução.
+constexpr float kCascadeWindowMargin = 0.25f;
 constexpr float kPointShadowNearPlane = 0.1f;
 constexpr float kPointShadowFarPlane = 35.0f;
+constexpr float kCameraNearPlane = 0.1f;
+constexpr float kCameraFarPlane = 100.0f;
+constexpr std::size_t kAutoInstancingMinGroupSize = 2;
+// Modo automático da pré-passe: a cada intervalo a variante não escolhida é medida por alguns frames.
+constexpr int kDepthPrepassProbeInterval = 240;
+constexpr int kDepthPrepassProbeFrames = 6;
+constexpr double kDepthPrepassAverageWeight = 0.25;
+constexpr double kDepthPrepassSwitchMargin = 1.05;
+constexpr GLsizeiptr kInstanceStreamFrameCapacity = 4 * 1024 * 1024;
+// Bits da chave de variante do shader de cena; a contagem de luzes direcionais ocupa os bits 4-6.
+constexpr ShaderVariantKey kVariantInstanced = 1u << 0;
+constexpr ShaderVariantKey kVariantDirectionalShadows = 1u << 1;
+constexpr ShaderVariantKey kVariantPointLights = 1u << 2;
+constexpr ShaderVariantKey kVariantPointShadow = 1u << 3;
+constexpr int kVariantDirectionalCountShift = 4;
+constexpr ShaderVariantKey kVariantDirectionalCountMask = 0x7u;
+// Com kVariantInstanced: matrizes lidas do texture buffer estático pelo índice da instância.
+constexpr ShaderVariantKey kVariantInstanceTransforms = 1u << 7;
+// Valores de uUseInstanceTransform nos shaders de sombra.
+constexpr GLint kInstanceSourceUniform = 0;
+constexpr GLint kInstanceSourceAttribute = 1;
+constexpr GLint kInstanceSourceTransformBuffer = 2;
+// Chave do depth GPU-driven: pré-passe da câmera (0) ou cascata direcional.
+constexpr ShaderVariantKey kGpuDepthCascade = 1u << 0;
 constexpr int kDefaultFramebufferWidth = 1280;
 constexpr int kDefaultFramebufferHeight = 720;
 
@@ -37,99 +67,163 @@ constexpr std::array<float, 24> kFullscreenQuadVertices{
      1.0f, -1.0f, 1.0f, 0.0f,
      1.0f,  1.0f, 1.0f, 1.0f
 };
+
+std::string BuildSceneVariantDefines(ShaderVariantKey key)
+{
+    std::ostringstream defines;
+    defines << "#define INSTANCED " << ((key & kVariantInstanced) != 0 ? 1 : 0) << "\n"
+            << "#define INSTANCE_TRANSFORM_BUFFER " << ((key & kVariantInstanceTransforms) != 0 ? 1 : 0) << "\n"
+            << "#define DIRECTIONAL_LIGHT_COUNT "
+            << ((key >> kVariantDirectionalCountShift) & kVariantDirectionalCountMask) << "\n"
+            << "#define DIRECTIONAL_SHADOWS " << ((key & kVariantDirectionalShadows) != 0 ? 1 : 0) << "\n"
+            << "#define POINT_LIGHTS " << ((key & kVariantPointLights) != 0 ? 1 : 0) << "\n"
+            << "#define POINT_SHADOW " << ((key & kVariantPointShadow) != 0 ? 1 : 0) << "\n";
+    return defines.str();
 }
 
-struct Plane
+std::string BuildPrepassVariantDefines(ShaderVariantKey key)
 {
-    glm::vec3 normal{ 0.0f };
-    float distance = 0.0f;
-};
+    std::string defines = (key & kVariantInstanced) != 0 ? "#define INSTANCED 1\n" : "#define INSTANCED 0\n";
+    defines += (key & kVariantInstanceTransforms) != 0 ? "#define INSTANCE_TRANSFORM_BUFFER 1\n"
+                                                       : "#define INSTANCE_TRANSFORM_BUFFER 0\n";
+    return defines;
+}
 
-struct Frustum
+std::string BuildGpuSceneVariantDefines(ShaderVariantKey key)
 {
-    std::array<Plane, 6> planes{};
+    return BuildSceneVariantDefines(key) + "#define GPU_DRIVEN 1\n";
+}
 
-    bool IsSphereVisible(const glm::vec3& center, float radius) const
-    {
-        for (const auto& plane : planes)
-        {
-            if (glm::dot(plane.normal, center) + plane.distance < -radius)
-            {
-                return false;
-            }
-        }
-        return true;
-    }
-};
+std::string BuildGpuDepthVariantDefines(ShaderVariantKey key)
+{
+    return (key & kGpuDepthCascade) != 0 ? "#define CASCADE_DEPTH 1\n" : "#define CASCADE_DEPTH 0\n";
+}
 
-namespace
+GLuint VariantProgram(const ShaderVariant* variant)
 {
-Plane NormalizePlane(const glm::vec4& plane)
+    return variant != nullptr ? variant->shader.program : 0;
+}
+
+void SetSamplerUnit(GLuint program, const char* name, GLint unit)
 {
-    const glm::vec3 normal = glm::vec3(plane);
-    const float length = glm::length(normal);
-    if (length == 0.0f)
+    const GLint location = glGetUniformLocation(program, name);
+    if (location >= 0)
     {
-        return Plane{};
+        glUniform1i(location, unit);
     }
-    return Plane{ normal / length, plane.w / length };
 }
 
-Frustum ExtractFrustum(const glm::mat4& matrix)
+/// Blocos e unidades de sampler comuns às variantes da passada de cor (CPU e GPU-driven).
+void SetupSceneProgram(GLuint program)
 {
-    Frustum frustum;
-    const glm::vec4 rowX = glm::row(matrix, 0);
-    const glm::vec4 rowY = glm::row(matrix, 1);
-    const glm::vec4 rowZ = glm::row(matrix, 2);
-    const glm::vec4 rowW = glm::row(matrix, 3);
-
-    frustum.planes[0] = NormalizePlane(rowW + rowX);
-    frustum.planes[1] = NormalizePlane(rowW - rowX);
-    frustum.planes[2] = NormalizePlane(rowW + rowY);
-    frustum.planes[3] = NormalizePlane(rowW - rowY);
-    frustum.planes[4] = NormalizePlane(rowW + rowZ);
-    frustum.planes[5] = NormalizePlane(rowW - rowZ);
+    UniformBuffer::BindBlock(program, "FrameData", UniformBlockBinding::Frame);
+    UniformBuffer::BindBlock(program, "LightData", UniformBlockBinding::Lights);
+    UniformBuffer::BindBlock(program, "MaterialData", UniformBlockBinding::Material);
+    SetSamplerUnit(program, "textureSampler", 0);
+    SetSamplerUnit(program, "shadowMap", 1);
+    SetSamplerUnit(program, "pointShadowMap", 2);
+    SetSamplerUnit(program, "pointLightData", LightClusterGrid::kLightDataTextureUnit);
+    SetSamplerUnit(program, "clusterRanges", LightClusterGrid::kRangesTextureUnit);
+    SetSamplerUnit(program, "clusterLightIndices", LightClusterGrid::kIndicesTextureUnit);
+    SetSamplerUnit(program, "instanceTransforms", StaticInstanceBuffer::kTextureUnit);
+}
 
-    return frustum;
+GLuint CreateDepthTextureArray(GLsizei resolution, GLsizei layers)
+{
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    RenderStateCache::Get().BindTexture(GL_TEXTURE_2D_ARRAY, texture);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY,
+                 0,
+                 GL_DEPTH_COMPONENT,
+                 resolution,
+                 resolution,
+                 layers,
+                 0,
+                 GL_DEPTH_COMPONENT,
+                 GL_FLOAT,
+                 nullptr);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+    const float borderColor[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, borderColor);
+    return texture;
 }
 
-GLuint LoadAndCompileShader(const std::string& path, GLenum type)
+GLuint CreateDepthCubemap(unsigned int size)
 {
-    std::ifstream file(path);
-    if (!file.is_open())
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    RenderStateCache::Get().BindTexture(GL_TEXTURE_CUBE_MAP, texture);
+    for (unsigned int i = 0; i < 6; ++i)
     {
-        std::cerr << "Erro ao abrir arquivo shader: " << path << std::endl;
-        return 0;
+        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,
+                     0,
+                     GL_DEPTH_COMPONENT,
+                     size,
+                     size,
+                     0,
+                     GL_DEPTH_COMPONENT,
+                     GL_FLOAT,
+                     nullptr);
     }
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    return texture;
+}
 
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    const std::string source = buffer.str();
-
-    GLuint shader = glCreateShader(type);
-    const char* sourcePtr = source.c_str();
-    glShaderSource(shader, 1, &sourcePtr, nullptr);
-    glCompileShader(shader);
-
-    GLint success = 0;
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-    if (!success)
+/// Framebuffer só de depth; cubemaps e arrays são anexados em camadas (todas as faces/layers).
+GLuint CreateDepthFramebuffer(GLuint depthTexture, bool layered, const char* errorMessage)
+{
+    GLuint framebuffer = 0;
+    glGenFramebuffers(1, &framebuffer);
+    RenderStateCache::Get().BindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    if (layered)
     {
-        char infoLog[512];
-        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
-        std::cerr << "Erro ao compilar shader " << path << ": " << infoLog << std::endl;
-        glDeleteShader(shader);
+        glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthTexture, 0);
+    }
+    else
+    {
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
+    }
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    const bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    RenderStateCache::Get().BindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (!complete)
+    {
+        std::cerr << errorMessage << std::endl;
+        RenderStateCache::Get().DeleteFramebuffer(framebuffer);
         return 0;
     }
+    return framebuffer;
+}
 
-    return shader;
+bool HasGLExtension(const char* name)
+{
+    GLint extensionCount = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+    for (GLint i = 0; i < extensionCount; ++i)
+    {
+        const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+        if (extension != nullptr && std::strcmp(extension, name) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
 }
 
 GLuint CreateSolidColorTexture(const glm::vec4& color)
 {
     GLuint textureID = 0;
     glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
+    RenderStateCache::Get().BindTexture(GL_TEXTURE_2D, textureID);
 
     std::array<unsigned char, 4> pixel{
         static_cast<unsigned char>(glm::clamp(color.r, 0.0f, 1.0f) * 255.0f),
@@ -143,91 +237,10 @@ GLuint CreateSolidColorTexture(const glm::vec4& color)
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glBindTexture(GL_TEXTURE_2D, 0);
     return textureID;
 }
 } // namespace
 
-// === ShaderProgram ===
-bool ShaderProgram::Create(const std::string& vertexPath,
-                           const std::string& fragmentPath,
-                           const std::string& geometryPath)
-{
-    GLuint vertexShader = LoadAndCompileShader(vertexPath, GL_VERTEX_SHADER);
-    if (vertexShader == 0)
-    {
-        return false;
-    }
-
-    GLuint fragmentShader = LoadAndCompileShader(fragmentPath, GL_FRAGMENT_SHADER);
-    if (fragmentShader == 0)
-    {
-        glDeleteShader(vertexShader);
-        return false;
-    }
-
-    GLuint geometryShader = 0;
-    if (!geometryPath.empty())
-    {
-        geometryShader = LoadAndCompileShader(geometryPath, GL_GEOMETRY_SHADER);
-        if (geometryShader == 0)
-        {
-            glDeleteShader(vertexShader);
-            glDeleteShader(fragmentShader);
-            return false;
-        }
-    }
-
-    program = glCreateProgram();
-    glAttachShader(program, vertexShader);
-    glAttachShader(program, fragmentShader);
-    if (geometryShader != 0)
-    {
-        glAttachShader(program, geometryShader);
-    }
-    glLinkProgram(program);
-
-    GLint success = 0;
-    glGetProgramiv(program, GL_LINK_STATUS, &success);
-    if (!success)
-    {
-        char infoLog[512];
-        glGetProgramInfoLog(program, 512, nullptr, infoLog);
-        std::cerr << "Erro ao linkar programa shader: " << infoLog << std::endl;
-        Destroy();
-        glDeleteShader(vertexShader);
-        glDeleteShader(fragmentShader);
-        if (geometryShader != 0)
-        {
-            glDeleteShader(geometryShader);
-        }
-        return false;
-    }
-
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
-    if (geometryShader != 0)
-    {
-        glDeleteShader(geometryShader);
-    }
-
-    return true;
-}
-
-void ShaderProgram::Use() const
-{
-    glUseProgram(program);
-}
-
-void ShaderProgram::Destroy()
-{
-    if (program != 0)
-    {
-        glDeleteProgram(program);
-        program = 0;
-    }
-}
-
 // === Scene ===
 // === Renderer ===
 Renderer::Renderer()
@@ -259,7 +272,9 @@ bool Renderer::Initialize(Scene* scene, PhysicsSystem* physicsSystem)
     m_characterObject = m_scene->GetCharacterObject();
     m_carObject = m_scene->GetCarObject();
 
-    glEnable(GL_DEPTH_TEST);
+    // A partir daqui todos os binds passam pelo cache do renderer (inclusive os de model/material/texture).
+    RenderStateCache::SetCurrent(&m_stateCache);
+    m_stateCache.Enable(GL_DEPTH_TEST);
 
     m_defaultWhiteTexture = CreateSolidColorTexture(glm::vec4(1.0f));
 
@@ -269,6 +284,12 @@ bool Renderer::Initialize(Scene* scene, PhysicsSystem* physicsSystem)
         return false;
     }
 
+    if (!CreateUniformBuffers())
+    {
+        Shutdown();
+        return false;
+    }
+
     if (!CreateFullscreenQuad())
     {
         Shutdown();
@@ -292,8 +313,32 @@ bool Renderer::Initialize(Scene* scene, PhysicsSystem* physicsSystem)
         return false;
     }
 
-    glGenBuffers(1, &m_instanceVBO);
-    m_instanceBufferCapacity = 0;
+    if (!m_instanceStream.Create(kInstanceStreamFrameCapacity))
+    {
+        Shutdown();
+        return false;
+    }
+
+    if (!m_lightClusters.Create())
+    {
+        Shutdown();
+        return false;
+    }
+    // Opcional: sem a pirâmide Hi-Z a cena segue só com frustum e as demais oclusões.
+    m_hiZAvailable = m_hiZOcclusion.Create();
+    if (!m_hiZAvailable)
+    {
+        std::cerr << "Oclusão Hi-Z indisponível; seguindo sem ela." << std::endl;
+        m_occlusionCullingEnabled = false;
+    }
+    if (!m_occlusionQueries.Create())
+    {
+        Shutdown();
+        return false;
+    }
+    // Opcional: sem texture buffer as instâncias continuam enviando matrizes por frame.
+    m_staticInstances.Create();
+    m_gpuDrivenAvailable = SetupGpuDriven();
     m_gpuTimersAvailable = SetupGpuTimers();
 
     ApplyOverrideMode(m_overrideMode);
@@ -306,80 +351,50 @@ void Renderer::Shutdown()
     if (!m_initialized)
     {
         DestroyShaders();
+        DestroyUniformBuffers();
         DestroyFullscreenQuad();
         DestroyFramebuffer(m_sceneFramebuffer);
-        if (m_depthMapFBO != 0)
-        {
-            glDeleteFramebuffers(1, &m_depthMapFBO);
-            m_depthMapFBO = 0;
-        }
-        if (m_depthMap != 0)
-        {
-            glDeleteTextures(1, &m_depthMap);
-            m_depthMap = 0;
-        }
-        if (m_pointDepthMapFBO != 0)
-        {
-            glDeleteFramebuffers(1, &m_pointDepthMapFBO);
-            m_pointDepthMapFBO = 0;
-        }
-        if (m_pointDepthCubemap != 0)
-        {
-            glDeleteTextures(1, &m_pointDepthCubemap);
-            m_pointDepthCubemap = 0;
-        }
+        DestroyShadowResources();
         if (m_defaultWhiteTexture != 0)
         {
-            glDeleteTextures(1, &m_defaultWhiteTexture);
+            m_stateCache.DeleteTexture(m_defaultWhiteTexture);
             m_defaultWhiteTexture = 0;
         }
-        if (m_instanceVBO != 0)
+        m_instanceStream.Destroy();
+        m_lightClusters.Destroy();
+        m_hiZOcclusion.Destroy();
+        m_occlusionQueries.Destroy();
+        m_staticInstances.Destroy();
+        m_gpuScene.Destroy();
+        DestroyGpuTimers();
+        if (&RenderStateCache::Get() == &m_stateCache)
         {
-            glDeleteBuffers(1, &m_instanceVBO);
-            m_instanceVBO = 0;
-            m_instanceBufferCapacity = 0;
+            RenderStateCache::SetCurrent(nullptr);
         }
-        DestroyGpuTimers();
         return;
     }
 
     DestroyShaders();
+    DestroyUniformBuffers();
     DestroyFullscreenQuad();
     DestroyFramebuffer(m_sceneFramebuffer);
-
-    if (m_depthMapFBO != 0)
-    {
-        glDeleteFramebuffers(1, &m_depthMapFBO);
-        m_depthMapFBO = 0;
-    }
-    if (m_depthMap != 0)
-    {
-        glDeleteTextures(1, &m_depthMap);
-        m_depthMap = 0;
-    }
-    if (m_pointDepthMapFBO != 0)
-    {
-        glDeleteFramebuffers(1, &m_pointDepthMapFBO);
-        m_pointDepthMapFBO = 0;
-    }
-    if (m_pointDepthCubemap != 0)
-    {
-        glDeleteTextures(1, &m_pointDepthCubemap);
-        m_pointDepthCubemap = 0;
-    }
+    DestroyShadowResources();
     if (m_defaultWhiteTexture != 0)
     {
-        glDeleteTextures(1, &m_defaultWhiteTexture);
+        m_stateCache.DeleteTexture(m_defaultWhiteTexture);
         m_defaultWhiteTexture = 0;
     }
-    if (m_instanceVBO != 0)
-    {
-        glDeleteBuffers(1, &m_instanceVBO);
-        m_instanceVBO = 0;
-        m_instanceBufferCapacity = 0;
-    }
+    m_instanceStream.Destroy();
+    m_lightClusters.Destroy();
+    m_hiZOcclusion.Destroy();
+    m_occlusionQueries.Destroy();
+    m_staticInstances.Destroy();
+    m_gpuScene.Destroy();
+    m_gpuDrivenAvailable = false;
+    m_gpuDrivenReady = false;
     DestroyPhysicsDebugResources();
     DestroyGpuTimers();
+    RenderStateCache::SetCurrent(nullptr);
 
     m_sceneModels.clear();
     m_characterObject = nullptr;
@@ -397,6 +412,15 @@ void Renderer::RenderFrame(GLFWwindow* window, const Camera& camera, float curre
     }
 
     RecordCpuFrameTime(deltaTime);
+    m_renderQueue.ResetStats();
+    m_stateCache.ResetStats();
+    m_gpuScene.ResetFrameStats();
+    if (m_occlusionCullingEnabled)
+    {
+        m_hiZOcclusion.ResolveReadback();
+    }
+    // Avança mesmo desligado: ao religar, nenhuma query de frames antigos passa por resultado recente.
+    m_occlusionQueries.BeginFrame(m_scene->GetObjects().size(), m_scene->GetRevision());
 
     int viewportWidth = 0;
     int viewportHeight = 0;
@@ -423,17 +447,44 @@ void Renderer::RenderFrame(GLFWwindow* window, const Camera& camera, float curre
         m_carObject = m_scene->GetCarObject();
     }
     UpdateOrbitingPointLight(currentTime);
+    if (m_scene != nullptr && m_scene->GetLightingSetup().shadows != m_shadowSettings)
+    {
+        // Cena recarregada com outra configuração de cascatas: recria os arrays de depth.
+        if (!ApplyShadowSettings(m_scene->GetLightingSetup().shadows))
+        {
+            std::cerr << "Falha ao recriar shadow maps em cascata." << std::endl;
+        }
+    }
     m_lastCameraPos = camera.GetPosition();
+    m_staticCasterSignature = ComputeStaticCasterSignature();
+    m_gpuDrivenReady = m_gpuDrivenEnabled && m_scene != nullptr && m_gpuScene.Prepare(*m_scene);
+    if (m_scene != nullptr)
+    {
+        m_staticInstances.Prepare(*m_scene);
+    }
 
-    glm::mat4 projection = glm::perspective(glm::radians(camera.GetZoom()),
-                                            static_cast<float>(viewportWidth) / static_cast<float>(viewportHeight),
-                                            0.1f,
-                                            100.0f);
+    const float aspectRatio = static_cast<float>(viewportWidth) / static_cast<float>(viewportHeight);
+    glm::mat4 projection = glm::perspective(glm::radians(camera.GetZoom()), aspectRatio, kCameraNearPlane, kCameraFarPlane);
 
-    glm::mat4 lightSpaceMatrix = ComputeDirectionalLightMatrix();
+    FrameUniformBlock frameBlock;
+    frameBlock.view = camera.GetViewMatrix();
+    frameBlock.projection = projection;
+    UpdateShadowCascades(camera, aspectRatio, frameBlock);
+    frameBlock.viewPos = camera.GetPosition();
+    m_frameUniforms.Update(&frameBlock, sizeof(frameBlock));
+
+    m_instanceStream.ResetStats();
+    m_instanceStream.BeginFrame();
+
+    // Só lê a cena: roda enquanto este thread submete as sombras; os resultados valem para a passada de cena.
+    const bool softwareOcclusion = m_softwareOcclusionEnabled && !m_gpuDrivenReady;
+    if (softwareOcclusion)
+    {
+        m_softwareOcclusion.BeginCull(*m_scene, projection * frameBlock.view);
+    }
 
     BeginGpuTimer(m_directionalShadowTimer);
-    RenderDirectionalShadowPass(lightSpaceMatrix);
+    RenderDirectionalShadowPass();
     EndGpuTimer(m_directionalShadowTimer);
     AdvanceGpuTimer(m_directionalShadowTimer);
 
@@ -442,10 +493,27 @@ void Renderer::RenderFrame(GLFWwindow* window, const Camera& camera, float curre
     EndGpuTimer(m_pointShadowTimer);
     AdvanceGpuTimer(m_pointShadowTimer);
 
-    BeginGpuTimer(m_sceneTimer);
-    RenderScenePass(camera, projection, lightSpaceMatrix, viewportWidth, viewportHeight, currentTime);
+    if (softwareOcclusion)
+    {
+        m_softwareOcclusion.WaitForResults();
+    }
+
+    m_depthPrepassActive = ChooseDepthPrepass();
+    BeginGpuTimer(m_sceneTimer, m_depthPrepassActive ? 1 : 0);
+    RenderScenePass(camera, projection, viewportWidth, viewportHeight, currentTime);
     EndGpuTimer(m_sceneTimer);
     AdvanceGpuTimer(m_sceneTimer);
+    RecordScenePassTiming();
+
+    // Oclusores deste frame para os testes do próximo, com a view-projection que gerou a depth.
+    if (m_occlusionCullingEnabled)
+    {
+        m_hiZOcclusion.Build(m_sceneFramebuffer.depthTexture,
+                             m_sceneFramebuffer.width,
+                             m_sceneFramebuffer.height,
+                             projection * camera.GetViewMatrix(),
+                             m_quadVAO);
+    }
 
     BeginGpuTimer(m_postProcessTimer);
     RenderPostProcessPass(viewportWidth, viewportHeight);
@@ -454,6 +522,11 @@ void Renderer::RenderFrame(GLFWwindow* window, const Camera& camera, float curre
 
     RenderPhysicsDebugOverlay(projection * camera.GetViewMatrix());
 
+    m_instanceStream.EndFrame();
+    m_lastStreamStats = m_instanceStream.GetStats();
+    m_lastQueueStats = m_renderQueue.GetStats();
+    m_lastStateStats = m_stateCache.GetStats();
+    m_lastGpuDrivenStats = m_gpuScene.GetStats();
     RefreshGpuTimingSummary();
     UpdateOverlayTitle(window, currentTime);
 }
@@ -475,7 +548,13 @@ bool Renderer::EnsureOffscreenSize(int width, int height)
 
 bool Renderer::CreateShaders()
 {
-    if (!m_sceneShader.Create("assets/shaders/vertex.glsl", "assets/shaders/fragment.glsl"))
+    // Variantes compiladas sob demanda; setup roda com o programa ativo logo após o link.
+    const bool sceneVariantsReady = m_sceneShaderVariants.Initialize(
+        "assets/shaders/vertex.glsl",
+        "assets/shaders/fragment.glsl",
+        BuildSceneVariantDefines,
+        SetupSceneProgram);
+    if (!sceneVariantsReady)
     {
         return false;
     }
@@ -490,6 +569,28 @@ bool Renderer::CreateShaders()
     {
         return false;
     }
+
+    // gl_Layer no vertex shader evita trocar o attachment a cada face; sem a extensão, seis passes.
+    m_pointShadowLayeredFaces = HasGLExtension("GL_ARB_shader_viewport_layer_array") &&
+                                m_pointFaceDepthShader.Create("assets/shaders/depth_face_layer_vertex.glsl",
+                                                              "assets/shaders/depth_fragment.glsl");
+    if (!m_pointShadowLayeredFaces &&
+        !m_pointFaceDepthShader.Create("assets/shaders/depth_face_vertex.glsl", "assets/shaders/depth_fragment.glsl"))
+    {
+        return false;
+    }
+    const bool prepassVariantsReady = m_prepassShaderVariants.Initialize(
+        "assets/shaders/scene_depth_vertex.glsl",
+        "assets/shaders/directional_depth_fragment.glsl",
+        BuildPrepassVariantDefines,
+        [](GLuint program) {
+            UniformBuffer::BindBlock(program, "FrameData", UniformBlockBinding::Frame);
+            SetSamplerUnit(program, "instanceTransforms", StaticInstanceBuffer::kTextureUnit);
+        });
+    if (!prepassVariantsReady)
+    {
+        return false;
+    }
     if (!m_postProcessShader.Create("assets/shaders/postprocess_vertex.glsl",
                                     "assets/shaders/postprocess_fragment.glsl"))
     {
@@ -501,40 +602,26 @@ bool Renderer::CreateShaders()
         return false;
     }
 
-    m_sceneShader.Use();
-    m_modelLoc = glGetUniformLocation(m_sceneShader.program, "model");
-    m_viewLoc = glGetUniformLocation(m_sceneShader.program, "view");
-    m_projectionLoc = glGetUniformLocation(m_sceneShader.program, "projection");
-    m_viewPosLoc = glGetUniformLocation(m_sceneShader.program, "viewPos");
-    m_lightSpaceLoc = glGetUniformLocation(m_sceneShader.program, "lightSpaceMatrix");
-    m_shadowMapLoc = glGetUniformLocation(m_sceneShader.program, "shadowMap");
-    m_pointShadowMapLoc = glGetUniformLocation(m_sceneShader.program, "pointShadowMap");
-    m_pointShadowLightPosLoc = glGetUniformLocation(m_sceneShader.program, "pointShadowLightPos");
-    m_pointShadowFarPlaneLoc = glGetUniformLocation(m_sceneShader.program, "shadowFarPlane");
-    m_shadowPointIndexLoc = glGetUniformLocation(m_sceneShader.program, "shadowPointIndex");
-    m_sceneInstanceFlagLoc = glGetUniformLocation(m_sceneShader.program, "uUseInstanceTransform");
-    const GLint samplerLoc = glGetUniformLocation(m_sceneShader.program, "textureSampler");
-    if (samplerLoc >= 0)
-    {
-        glUniform1i(samplerLoc, 0);
-    }
-    if (m_shadowMapLoc >= 0)
-    {
-        glUniform1i(m_shadowMapLoc, 1);
-    }
-    if (m_pointShadowMapLoc >= 0)
-    {
-        glUniform1i(m_pointShadowMapLoc, 2);
-    }
-    if (m_sceneInstanceFlagLoc >= 0)
+    UniformBuffer::BindBlock(m_directionalDepthShader.program, "FrameData", UniformBlockBinding::Frame);
+    UniformBuffer::BindBlock(m_pointDepthShader.program, "PointShadowData", UniformBlockBinding::PointShadow);
+    UniformBuffer::BindBlock(m_pointFaceDepthShader.program, "PointShadowData", UniformBlockBinding::PointShadow);
+
+    // Aquece a variante genérica (todas as luzes e sombras) nas duas formas: erro de compilação aparece já na
+    // inicialização e o primeiro frame não paga o link.
+    const ShaderVariantKey warmupKey = kVariantDirectionalShadows | kVariantPointLights | kVariantPointShadow |
+                                       (1u << kVariantDirectionalCountShift);
+    if (m_sceneShaderVariants.Get(warmupKey) == nullptr ||
+        m_sceneShaderVariants.Get(warmupKey | kVariantInstanced) == nullptr ||
+        m_prepassShaderVariants.Get(0) == nullptr || m_prepassShaderVariants.Get(kVariantInstanced) == nullptr)
     {
-        glUniform1i(m_sceneInstanceFlagLoc, 0);
+        return false;
     }
 
     m_directionalDepthShader.Use();
     m_dirDepthModelLoc = glGetUniformLocation(m_directionalDepthShader.program, "model");
-    m_dirDepthLightSpaceLoc = glGetUniformLocation(m_directionalDepthShader.program, "lightSpaceMatrix");
     m_dirDepthInstanceFlagLoc = glGetUniformLocation(m_directionalDepthShader.program, "uUseInstanceTransform");
+    m_dirDepthCascadeLoc = glGetUniformLocation(m_directionalDepthShader.program, "uCascadeIndex");
+    SetSamplerUnit(m_directionalDepthShader.program, "instanceTransforms", StaticInstanceBuffer::kTextureUnit);
     if (m_dirDepthInstanceFlagLoc >= 0)
     {
         glUniform1i(m_dirDepthInstanceFlagLoc, 0);
@@ -542,23 +629,23 @@ bool Renderer::CreateShaders()
 
     m_pointDepthShader.Use();
     m_pointDepthModelLoc = glGetUniformLocation(m_pointDepthShader.program, "model");
-    m_pointDepthLightPosLoc = glGetUniformLocation(m_pointDepthShader.program, "lightPos");
-    m_pointDepthFarPlaneLoc = glGetUniformLocation(m_pointDepthShader.program, "far_plane");
     m_pointDepthInstanceFlagLoc = glGetUniformLocation(m_pointDepthShader.program, "uUseInstanceTransform");
-    for (int i = 0; i < 6; ++i)
-    {
-        m_pointDepthShadowMatricesLoc[i] =
-            glGetUniformLocation(m_pointDepthShader.program, ("shadowMatrices[" + std::to_string(i) + "]").c_str());
-    }
-    if (m_pointDepthFarPlaneLoc >= 0)
-    {
-        glUniform1f(m_pointDepthFarPlaneLoc, kPointShadowFarPlane);
-    }
+    SetSamplerUnit(m_pointDepthShader.program, "instanceTransforms", StaticInstanceBuffer::kTextureUnit);
     if (m_pointDepthInstanceFlagLoc >= 0)
     {
         glUniform1i(m_pointDepthInstanceFlagLoc, 0);
     }
 
+    m_pointFaceDepthShader.Use();
+    m_pointFaceModelLoc = glGetUniformLocation(m_pointFaceDepthShader.program, "model");
+    m_pointFaceInstanceFlagLoc = glGetUniformLocation(m_pointFaceDepthShader.program, "uUseInstanceTransform");
+    m_pointFaceIndexLoc = glGetUniformLocation(m_pointFaceDepthShader.program, "uFaceIndex");
+    SetSamplerUnit(m_pointFaceDepthShader.program, "instanceTransforms", StaticInstanceBuffer::kTextureUnit);
+    if (m_pointFaceInstanceFlagLoc >= 0)
+    {
+        glUniform1i(m_pointFaceInstanceFlagLoc, 0);
+    }
+
     m_postProcessShader.Use();
     m_postSceneColorLoc = glGetUniformLocation(m_postProcessShader.program, "sceneColor");
     m_postHighlightsLoc = glGetUniformLocation(m_postProcessShader.program, "sceneHighlights");
@@ -587,11 +674,73 @@ bool Renderer::CreateShaders()
     return true;
 }
 
+bool Renderer::SetupGpuDriven()
+{
+    if (!GpuDrivenScene::IsSupported())
+    {
+        return false;
+    }
+
+    const bool variantsReady =
+        m_gpuSceneShaderVariants.Initialize("assets/shaders/gpu_scene_vertex.glsl",
+                                            "assets/shaders/fragment.glsl",
+                                            BuildGpuSceneVariantDefines,
+                                            SetupSceneProgram) &&
+        m_gpuDepthShaderVariants.Initialize(
+            "assets/shaders/gpu_depth_vertex.glsl",
+            "assets/shaders/directional_depth_fragment.glsl",
+            BuildGpuDepthVariantDefines,
+            [](GLuint program) { UniformBuffer::BindBlock(program, "FrameData", UniformBlockBinding::Frame); });
+    if (!variantsReady)
+    {
+        return false;
+    }
+
+    // Mesmo aquecimento da passada da CPU: erros de GLSL 4.30 aparecem na inicialização, não no toggle.
+    const ShaderVariantKey warmupKey = kVariantDirectionalShadows | kVariantPointLights | kVariantPointShadow |
+                                       (1u << kVariantDirectionalCountShift);
+    const ShaderVariant* cascadeVariant = m_gpuDepthShaderVariants.Get(kGpuDepthCascade);
+    if (m_gpuSceneShaderVariants.Get(warmupKey) == nullptr || m_gpuDepthShaderVariants.Get(0) == nullptr ||
+        cascadeVariant == nullptr)
+    {
+        return false;
+    }
+    m_gpuDepthCascadeLoc = glGetUniformLocation(cascadeVariant->shader.program, "uCascadeIndex");
+    return m_gpuScene.Create();
+}
+
+bool Renderer::CreateUniformBuffers()
+{
+    if (!m_frameUniforms.Create(sizeof(FrameUniformBlock), UniformBlockBinding::Frame) ||
+        !m_lightUniforms.Create(sizeof(LightUniformBlock), UniformBlockBinding::Lights) ||
+        !m_pointShadowUniforms.Create(sizeof(PointShadowUniformBlock), UniformBlockBinding::PointShadow))
+    {
+        return false;
+    }
+
+    // Os pontos de binding indexados são estado global: basta vincular uma vez.
+    m_frameUniforms.Bind();
+    m_lightUniforms.Bind();
+    m_pointShadowUniforms.Bind();
+    return true;
+}
+
+void Renderer::DestroyUniformBuffers()
+{
+    m_frameUniforms.Destroy();
+    m_lightUniforms.Destroy();
+    m_pointShadowUniforms.Destroy();
+}
+
 void Renderer::DestroyShaders()
 {
-    m_sceneShader.Destroy();
+    m_sceneShaderVariants.Destroy();
     m_directionalDepthShader.Destroy();
     m_pointDepthShader.Destroy();
+    m_pointFaceDepthShader.Destroy();
+    m_prepassShaderVariants.Destroy();
+    m_gpuSceneShaderVariants.Destroy();
+    m_gpuDepthShaderVariants.Destroy();
     m_postProcessShader.Destroy();
     m_physicsDebugShader.Destroy();
 }
@@ -600,8 +749,8 @@ bool Renderer::CreateFullscreenQuad()
 {
     glGenVertexArrays(1, &m_quadVAO);
     glGenBuffers(1, &m_quadVBO);
-    glBindVertexArray(m_quadVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, m_quadVBO);
+    m_stateCache.BindVertexArray(m_quadVAO);
+    m_stateCache.BindBuffer(GL_ARRAY_BUFFER, m_quadVBO);
     glBufferData(GL_ARRAY_BUFFER,
                  static_cast<GLsizeiptr>(kFullscreenQuadVertices.size() * sizeof(float)),
                  kFullscreenQuadVertices.data(),
@@ -610,7 +759,7 @@ bool Renderer::CreateFullscreenQuad()
     glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), reinterpret_cast<void*>(0));
     glEnableVertexAttribArray(1);
     glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), reinterpret_cast<void*>(2 * sizeof(float)));
-    glBindVertexArray(0);
+    m_stateCache.BindVertexArray(0);
     return true;
 }
 
@@ -618,12 +767,12 @@ void Renderer::DestroyFullscreenQuad()
 {
     if (m_quadVBO != 0)
     {
-        glDeleteBuffers(1, &m_quadVBO);
+        m_stateCache.DeleteBuffer(m_quadVBO);
         m_quadVBO = 0;
     }
     if (m_quadVAO != 0)
     {
-        glDeleteVertexArrays(1, &m_quadVAO);
+        m_stateCache.DeleteVertexArray(m_quadVAO);
         m_quadVAO = 0;
     }
 }
@@ -739,240 +888,817 @@ void Renderer::SetupLights()
 
 bool Renderer::SetupShadowResources()
 {
-    glGenFramebuffers(1, &m_depthMapFBO);
-    glGenTextures(1, &m_depthMap);
-    glBindTexture(GL_TEXTURE_2D, m_depthMap);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, kShadowMapWidth, kShadowMapHeight, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
-    const float borderColor[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
-    glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
+    if (glCopyImageSubData == nullptr)
+    {
+        glGenFramebuffers(1, &m_shadowCopyReadFBO);
+        glGenFramebuffers(1, &m_shadowCopyDrawFBO);
+    }
 
-    glBindFramebuffer(GL_FRAMEBUFFER, m_depthMapFBO);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_depthMap, 0);
-    glDrawBuffer(GL_NONE);
-    glReadBuffer(GL_NONE);
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    const SceneShadowSettings settings = m_scene != nullptr ? m_scene->GetLightingSetup().shadows : SceneShadowSettings{};
+    if (!ApplyShadowSettings(settings))
     {
-        std::cerr << "Erro ao configurar framebuffer de depth para shadow mapping." << std::endl;
         return false;
     }
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
-    glGenFramebuffers(1, &m_pointDepthMapFBO);
-    glGenTextures(1, &m_pointDepthCubemap);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, m_pointDepthCubemap);
-    for (unsigned int i = 0; i < 6; ++i)
+    m_pointDepthCubemap = CreateDepthCubemap(kPointShadowSize);
+    m_pointDepthMapFBO =
+        CreateDepthFramebuffer(m_pointDepthCubemap, true, "Erro ao configurar framebuffer de depth para point light shadow.");
+    if (m_pointDepthMapFBO == 0)
     {
-        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,
-                     0,
-                     GL_DEPTH_COMPONENT,
-                     kPointShadowSize,
-                     kPointShadowSize,
-                     0,
-                     GL_DEPTH_COMPONENT,
-                     GL_FLOAT,
-                     nullptr);
+        return false;
+    }
+
+    if (!m_pointShadowLayeredFaces)
+    {
+        // Fallback do modo por face: um attachment não-layered trocado a cada uma das seis passadas.
+        glGenFramebuffers(1, &m_pointFaceFBO);
+        m_stateCache.BindFramebuffer(GL_FRAMEBUFFER, m_pointFaceFBO);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_CUBE_MAP_POSITIVE_X, m_pointDepthCubemap, 0);
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        {
+            std::cerr << "Erro ao configurar framebuffer por face da point light shadow." << std::endl;
+            return false;
+        }
+        m_stateCache.BindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    // Cópia só com casters estáticos; sem ela o cache fica desligado e tudo é redesenhado por frame.
+    m_staticPointDepthCubemap = CreateDepthCubemap(kPointShadowSize);
+    m_staticPointDepthMapFBO =
+        CreateDepthFramebuffer(m_staticPointDepthCubemap, true, "Erro ao configurar framebuffer do cache de sombra pontual.");
+    InvalidateShadowCache();
+
+    return true;
+}
+
+bool Renderer::ApplyShadowSettings(const SceneShadowSettings& settings)
+{
+    for (GLuint* framebuffer : { &m_depthMapFBO, &m_staticDepthMapFBO })
+    {
+        if (*framebuffer != 0)
+        {
+            m_stateCache.DeleteFramebuffer(*framebuffer);
+            *framebuffer = 0;
+        }
+    }
+    for (GLuint* texture : { &m_depthMap, &m_staticDepthMap })
+    {
+        if (*texture != 0)
+        {
+            m_stateCache.DeleteTexture(*texture);
+            *texture = 0;
+        }
+    }
+
+    m_shadowSettings = settings;
+    m_cascadeCount = std::clamp(settings.cascadeCount, 1, kMaxShadowCascades);
+    m_cascadeResolution = std::clamp(settings.resolution, kMinShadowCascadeResolution, kMaxShadowCascadeResolution);
+    if (m_cascadeCount != settings.cascadeCount || m_cascadeResolution != settings.resolution)
+    {
+        std::cerr << "Configuração de sombras ajustada para " << m_cascadeCount << " cascata(s) de " << m_cascadeResolution
+                  << "px." << std::endl;
+    }
+
+    m_depthMap = CreateDepthTextureArray(m_cascadeResolution, m_cascadeCount);
+    m_depthMapFBO = CreateDepthFramebuffer(m_depthMap, true, "Erro ao configurar framebuffer de depth para shadow mapping.");
+    if (m_depthMapFBO == 0)
+    {
+        return false;
+    }
+
+    m_staticDepthMap = CreateDepthTextureArray(m_cascadeResolution, m_cascadeCount);
+    m_staticDepthMapFBO =
+        CreateDepthFramebuffer(m_staticDepthMap, true, "Erro ao configurar framebuffer do cache de sombra direcional.");
+    m_cascadeCacheValid.fill(false);
+    // A grade de texels mudou com a resolução: as janelas são reposicionadas no próximo frame.
+    m_cascadeWindowExtents.fill(0.0f);
+    return true;
+}
+
+void Renderer::DestroyShadowResources()
+{
+    const std::array<GLuint*, 7> framebuffers{ &m_depthMapFBO,
+                                               &m_pointDepthMapFBO,
+                                               &m_pointFaceFBO,
+                                               &m_staticDepthMapFBO,
+                                               &m_staticPointDepthMapFBO,
+                                               &m_shadowCopyReadFBO,
+                                               &m_shadowCopyDrawFBO };
+    for (GLuint* framebuffer : framebuffers)
+    {
+        if (*framebuffer != 0)
+        {
+            m_stateCache.DeleteFramebuffer(*framebuffer);
+            *framebuffer = 0;
+        }
+    }
+
+    const std::array<GLuint*, 4> textures{ &m_depthMap, &m_pointDepthCubemap, &m_staticDepthMap, &m_staticPointDepthCubemap };
+    for (GLuint* texture : textures)
+    {
+        if (*texture != 0)
+        {
+            m_stateCache.DeleteTexture(*texture);
+            *texture = 0;
+        }
+    }
+    InvalidateShadowCache();
+}
+
+void Renderer::InvalidateShadowCache()
+{
+    m_cascadeCacheValid.fill(false);
+    m_pointCacheValid = false;
+}
+
+std::uint64_t Renderer::ComputeStaticCasterSignature() const
+{
+    if (m_scene == nullptr)
+    {
+        return 0;
+    }
+
+    // Os batches instanciados só mudam num reload, coberto pela revisão da cena; dos objetos estáticos
+    // entram o modelo já resolvido por LOD (o mesmo que o passe desenha) e a matriz.
+    std::uint64_t hash = kContentHashSeed;
+    const std::uint64_t revision = m_scene->GetRevision();
+    hash = HashBytes(&revision, sizeof(revision), hash);
+    for (const auto& object : m_scene->GetObjects())
+    {
+        if (object.GetModel() == nullptr || m_scene->IsDynamicObject(object))
+        {
+            continue;
+        }
+        const glm::mat4 modelMatrix = object.GetModelMatrix();
+        const float distance = glm::length(object.GetWorldCenter(modelMatrix) - m_lastCameraPos);
+        const Model* resolvedModel = object.ResolveModelForDistance(distance);
+        hash = HashBytes(&resolvedModel, sizeof(resolvedModel), hash);
+        hash = HashBytes(&modelMatrix, sizeof(modelMatrix), hash);
+    }
+    return hash;
+}
+
+void Renderer::CopyShadowDepth(GLuint source,
+                               GLuint destination,
+                               GLenum target,
+                               GLsizei width,
+                               GLsizei height,
+                               GLint firstLayer,
+                               GLsizei layers)
+{
+    if (glCopyImageSubData != nullptr)
+    {
+        glCopyImageSubData(source, target, 0, 0, 0, firstLayer, destination, target, 0, 0, 0, firstLayer, width, height, layers);
+        return;
+    }
+
+    // GL 3.3: blit de depth face a face entre dois FBOs auxiliares.
+    m_stateCache.BindFramebuffer(GL_READ_FRAMEBUFFER, m_shadowCopyReadFBO);
+    m_stateCache.BindFramebuffer(GL_DRAW_FRAMEBUFFER, m_shadowCopyDrawFBO);
+    glReadBuffer(GL_NONE);
+    glDrawBuffer(GL_NONE);
+    for (GLint layer = firstLayer; layer < firstLayer + layers; ++layer)
+    {
+        if (target == GL_TEXTURE_2D_ARRAY)
+        {
+            glFramebufferTextureLayer(GL_READ_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, source, 0, layer);
+            glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, destination, 0, layer);
+        }
+        else
+        {
+            const GLenum attachTarget =
+                target == GL_TEXTURE_CUBE_MAP ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + static_cast<GLenum>(layer) : target;
+            glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, attachTarget, source, 0);
+            glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, attachTarget, destination, 0);
+        }
+        glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    }
+    m_stateCache.BindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    m_stateCache.BindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+}
+
+void Renderer::UpdateOrbitingPointLight(float currentTime)
+{
+    if (PointLight* caster = m_pointLights.GetLightMutable(m_shadowPointIndex))
+    {
+        if (m_shadowLightOrbitEnabled)
+        {
+            const float orbitAngle = currentTime * m_pointLightOrbitSpeed;
+            const float verticalAngle = currentTime * m_pointLightVerticalFrequency;
+            glm::vec3 orbitOffset(
+                std::cos(orbitAngle) * m_pointLightOrbitRadius,
+                m_pointLightVerticalAmplitude * std::sin(verticalAngle),
+                std::sin(orbitAngle) * m_pointLightOrbitRadius);
+            caster->position = m_pointLightOrbitCenter + orbitOffset;
+        }
+        m_shadowLightPos = caster->position;
+    }
+    else
+    {
+        m_shadowLightPos = glm::vec3(0.0f);
+    }
+}
+
+void Renderer::UpdateShadowCascades(const Camera& camera, float aspectRatio, FrameUniformBlock& frameBlock)
+{
+    glm::vec3 lightDirection = glm::normalize(m_primarySun.direction);
+    if (glm::length(lightDirection) < 0.0001f)
+    {
+        lightDirection = glm::normalize(glm::vec3(-0.3f, -1.0f, -0.3f));
+    }
+    const glm::vec3 upVector = glm::abs(lightDirection.y) > 0.95f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+
+    // Divisão "prática": mistura da distribuição logarítmica com a uniforme, controlada por splitLambda.
+    const float nearPlane = kCameraNearPlane;
+    const float farPlane = std::clamp(m_shadowSettings.maxDistance, nearPlane + 1.0f, kCameraFarPlane);
+    const float lambda = std::clamp(m_shadowSettings.splitLambda, 0.0f, 1.0f);
+    const float tanHalfFovY = std::tan(glm::radians(camera.GetZoom()) * 0.5f);
+    const float tanHalfFovX = tanHalfFovY * aspectRatio;
+    const glm::mat4 inverseView = glm::inverse(camera.GetViewMatrix());
+    // Base da luz fixa na origem do mundo: com o sol parado, as janelas das cascatas só dependem do próprio centro.
+    const glm::mat4 lightView = glm::lookAt(glm::vec3(0.0f), lightDirection, upVector);
+    const bool lightChanged = lightDirection != m_cascadeLightDirection;
+    m_cascadeLightDirection = lightDirection;
+
+    float sliceNear = nearPlane;
+    for (int cascade = 0; cascade < m_cascadeCount; ++cascade)
+    {
+        const float fraction = static_cast<float>(cascade + 1) / static_cast<float>(m_cascadeCount);
+        const float logSplit = nearPlane * std::pow(farPlane / nearPlane, fraction);
+        const float uniformSplit = nearPlane + (farPlane - nearPlane) * fraction;
+        const float sliceFar = lambda * logSplit + (1.0f - lambda) * uniformSplit;
+
+        std::array<glm::vec3, 8> corners{};
+        glm::vec3 center(0.0f);
+        for (int i = 0; i < 8; ++i)
+        {
+            const float depth = (i < 4) ? sliceNear : sliceFar;
+            const float x = ((i & 1) != 0 ? 1.0f : -1.0f) * tanHalfFovX * depth;
+            const float y = ((i & 2) != 0 ? 1.0f : -1.0f) * tanHalfFovY * depth;
+            corners[i] = glm::vec3(inverseView * glm::vec4(x, y, -depth, 1.0f));
+            center += corners[i];
+        }
+        center /= 8.0f;
+
+        // Esfera envolvente: o tamanho do volume não muda quando a câmera gira, evitando shimmering.
+        float radius = 0.0f;
+        for (const glm::vec3& corner : corners)
+        {
+            radius = std::max(radius, glm::length(corner - center));
+        }
+        radius = std::ceil(radius / kCascadeBoundingRadiusStep) * kCascadeBoundingRadiusStep;
+
+        // Janela da cascata no espaço da luz, um pouco maior que a esfera da fatia. Ela só se move, em passos
+        // de texel, quando a esfera sai dela: até lá a matriz não muda e a camada estática do cache segue válida.
+        const float extent = radius * (1.0f + kCascadeWindowMargin);
+        const glm::vec3 sphereCenter = glm::vec3(lightView * glm::vec4(center, 1.0f));
+        glm::vec3& windowCenter = m_cascadeWindowCenters[cascade];
+        const glm::vec3 drift = glm::abs(sphereCenter - windowCenter);
+        if (lightChanged || m_cascadeWindowExtents[cascade] != extent ||
+            std::max({ drift.x, drift.y, drift.z }) + radius > extent)
+        {
+            const float texelSize = 2.0f * extent / static_cast<float>(m_cascadeResolution);
+            windowCenter = glm::round(sphereCenter / texelSize) * texelSize;
+            m_cascadeWindowExtents[cascade] = extent;
+        }
+        const glm::mat4 lightProjection = glm::ortho(windowCenter.x - extent,
+                                                     windowCenter.x + extent,
+                                                     windowCenter.y - extent,
+                                                     windowCenter.y + extent,
+                                                     -windowCenter.z - extent,
+                                                     -windowCenter.z + extent);
+
+        m_cascadeMatrices[cascade] = lightProjection * lightView;
+        frameBlock.cascadeMatrices[cascade] = m_cascadeMatrices[cascade];
+        frameBlock.cascadeSplits[cascade] = sliceFar;
+        frameBlock.cascadeDepthScales[cascade] = 1.0f / (2.0f * extent);
+        sliceNear = sliceFar;
+    }
+    frameBlock.cascadeCount = m_cascadeCount;
+}
+
+void Renderer::RenderDirectionalShadowPass()
+{
+    m_stateCache.Viewport(0, 0, m_cascadeResolution, m_cascadeResolution);
+    m_directionalCullStats = {};
+    const bool cacheAvailable = m_shadowCacheEnabled && m_staticDepthMapFBO != 0;
+
+    for (int cascade = 0; cascade < m_cascadeCount; ++cascade)
+    {
+        // Volume ortográfico da cascata sem o near plane: casters entre a luz e o volume ainda projetam sombra.
+        const glm::mat4& cascadeMatrix = m_cascadeMatrices[cascade];
+        const Frustum casterVolume = ExtractFrustum(cascadeMatrix, false);
+
+        // A janela da cascata só anda quando a câmera sai dela (ou o sol se move): nesse frame a cascata é
+        // desenhada inteira e o cache volta a ser usado no seguinte.
+        const bool cascadeMoved = cascadeMatrix != m_cachedCascadeMatrices[cascade];
+        m_cachedCascadeMatrices[cascade] = cascadeMatrix;
+        if (!cacheAvailable || cascadeMoved)
+        {
+            m_cascadeCacheValid[cascade] = false;
+            RenderDirectionalShadowCasters(m_depthMapFBO, m_depthMap, cascade, casterVolume, CasterFilter::All, true);
+            continue;
+        }
+
+        if (!m_cascadeCacheValid[cascade] || m_cascadeCacheSignatures[cascade] != m_staticCasterSignature)
+        {
+            RenderDirectionalShadowCasters(m_staticDepthMapFBO,
+                                           m_staticDepthMap,
+                                           cascade,
+                                           casterVolume,
+                                           CasterFilter::StaticOnly,
+                                           true);
+            m_cascadeCacheValid[cascade] = true;
+            m_cascadeCacheSignatures[cascade] = m_staticCasterSignature;
+            ++m_directionalCacheRebuilds;
+        }
+
+        CopyShadowDepth(m_staticDepthMap,
+                        m_depthMap,
+                        GL_TEXTURE_2D_ARRAY,
+                        m_cascadeResolution,
+                        m_cascadeResolution,
+                        cascade,
+                        1);
+        RenderDirectionalShadowCasters(m_depthMapFBO, m_depthMap, cascade, casterVolume, CasterFilter::DynamicOnly, false);
+    }
+    m_stateCache.BindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void Renderer::RenderDirectionalShadowCasters(GLuint framebuffer,
+                                              GLuint depthArray,
+                                              int cascade,
+                                              const Frustum& casterVolume,
+                                              CasterFilter filter,
+                                              bool clear)
+{
+    m_stateCache.BindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthArray, 0, cascade);
+    if (clear)
+    {
+        glClear(GL_DEPTH_BUFFER_BIT);
+    }
+
+    const ShaderVariant* gpuDepthVariant =
+        m_gpuDrivenReady ? m_gpuDepthShaderVariants.Get(kGpuDepthCascade) : nullptr;
+    if (gpuDepthVariant != nullptr)
+    {
+        // Culling por cascata na GPU e um único multi-draw com todos os casters do filtro.
+        m_gpuScene.Cull(GpuDrivenScene::kFirstCascadeView + cascade,
+                        casterVolume,
+                        m_lastCameraPos,
+                        filter != CasterFilter::DynamicOnly,
+                        filter != CasterFilter::StaticOnly);
+        gpuDepthVariant->shader.Use();
+        glUniform1i(m_gpuDepthCascadeLoc, cascade);
+        m_stateCache.Enable(GL_DEPTH_CLAMP);
+        m_gpuScene.DrawDepth(GpuDrivenScene::kFirstCascadeView + cascade);
+        m_stateCache.Disable(GL_DEPTH_CLAMP);
+        return;
     }
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
 
-    glBindFramebuffer(GL_FRAMEBUFFER, m_pointDepthMapFBO);
-    glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, m_pointDepthCubemap, 0);
-    glDrawBuffer(GL_NONE);
-    glReadBuffer(GL_NONE);
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    m_directionalDepthShader.Use();
+    if (m_dirDepthInstanceFlagLoc >= 0)
     {
-        std::cerr << "Erro ao configurar framebuffer de depth para point light shadow." << std::endl;
-        return false;
+        glUniform1i(m_dirDepthInstanceFlagLoc, 0);
+    }
+    if (m_dirDepthCascadeLoc >= 0)
+    {
+        glUniform1i(m_dirDepthCascadeLoc, cascade);
     }
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
-    return true;
-}
+    SceneDrawParams params;
+    params.modelLocation = m_dirDepthModelLoc;
+    params.program = m_directionalDepthShader.program;
+    params.instancingUniformLoc = m_dirDepthInstanceFlagLoc;
+    params.frustum = &casterVolume;
+    params.cameraPos = &m_lastCameraPos;
+    params.cullingStats = &m_directionalCullStats;
+    params.casterFilter = filter;
+    params.depthOnly = true;
 
+    // O depth clamp achata casters à frente do near plane em z = 0 em vez de recortá-los.
+    m_stateCache.Enable(GL_DEPTH_CLAMP);
+    DrawSceneObjects(params);
+    DrawInstancedBatches(params);
+    m_stateCache.Disable(GL_DEPTH_CLAMP);
+}
 
-void Renderer::UpdateOrbitingPointLight(float currentTime)
+void Renderer::RenderPointShadowPass(const glm::vec3& lightPos)
 {
-    if (PointLight* caster = m_pointLights.GetLightMutable(m_shadowPointIndex))
-    {
-        if (m_shadowLightOrbitEnabled)
-        {
-            const float orbitAngle = currentTime * m_pointLightOrbitSpeed;
-            const float verticalAngle = currentTime * m_pointLightVerticalFrequency;
-            glm::vec3 orbitOffset(
-                std::cos(orbitAngle) * m_pointLightOrbitRadius,
-                m_pointLightVerticalAmplitude * std::sin(verticalAngle),
-                std::sin(orbitAngle) * m_pointLightOrbitRadius);
-            caster->position = m_pointLightOrbitCenter + orbitOffset;
-        }
-        m_shadowLightPos = caster->position;
+    const glm::mat4 shadowProj = glm::perspective(glm::radians(90.0f), 1.0f, kPointShadowNearPlane, kPointShadowFarPlane);
+    PointShadowUniformBlock shadowBlock;
+    shadowBlock.shadowMatrices[0] = shadowProj * glm::lookAt(lightPos, lightPos + glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f));
+    shadowBlock.shadowMatrices[1] = shadowProj * glm::lookAt(lightPos, lightPos + glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f));
+    shadowBlock.shadowMatrices[2] = shadowProj * glm::lookAt(lightPos, lightPos + glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+    shadowBlock.shadowMatrices[3] = shadowProj * glm::lookAt(lightPos, lightPos + glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f));
+    shadowBlock.shadowMatrices[4] = shadowProj * glm::lookAt(lightPos, lightPos + glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, -1.0f, 0.0f));
+    shadowBlock.shadowMatrices[5] = shadowProj * glm::lookAt(lightPos, lightPos + glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, -1.0f, 0.0f));
+    shadowBlock.lightPos = lightPos;
+    shadowBlock.farPlane = kPointShadowFarPlane;
+    m_pointShadowUniforms.Update(&shadowBlock, sizeof(shadowBlock));
+
+    m_stateCache.Viewport(0, 0, kPointShadowSize, kPointShadowSize);
+    m_pointCullStats = {};
+
+    const bool lightMoved = lightPos != m_cachedPointLightPos;
+    m_cachedPointLightPos = lightPos;
+    if (!m_shadowCacheEnabled || m_staticPointDepthMapFBO == 0 || lightMoved)
+    {
+        m_pointCacheValid = false;
+        RenderPointShadowCasters(m_pointDepthMapFBO, m_pointDepthCubemap, shadowBlock, CasterFilter::All, true);
+        m_stateCache.BindFramebuffer(GL_FRAMEBUFFER, 0);
+        return;
     }
-    else
+
+    if (!m_pointCacheValid || m_pointCacheSignature != m_staticCasterSignature)
     {
-        m_shadowLightPos = glm::vec3(0.0f);
+        RenderPointShadowCasters(m_staticPointDepthMapFBO,
+                                 m_staticPointDepthCubemap,
+                                 shadowBlock,
+                                 CasterFilter::StaticOnly,
+                                 true);
+        m_pointCacheValid = true;
+        m_pointCacheSignature = m_staticCasterSignature;
+        ++m_pointCacheRebuilds;
     }
+
+    CopyShadowDepth(m_staticPointDepthCubemap, m_pointDepthCubemap, GL_TEXTURE_CUBE_MAP, kPointShadowSize, kPointShadowSize, 0, 6);
+    RenderPointShadowCasters(m_pointDepthMapFBO, m_pointDepthCubemap, shadowBlock, CasterFilter::DynamicOnly, false);
+    m_stateCache.BindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
-glm::mat4 Renderer::ComputeDirectionalLightMatrix() const
+void Renderer::RenderPointShadowCasters(GLuint layeredFramebuffer,
+                                        GLuint cubemap,
+                                        const PointShadowUniformBlock& shadowBlock,
+                                        CasterFilter filter,
+                                        bool clear)
 {
-    glm::vec3 lightDirection = glm::normalize(m_primarySun.direction);
-    if (glm::length(lightDirection) < 0.0001f)
+    if (m_pointShadowMode == PointShadowMode::PerFaceCulled && m_pointFaceDepthShader.program != 0)
     {
-        lightDirection = glm::normalize(glm::vec3(-0.3f, -1.0f, -0.3f));
+        RenderPointShadowFaces(layeredFramebuffer, cubemap, shadowBlock, filter, clear);
+        return;
     }
-    const glm::vec3 sceneCenter(0.0f, 0.0f, 0.0f);
-    const float lightDistance = 25.0f;
-    glm::vec3 lightPos = sceneCenter - lightDirection * lightDistance;
-    glm::vec3 upVector = glm::abs(lightDirection.y) > 0.95f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
-    glm::mat4 lightProjection = glm::ortho(-20.0f, 20.0f, -20.0f, 20.0f, kShadowNearPlane, kShadowFarPlane);
-    glm::mat4 lightView = glm::lookAt(lightPos, sceneCenter, upVector);
-    return lightProjection * lightView;
-}
 
-void Renderer::RenderDirectionalShadowPass(const glm::mat4& lightSpaceMatrix)
-{
-    glViewport(0, 0, kShadowMapWidth, kShadowMapHeight);
-    glBindFramebuffer(GL_FRAMEBUFFER, m_depthMapFBO);
-    glClear(GL_DEPTH_BUFFER_BIT);
-    m_directionalDepthShader.Use();
-    if (m_dirDepthLightSpaceLoc >= 0)
+    m_stateCache.BindFramebuffer(GL_FRAMEBUFFER, layeredFramebuffer);
+    if (clear)
     {
-        glUniformMatrix4fv(m_dirDepthLightSpaceLoc, 1, GL_FALSE, glm::value_ptr(lightSpaceMatrix));
+        glClear(GL_DEPTH_BUFFER_BIT);
     }
-    if (m_dirDepthInstanceFlagLoc >= 0)
+    m_pointDepthShader.Use();
+    if (m_pointDepthInstanceFlagLoc >= 0)
     {
-        glUniform1i(m_dirDepthInstanceFlagLoc, 0);
+        glUniform1i(m_pointDepthInstanceFlagLoc, 0);
     }
-    DrawSceneObjects(m_dirDepthModelLoc, m_directionalDepthShader.program, 0, nullptr, &m_lastCameraPos);
-    DrawInstancedBatches(m_dirDepthModelLoc, m_directionalDepthShader.program, 0, m_dirDepthInstanceFlagLoc, nullptr);
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    // Fora da esfera do far plane nada é gravado em nenhuma face do cubemap.
+    const Frustum casterVolume = MakeSphereVolume(shadowBlock.lightPos, kPointShadowFarPlane);
+    SceneDrawParams params;
+    params.modelLocation = m_pointDepthModelLoc;
+    params.program = m_pointDepthShader.program;
+    params.instancingUniformLoc = m_pointDepthInstanceFlagLoc;
+    params.frustum = &casterVolume;
+    params.cameraPos = &m_lastCameraPos;
+    params.cullingStats = &m_pointCullStats;
+    params.casterFilter = filter;
+    params.depthOnly = true;
+    DrawSceneObjects(params);
+    DrawInstancedBatches(params);
 }
 
-void Renderer::RenderPointShadowPass(const glm::vec3& lightPos)
+void Renderer::RenderPointShadowFaces(GLuint layeredFramebuffer,
+                                      GLuint cubemap,
+                                      const PointShadowUniformBlock& shadowBlock,
+                                      CasterFilter filter,
+                                      bool clear)
 {
-    const glm::mat4 shadowProj = glm::perspective(glm::radians(90.0f), 1.0f, kPointShadowNearPlane, kPointShadowFarPlane);
-    std::array<glm::mat4, 6> shadowTransforms{
-        shadowProj * glm::lookAt(lightPos, lightPos + glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f)),
-        shadowProj * glm::lookAt(lightPos, lightPos + glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f)),
-        shadowProj * glm::lookAt(lightPos, lightPos + glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f)),
-        shadowProj * glm::lookAt(lightPos, lightPos + glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f)),
-        shadowProj * glm::lookAt(lightPos, lightPos + glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, -1.0f, 0.0f)),
-        shadowProj * glm::lookAt(lightPos, lightPos + glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, -1.0f, 0.0f))
-    };
-
-    glViewport(0, 0, kPointShadowSize, kPointShadowSize);
-    glBindFramebuffer(GL_FRAMEBUFFER, m_pointDepthMapFBO);
-    glClear(GL_DEPTH_BUFFER_BIT);
-    m_pointDepthShader.Use();
-    if (m_pointDepthLightPosLoc >= 0)
+    if (m_pointShadowLayeredFaces)
+    {
+        m_stateCache.BindFramebuffer(GL_FRAMEBUFFER, layeredFramebuffer);
+        if (clear)
+        {
+            glClear(GL_DEPTH_BUFFER_BIT);
+        }
+    }
+    else
     {
-        glUniform3fv(m_pointDepthLightPosLoc, 1, glm::value_ptr(lightPos));
+        m_stateCache.BindFramebuffer(GL_FRAMEBUFFER, m_pointFaceFBO);
     }
-    if (m_pointDepthFarPlaneLoc >= 0)
+
+    m_pointFaceDepthShader.Use();
+    if (m_pointFaceInstanceFlagLoc >= 0)
     {
-        glUniform1f(m_pointDepthFarPlaneLoc, kPointShadowFarPlane);
+        glUniform1i(m_pointFaceInstanceFlagLoc, 0);
     }
-    for (int i = 0; i < 6; ++i)
+
+    SceneDrawParams params;
+    params.modelLocation = m_pointFaceModelLoc;
+    params.program = m_pointFaceDepthShader.program;
+    params.instancingUniformLoc = m_pointFaceInstanceFlagLoc;
+    params.cameraPos = &m_lastCameraPos;
+    params.cullingStats = &m_pointCullStats;
+    params.casterFilter = filter;
+    params.depthOnly = true;
+
+    for (int face = 0; face < 6; ++face)
     {
-        if (m_pointDepthShadowMatricesLoc[i] >= 0)
+        // Frustum de 90° da face limitado pela esfera do far plane (os cantos além dela não contam).
+        Frustum faceVolume = ExtractFrustum(shadowBlock.shadowMatrices[face]);
+        faceVolume.hasBoundingSphere = true;
+        faceVolume.sphereCenter = shadowBlock.lightPos;
+        faceVolume.sphereRadius = kPointShadowFarPlane;
+
+        if (!m_pointShadowLayeredFaces)
+        {
+            glFramebufferTexture2D(GL_FRAMEBUFFER,
+                                   GL_DEPTH_ATTACHMENT,
+                                   GL_TEXTURE_CUBE_MAP_POSITIVE_X + face,
+                                   cubemap,
+                                   0);
+            if (clear)
+            {
+                glClear(GL_DEPTH_BUFFER_BIT);
+            }
+        }
+        if (m_pointFaceIndexLoc >= 0)
         {
-            glUniformMatrix4fv(m_pointDepthShadowMatricesLoc[i], 1, GL_FALSE, glm::value_ptr(shadowTransforms[i]));
+            glUniform1i(m_pointFaceIndexLoc, face);
         }
+
+        params.frustum = &faceVolume;
+        DrawSceneObjects(params);
+        DrawInstancedBatches(params);
     }
-    if (m_pointDepthInstanceFlagLoc >= 0)
+}
+
+const char* Renderer::GetPointShadowModeLabel() const
+{
+    if (m_pointShadowMode == PointShadowMode::GeometryShader)
     {
-        glUniform1i(m_pointDepthInstanceFlagLoc, 0);
+        return "GS 6 faces";
     }
-    DrawSceneObjects(m_pointDepthModelLoc, m_pointDepthShader.program, 0, nullptr, &m_lastCameraPos);
-    DrawInstancedBatches(m_pointDepthModelLoc, m_pointDepthShader.program, 0, m_pointDepthInstanceFlagLoc, nullptr);
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    return m_pointShadowLayeredFaces ? "faces culled (gl_Layer no VS)" : "faces culled (6 passes)";
 }
 
 void Renderer::RenderScenePass(const Camera& camera,
                                const glm::mat4& projection,
-                               const glm::mat4& lightSpaceMatrix,
                                int viewportWidth,
                                int viewportHeight,
                                float currentTime)
 {
-    glViewport(0, 0, m_sceneFramebuffer.width, m_sceneFramebuffer.height);
-    glBindFramebuffer(GL_FRAMEBUFFER, m_sceneFramebuffer.fbo);
+    m_stateCache.Viewport(0, 0, m_sceneFramebuffer.width, m_sceneFramebuffer.height);
+    m_stateCache.BindFramebuffer(GL_FRAMEBUFFER, m_sceneFramebuffer.fbo);
     glClearColor(0.02f, 0.02f, 0.025f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    m_sceneShader.Use();
     glm::mat4 view = camera.GetViewMatrix();
-    if (m_viewLoc >= 0)
+    glm::vec3 cameraPos = camera.GetPosition();
+    const Frustum frustum = ExtractFrustum(projection * view);
+    const SoftwareOcclusionCuller* softwareOcclusion =
+        m_softwareOcclusionEnabled && m_softwareOcclusion.HasResults() ? &m_softwareOcclusion : nullptr;
+
+    // GPU-driven: um único culling da câmera alimenta o pré-passe e a passada de cor.
+    const bool gpuDriven = m_gpuDrivenReady;
+    OcclusionQuerySet* occlusionQueries = m_occlusionQueriesEnabled && !gpuDriven ? &m_occlusionQueries : nullptr;
+    if (gpuDriven)
+    {
+        m_gpuScene.Cull(GpuDrivenScene::kCameraView, frustum, cameraPos, true, true);
+    }
+
+    const ShaderVariant* prepassVariant = gpuDriven ? m_gpuDepthShaderVariants.Get(0) : m_prepassShaderVariants.Get(0);
+    const ShaderVariant* prepassInstancedVariant =
+        gpuDriven ? prepassVariant : m_prepassShaderVariants.Get(kVariantInstanced);
+    const bool useDepthPrepass = m_depthPrepassActive && prepassVariant != nullptr && prepassInstancedVariant != nullptr;
+    if (useDepthPrepass && gpuDriven)
+    {
+        prepassVariant->shader.Use();
+        m_stateCache.ColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        m_gpuScene.DrawDepth(GpuDrivenScene::kCameraView);
+        m_stateCache.ColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+        m_stateCache.DepthFunc(GL_EQUAL);
+        m_stateCache.DepthMask(GL_FALSE);
+    }
+    else if (useDepthPrepass)
+    {
+        // Só depth, sobre o mesmo conjunto visível: a passada de cor sombreia um fragmento por pixel.
+        prepassVariant->shader.Use();
+        m_stateCache.ColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        SceneDrawParams prepassParams;
+        prepassParams.modelLocation = prepassVariant->modelLocation;
+        prepassParams.program = prepassVariant->shader.program;
+        prepassParams.instancedProgram = prepassInstancedVariant->shader.program;
+        if (m_staticInstances.IsReady())
+        {
+            prepassParams.transformIndexProgram =
+                VariantProgram(m_prepassShaderVariants.Get(kVariantInstanced | kVariantInstanceTransforms));
+        }
+        prepassParams.frustum = &frustum;
+        prepassParams.occlusion = m_occlusionCullingEnabled ? &m_hiZOcclusion : nullptr;
+        prepassParams.softwareOcclusion = softwareOcclusion;
+        prepassParams.occlusionQueries = occlusionQueries;
+        prepassParams.cameraPos = &cameraPos;
+        prepassParams.depthOnly = true;
+        DrawSceneObjects(prepassParams);
+        DrawInstancedBatches(prepassParams);
+        m_stateCache.ColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+        m_stateCache.DepthFunc(GL_EQUAL);
+        m_stateCache.DepthMask(GL_FALSE);
+    }
+
+    m_stateCache.BindTextureUnit(GL_TEXTURE1, GL_TEXTURE_2D_ARRAY, m_depthMap);
+    m_stateCache.BindTextureUnit(GL_TEXTURE2, GL_TEXTURE_CUBE_MAP, m_pointDepthCubemap);
+
+    // Point lights atribuídas aos clusters do frustum da câmera; o shader só percorre a lista do seu cluster.
+    const std::vector<PointLight>& pointLights = m_pointLights.GetLights();
+    m_lightClusters.Build(view,
+                          glm::radians(camera.GetZoom()),
+                          static_cast<float>(m_sceneFramebuffer.width) / static_cast<float>(m_sceneFramebuffer.height),
+                          kCameraNearPlane,
+                          kCameraFarPlane,
+                          pointLights);
+    m_lightClusters.Upload(pointLights);
+    m_lightClusters.Bind();
+
+    // Matrizes da câmera já estão no FrameData; aqui só as luzes, reenviadas apenas se mudarem.
+    LightUniformBlock lightBlock;
+    m_directionalLights.WriteUniforms(lightBlock, currentTime);
+    m_lightClusters.WriteUniforms(lightBlock, m_sceneFramebuffer.width, m_sceneFramebuffer.height);
+    lightBlock.pointShadowLightPos = m_shadowLightPos;
+    lightBlock.shadowFarPlane = kPointShadowFarPlane;
+    lightBlock.shadowPointIndex = m_shadowPointIndex;
+    m_lightUniforms.Update(&lightBlock, sizeof(lightBlock));
+
+    // Uma variante por forma de draw (simples/instanciado); a fila agrupa os itens por programa.
+    const ShaderVariantKey sceneKey = BuildSceneVariantKey(lightBlock);
+    const ShaderVariant* sceneVariant =
+        gpuDriven ? m_gpuSceneShaderVariants.Get(sceneKey) : m_sceneShaderVariants.Get(sceneKey);
+    const ShaderVariant* sceneInstancedVariant =
+        gpuDriven ? sceneVariant : m_sceneShaderVariants.Get(sceneKey | kVariantInstanced);
+    if (sceneVariant == nullptr || sceneInstancedVariant == nullptr)
+    {
+        if (useDepthPrepass)
+        {
+            m_stateCache.DepthFunc(GL_LESS);
+            m_stateCache.DepthMask(GL_TRUE);
+        }
+        m_stateCache.BindFramebuffer(GL_FRAMEBUFFER, 0);
+        return;
+    }
+
+    sceneVariant->shader.Use();
+    m_sceneCullStats = {};
+    if (gpuDriven)
+    {
+        m_gpuScene.DrawShaded(GpuDrivenScene::kCameraView, m_defaultWhiteTexture);
+        if (useDepthPrepass)
+        {
+            m_stateCache.DepthFunc(GL_LESS);
+            m_stateCache.DepthMask(GL_TRUE);
+        }
+        m_stateCache.BindFramebuffer(GL_FRAMEBUFFER, 0);
+        return;
+    }
+
+    SceneDrawParams params;
+    params.modelLocation = sceneVariant->modelLocation;
+    params.normalMatrixLocation = sceneVariant->normalMatrixLocation;
+    params.program = sceneVariant->shader.program;
+    params.instancedProgram = sceneInstancedVariant->shader.program;
+    if (m_staticInstances.IsReady())
+    {
+        params.transformIndexProgram =
+            VariantProgram(m_sceneShaderVariants.Get(sceneKey | kVariantInstanced | kVariantInstanceTransforms));
+    }
+    params.fallbackTexture = m_defaultWhiteTexture;
+    params.frustum = &frustum;
+    params.occlusion = m_occlusionCullingEnabled ? &m_hiZOcclusion : nullptr;
+    params.softwareOcclusion = softwareOcclusion;
+    params.occlusionQueries = occlusionQueries;
+    params.cameraPos = &cameraPos;
+    params.cullingStats = &m_sceneCullStats;
+    DrawSceneObjects(params);
+    DrawInstancedBatches(params);
+
+    // Caixas testadas contra a depth completa do frame; os resultados condicionam os draws do próximo.
+    const ShaderVariant* queryVariant = m_prepassShaderVariants.Get(0);
+    if (occlusionQueries != nullptr && queryVariant != nullptr)
+    {
+        occlusionQueries->IssuePending(queryVariant->shader.program, queryVariant->modelLocation);
+    }
+    if (useDepthPrepass)
+    {
+        m_stateCache.DepthFunc(GL_LESS);
+        m_stateCache.DepthMask(GL_TRUE);
+    }
+    m_stateCache.BindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+ShaderVariantKey Renderer::BuildSceneVariantKey(const LightUniformBlock& lightBlock) const
+{
+    const int directionalCount = std::clamp(lightBlock.directionalCount, 0, kMaxDirectionalLights);
+    ShaderVariantKey key = static_cast<ShaderVariantKey>(directionalCount) << kVariantDirectionalCountShift;
+    // Só a primeira luz direcional projeta sombra (cascatas do sol).
+    if (directionalCount > 0 && m_depthMap != 0)
     {
-        glUniformMatrix4fv(m_viewLoc, 1, GL_FALSE, glm::value_ptr(view));
+        key |= kVariantDirectionalShadows;
     }
-    if (m_projectionLoc >= 0)
+    if (lightBlock.pointCount > 0)
     {
-        glUniformMatrix4fv(m_projectionLoc, 1, GL_FALSE, glm::value_ptr(projection));
+        key |= kVariantPointLights;
+        if (lightBlock.shadowPointIndex >= 0)
+        {
+            key |= kVariantPointShadow;
+        }
     }
-    if (m_viewPosLoc >= 0)
+    return key;
+}
+
+bool Renderer::ChooseDepthPrepass()
+{
+    if (m_depthPrepassMode != DepthPrepassMode::Auto)
     {
-        glUniform3fv(m_viewPosLoc, 1, glm::value_ptr(camera.GetPosition()));
+        return m_depthPrepassMode == DepthPrepassMode::AlwaysOn;
     }
-    if (m_lightSpaceLoc >= 0)
+    // Sem timer de GPU não há como medir o ganho: mantém o caminho sem pré-passe.
+    if (!m_gpuTimersAvailable)
     {
-        glUniformMatrix4fv(m_lightSpaceLoc, 1, GL_FALSE, glm::value_ptr(lightSpaceMatrix));
+        return false;
     }
 
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, m_depthMap);
-    glActiveTexture(GL_TEXTURE2);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, m_pointDepthCubemap);
-    if (m_pointShadowLightPosLoc >= 0)
+    if (m_depthPrepassProbeFramesLeft > 0)
     {
-        glUniform3fv(m_pointShadowLightPosLoc, 1, glm::value_ptr(m_shadowLightPos));
+        --m_depthPrepassProbeFramesLeft;
+        return !m_depthPrepassPreferred;
     }
-    if (m_pointShadowFarPlaneLoc >= 0)
+    if (--m_depthPrepassFramesUntilProbe <= 0)
     {
-        glUniform1f(m_pointShadowFarPlaneLoc, kPointShadowFarPlane);
+        m_depthPrepassFramesUntilProbe = kDepthPrepassProbeInterval;
+        m_depthPrepassProbeFramesLeft = kDepthPrepassProbeFrames - 1;
+        return !m_depthPrepassPreferred;
     }
-    if (m_shadowPointIndexLoc >= 0)
+    return m_depthPrepassPreferred;
+}
+
+void Renderer::RecordScenePassTiming()
+{
+    if (!m_sceneTimer.hasNewResult)
     {
-        glUniform1i(m_shadowPointIndexLoc, m_shadowPointIndex);
+        return;
     }
 
-    m_directionalLights.Upload(m_sceneShader.program, currentTime);
-    m_pointLights.Upload(m_sceneShader.program);
+    // O resultado chega um frame depois: a tag diz com qual variante ele foi medido.
+    const int variant = m_sceneTimer.lastResultTag != 0 ? 1 : 0;
+    double& average = m_scenePassMsAverage[variant];
+    average = m_scenePassMsAverageValid[variant]
+                  ? average + (m_sceneTimer.lastResultMs - average) * kDepthPrepassAverageWeight
+                  : m_sceneTimer.lastResultMs;
+    m_scenePassMsAverageValid[variant] = true;
 
-    glm::vec3 cameraPos = camera.GetPosition();
-    const Frustum frustum = ExtractFrustum(projection * view);
-    if (m_sceneInstanceFlagLoc >= 0)
+    if (!m_scenePassMsAverageValid[0] || !m_scenePassMsAverageValid[1])
+    {
+        return;
+    }
+    // Margem evita alternar a cada frame quando os dois caminhos custam quase o mesmo.
+    const double withoutPrepass = m_scenePassMsAverage[0];
+    const double withPrepass = m_scenePassMsAverage[1];
+    if (m_depthPrepassPreferred && withPrepass > withoutPrepass * kDepthPrepassSwitchMargin)
+    {
+        m_depthPrepassPreferred = false;
+    }
+    else if (!m_depthPrepassPreferred && withPrepass * kDepthPrepassSwitchMargin < withoutPrepass)
     {
-        glUniform1i(m_sceneInstanceFlagLoc, 0);
+        m_depthPrepassPreferred = true;
+    }
+}
+
+const char* Renderer::GetDepthPrepassModeLabel() const
+{
+    switch (m_depthPrepassMode)
+    {
+    case DepthPrepassMode::AlwaysOn:
+        return "ligada";
+    case DepthPrepassMode::AlwaysOff:
+        return "desligada";
+    default:
+        return "automática";
     }
-    DrawSceneObjects(m_modelLoc, m_sceneShader.program, m_defaultWhiteTexture, &frustum, &cameraPos);
-    DrawInstancedBatches(m_modelLoc, m_sceneShader.program, m_defaultWhiteTexture, m_sceneInstanceFlagLoc, &frustum);
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
 void Renderer::RenderPostProcessPass(int viewportWidth, int viewportHeight)
 {
-    glViewport(0, 0, viewportWidth, viewportHeight);
+    m_stateCache.Viewport(0, 0, viewportWidth, viewportHeight);
     glClearColor(0.05f, 0.05f, 0.06f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
-    glDisable(GL_DEPTH_TEST);
+    m_stateCache.Disable(GL_DEPTH_TEST);
 
     m_postProcessShader.Use();
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, m_sceneFramebuffer.colorAttachments[0]);
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, m_sceneFramebuffer.colorAttachments[1]);
-    glBindVertexArray(m_quadVAO);
+    m_stateCache.BindTextureUnit(GL_TEXTURE0, GL_TEXTURE_2D, m_sceneFramebuffer.colorAttachments[0]);
+    m_stateCache.BindTextureUnit(GL_TEXTURE1, GL_TEXTURE_2D, m_sceneFramebuffer.colorAttachments[1]);
+    m_stateCache.BindVertexArray(m_quadVAO);
     glDrawArrays(GL_TRIANGLES, 0, 6);
-    glBindVertexArray(0);
-    glEnable(GL_DEPTH_TEST);
-    glActiveTexture(GL_TEXTURE0);
+    m_stateCache.Enable(GL_DEPTH_TEST);
 }
 
 void Renderer::RenderPhysicsDebugOverlay(const glm::mat4& viewProjection)
@@ -993,43 +1719,45 @@ void Renderer::RenderPhysicsDebugOverlay(const glm::mat4& viewProjection)
         return;
     }
 
-    glUseProgram(m_physicsDebugShader.program);
+    m_stateCache.UseProgram(m_physicsDebugShader.program);
     glUniformMatrix4fv(m_physicsDebugViewProjLoc, 1, GL_FALSE, glm::value_ptr(viewProjection));
 
-    glBindVertexArray(m_physicsDebugVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, m_physicsDebugVBO);
+    m_stateCache.BindVertexArray(m_physicsDebugVAO);
+    m_stateCache.BindBuffer(GL_ARRAY_BUFFER, m_physicsDebugVBO);
     glBufferData(GL_ARRAY_BUFFER,
                  static_cast<GLsizeiptr>(vertices.size() * sizeof(PhysicsDebugVertex)),
                  vertices.data(),
                  GL_DYNAMIC_DRAW);
 
-    const GLboolean depthWasEnabled = glIsEnabled(GL_DEPTH_TEST);
-    glDisable(GL_DEPTH_TEST);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    const bool depthWasEnabled = m_stateCache.IsEnabled(GL_DEPTH_TEST);
+    m_stateCache.Disable(GL_DEPTH_TEST);
+    m_stateCache.Enable(GL_BLEND);
+    m_stateCache.BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     glLineWidth(1.4f);
     glDrawArrays(GL_LINES, 0, static_cast<GLsizei>(vertices.size()));
     glLineWidth(1.0f);
-    glDisable(GL_BLEND);
-    if (depthWasEnabled == GL_TRUE)
+    m_stateCache.Disable(GL_BLEND);
+    if (depthWasEnabled)
     {
-        glEnable(GL_DEPTH_TEST);
+        m_stateCache.Enable(GL_DEPTH_TEST);
     }
-
-    glBindVertexArray(0);
 }
 
-void Renderer::DrawSceneObjects(GLint modelLocation,
-                                GLuint program,
-                                GLuint fallbackTexture,
-                                const Frustum* frustum,
-                                const glm::vec3* cameraPos)
+void Renderer::DrawSceneObjects(const SceneDrawParams& params)
 {
     if (m_scene == nullptr)
     {
         return;
     }
 
+    PassCullingStats discardedStats;
+    PassCullingStats& cullingStats = params.cullingStats != nullptr ? *params.cullingStats : discardedStats;
+
+    m_renderQueue.Clear();
+    m_renderQueue.SetDepthRange(kCameraNearPlane, kCameraFarPlane);
+    m_renderQueue.SetDepthOnly(params.depthOnly);
+    m_visibleObjects.clear();
+
     const auto& objects = m_scene->GetObjects();
     for (const auto& object : objects)
     {
@@ -1038,62 +1766,194 @@ void Renderer::DrawSceneObjects(GLint modelLocation,
         {
             continue;
         }
+        if (params.casterFilter != CasterFilter::All &&
+            m_scene->IsDynamicObject(object) != (params.casterFilter == CasterFilter::DynamicOnly))
+        {
+            continue;
+        }
 
         const glm::mat4 modelMatrix = object.GetModelMatrix();
         const glm::vec3 worldCenter = object.GetWorldCenter(modelMatrix);
         const float worldRadius = object.GetWorldRadius();
 
-        if (frustum != nullptr && !frustum->IsSphereVisible(worldCenter, worldRadius))
+        ++cullingStats.tested;
+        if (params.frustum != nullptr && !params.frustum->IsSphereVisible(worldCenter, worldRadius))
         {
+            ++cullingStats.culled;
             continue;
         }
+        if (params.softwareOcclusion != nullptr &&
+            !params.softwareOcclusion->IsObjectVisible(static_cast<std::size_t>(&object - objects.data())))
+        {
+            ++cullingStats.softwareOcclusionCulled;
+            continue;
+        }
+        if (params.occlusion != nullptr && params.occlusion->HasData())
+        {
+            ++cullingStats.occlusionTested;
+            if (params.occlusion->IsSphereOccluded(worldCenter, worldRadius))
+            {
+                ++cullingStats.occlusionCulled;
+                continue;
+            }
+        }
 
-        if (cameraPos != nullptr)
+        float viewDepth = 0.0f;
+        if (params.cameraPos != nullptr)
         {
-            const float distance = glm::length(worldCenter - *cameraPos);
+            const float distance = glm::length(worldCenter - *params.cameraPos);
             resolvedModel = object.ResolveModelForDistance(distance);
             if (resolvedModel == nullptr)
             {
                 continue;
             }
+            viewDepth = std::max(distance - worldRadius, 0.0f);
+        }
+
+        // Com a câmera dentro da caixa o near plane recortaria as faces da frente e a query mentiria.
+        GLuint conditionQuery = 0;
+        if (params.occlusionQueries != nullptr && object.UsesOcclusionQuery() && viewDepth > kCameraNearPlane)
+        {
+            const std::size_t objectIndex = static_cast<std::size_t>(&object - objects.data());
+            const Model* boxModel = object.GetModel();
+            const glm::vec3 halfExtents =
+                boxModel->HasBounds() ? boxModel->GetBoundingHalfExtents() : glm::vec3(object.GetLocalBoundsRadius());
+            // O pré-passe usa a mesma query; só a passada de cor conta draws, senão skippedDraws dobra.
+            const std::size_t countedDraws = params.depthOnly ? 0 : resolvedModel->GetMeshes().size();
+            conditionQuery = params.occlusionQueries->AcquireConditionQuery(objectIndex, countedDraws);
+            params.occlusionQueries->Request(objectIndex, modelMatrix, object.GetLocalBoundsCenter(), halfExtents);
+        }
+
+        m_visibleObjects.push_back(VisibleSceneObject{ resolvedModel, modelMatrix, viewDepth, conditionQuery });
+    }
+
+    // Agrupa por modelo já resolvido (pós-LOD): grupos com cópias suficientes viram um draw instanciado
+    // por mesh, com as matrizes empacotadas em sequência no buffer de instâncias.
+    // Draws condicionais ficam fora dos grupos (cada um tem a sua query), no fim do seu modelo.
+    const bool canInstance = params.instancingUniformLoc >= 0 || params.instancedProgram != 0;
+    const bool groupByModel = m_autoInstancingEnabled && canInstance && m_instanceStream.IsValid();
+    if (groupByModel)
+    {
+        std::stable_sort(m_visibleObjects.begin(), m_visibleObjects.end(),
+                         [](const VisibleSceneObject& a, const VisibleSceneObject& b) {
+                             if (a.model != b.model)
+                             {
+                                 return std::less<const Model*>()(a.model, b.model);
+                             }
+                             return a.conditionQuery == 0 && b.conditionQuery != 0;
+                         });
+    }
+
+    m_autoInstanceMatrices.clear();
+    std::size_t groupBegin = 0;
+    while (groupBegin < m_visibleObjects.size())
+    {
+        std::size_t groupEnd = groupBegin + 1;
+        if (groupByModel && m_visibleObjects[groupBegin].conditionQuery == 0)
+        {
+            while (groupEnd < m_visibleObjects.size() &&
+                   m_visibleObjects[groupEnd].model == m_visibleObjects[groupBegin].model &&
+                   m_visibleObjects[groupEnd].conditionQuery == 0)
+            {
+                ++groupEnd;
+            }
         }
 
-        if (modelLocation >= 0)
+        const Model& groupModel = *m_visibleObjects[groupBegin].model;
+        const std::size_t groupSize = groupEnd - groupBegin;
+        if (groupSize >= kAutoInstancingMinGroupSize)
+        {
+            const GLintptr byteOffset = static_cast<GLintptr>(m_autoInstanceMatrices.size() * sizeof(glm::mat4));
+            float nearestDepth = std::numeric_limits<float>::max();
+            for (std::size_t i = groupBegin; i < groupEnd; ++i)
+            {
+                m_autoInstanceMatrices.push_back(m_visibleObjects[i].modelMatrix);
+                nearestDepth = std::min(nearestDepth, m_visibleObjects[i].viewDepth);
+            }
+            m_renderQueue.PushModelInstanced(groupModel,
+                                             params.instancedProgram != 0 ? params.instancedProgram : params.program,
+                                             params.fallbackTexture,
+                                             byteOffset,
+                                             static_cast<GLsizei>(groupSize),
+                                             nearestDepth);
+        }
+        else
         {
-            glUniformMatrix4fv(modelLocation, 1, GL_FALSE, glm::value_ptr(modelMatrix));
+            for (std::size_t i = groupBegin; i < groupEnd; ++i)
+            {
+                const VisibleSceneObject& visible = m_visibleObjects[i];
+                // Uma inversa 3x3 por objeto visível em vez de uma 4x4 por vértice no shader.
+                const glm::mat3 normalMatrix = params.normalMatrixLocation >= 0
+                                                   ? glm::inverseTranspose(glm::mat3(visible.modelMatrix))
+                                                   : glm::mat3(1.0f);
+                m_renderQueue.PushModel(*visible.model,
+                                        params.program,
+                                        params.fallbackTexture,
+                                        visible.modelMatrix,
+                                        normalMatrix,
+                                        visible.viewDepth,
+                                        visible.conditionQuery);
+            }
         }
-        resolvedModel->Draw(program, fallbackTexture);
+        groupBegin = groupEnd;
     }
+
+    const GLintptr instanceBaseOffset = UploadInstanceMatrices(m_autoInstanceMatrices);
+    m_renderQueue.Sort();
+    m_renderQueue.Flush(params.modelLocation,
+                        params.normalMatrixLocation,
+                        params.instancingUniformLoc,
+                        instanceBaseOffset >= 0 ? m_instanceStream.GetID() : 0,
+                        std::max<GLintptr>(instanceBaseOffset, 0));
 }
 
-void Renderer::DrawInstancedBatches(GLint modelLocation,
-                                    GLuint program,
-                                    GLuint fallbackTexture,
-                                    GLint instancingUniformLoc,
-                                    const Frustum* frustum)
+void Renderer::DrawInstancedBatches(const SceneDrawParams& params)
 {
-    if (m_scene == nullptr || m_instanceVBO == 0)
+    // Batches instanciados são cenário fixo: sempre casters estáticos.
+    if (m_scene == nullptr || !m_instanceStream.IsValid() || params.casterFilter == CasterFilter::DynamicOnly)
     {
         return;
     }
 
+    PassCullingStats discardedStats;
+    PassCullingStats& cullingStats = params.cullingStats != nullptr ? *params.cullingStats : discardedStats;
+
     const auto& batches = m_scene->GetInstancedBatches();
     if (batches.empty())
     {
         return;
     }
 
-    glm::mat4 identity(1.0f);
-    if (modelLocation >= 0)
+    // Matrizes residentes no texture buffer estático: a passada só envia índices. Variantes compiladas pedem a
+    // sua versão INSTANCE_TRANSFORM_BUFFER; shaders com o uniform de instancing usam o modo 2.
+    const bool staticTransforms =
+        m_staticInstances.IsReady() &&
+        (params.instancedProgram != 0 ? params.transformIndexProgram != 0 : params.instancingUniformLoc >= 0);
+    const InstanceAttributeLayout layout =
+        staticTransforms ? InstanceAttributeLayout::TransformIndices : InstanceAttributeLayout::Matrices;
+    if (staticTransforms)
+    {
+        m_staticInstances.Bind();
+    }
+
+    // Variante instanciada: a matriz vem só do atributo. Sem ela, o programa da passada troca pelo uniform.
+    if (params.instancedProgram != 0)
     {
-        glUniformMatrix4fv(modelLocation, 1, GL_FALSE, glm::value_ptr(identity));
+        m_stateCache.UseProgram(staticTransforms ? params.transformIndexProgram : params.instancedProgram);
     }
-    if (instancingUniformLoc >= 0)
+    else
     {
-        glUniform1i(instancingUniformLoc, 1);
+        glm::mat4 identity(1.0f);
+        if (params.modelLocation >= 0)
+        {
+            glUniformMatrix4fv(params.modelLocation, 1, GL_FALSE, glm::value_ptr(identity));
+        }
+        if (params.instancingUniformLoc >= 0)
+        {
+            glUniform1i(params.instancingUniformLoc, staticTransforms ? kInstanceSourceTransformBuffer : kInstanceSourceAttribute);
+        }
     }
 
-    std::vector<glm::mat4> culledTransforms;
     for (const auto& batch : batches)
     {
         if (batch.model == nullptr || batch.transforms.empty())
@@ -1101,83 +1961,123 @@ void Renderer::DrawInstancedBatches(GLint modelLocation,
             continue;
         }
 
-        const std::vector<glm::mat4>* transformsToDraw = &batch.transforms;
-        if (frustum != nullptr)
+        const std::size_t batchIndex = static_cast<std::size_t>(&batch - batches.data());
+        const std::size_t instanceCount = batch.transforms.size();
+        cullingStats.tested += instanceCount;
+        m_visibleInstanceIndices.resize(batch.bounds.PaddedSize());
+        std::size_t visibleCount = instanceCount;
+        if (params.frustum != nullptr)
         {
-            culledTransforms.clear();
-            culledTransforms.reserve(batch.transforms.size());
-            for (const glm::mat4& transform : batch.transforms)
+            // Frustum sobre as esferas pré-calculadas em SoA; oclusão só para as que sobraram, compactando no lugar.
+            const std::size_t frustumVisible = CullSpheres(*params.frustum, batch.bounds, m_visibleInstanceIndices.data());
+            cullingStats.culled += instanceCount - frustumVisible;
+
+            visibleCount = 0;
+            for (std::size_t visible = 0; visible < frustumVisible; ++visible)
             {
-                const glm::vec3 center = glm::vec3(transform[3]);
-                const float scaleX = glm::length(glm::vec3(transform[0]));
-                const float scaleY = glm::length(glm::vec3(transform[1]));
-                const float scaleZ = glm::length(glm::vec3(transform[2]));
-                const float maxScale = std::max({ scaleX, scaleY, scaleZ });
-                const float radius = batch.baseRadius * maxScale;
-                if (frustum->IsSphereVisible(center, radius))
+                const std::uint32_t instance = m_visibleInstanceIndices[visible];
+                if (params.softwareOcclusion != nullptr &&
+                    !params.softwareOcclusion->IsInstanceClusterVisible(
+                        batchIndex, instance / SoftwareOcclusionCuller::kInstanceClusterSize))
+                {
+                    ++cullingStats.softwareOcclusionCulled;
+                    continue;
+                }
+                if (params.occlusion != nullptr && params.occlusion->HasData())
                 {
-                    culledTransforms.push_back(transform);
+                    ++cullingStats.occlusionTested;
+                    if (params.occlusion->IsSphereOccluded(batch.bounds.GetCenter(instance), batch.bounds.radius[instance]))
+                    {
+                        ++cullingStats.occlusionCulled;
+                        continue;
+                    }
                 }
+                m_visibleInstanceIndices[visibleCount++] = instance;
             }
-            transformsToDraw = &culledTransforms;
+        }
+        else
+        {
+            std::iota(m_visibleInstanceIndices.begin(), m_visibleInstanceIndices.begin() + instanceCount, 0u);
+        }
+
+        if (visibleCount == 0)
+        {
+            continue;
         }
 
-        if (transformsToDraw->empty())
+        GLintptr byteOffset = -1;
+        if (staticTransforms)
+        {
+            const std::uint32_t firstIndex = m_staticInstances.GetFirstIndex(batchIndex);
+            for (std::size_t i = 0; i < visibleCount; ++i)
+            {
+                m_visibleInstanceIndices[i] += firstIndex;
+            }
+            byteOffset = UploadInstanceIndices(m_visibleInstanceIndices.data(), visibleCount);
+        }
+        else if (visibleCount == instanceCount)
+        {
+            byteOffset = UploadInstanceMatrices(batch.transforms);
+        }
+        else
+        {
+            m_culledInstanceTransforms.clear();
+            for (std::size_t i = 0; i < visibleCount; ++i)
+            {
+                m_culledInstanceTransforms.push_back(batch.transforms[m_visibleInstanceIndices[i]]);
+            }
+            byteOffset = UploadInstanceMatrices(m_culledInstanceTransforms);
+        }
+        if (byteOffset < 0)
         {
             continue;
         }
 
-        UpdateInstanceBuffer(*transformsToDraw);
-        batch.model->DrawInstanced(program,
-                                   fallbackTexture,
-                                   m_instanceVBO,
-                                   static_cast<GLsizei>(transformsToDraw->size()));
+        if (params.depthOnly)
+        {
+            batch.model->DrawDepthInstanced(m_instanceStream.GetID(),
+                                            static_cast<GLsizei>(visibleCount),
+                                            byteOffset,
+                                            layout);
+            continue;
+        }
+        batch.model->DrawInstanced(params.fallbackTexture,
+                                   m_instanceStream.GetID(),
+                                   static_cast<GLsizei>(visibleCount),
+                                   byteOffset,
+                                   layout);
     }
 
-    if (instancingUniformLoc >= 0)
+    if (params.instancedProgram == 0 && params.instancingUniformLoc >= 0)
     {
-        glUniform1i(instancingUniformLoc, 0);
+        glUniform1i(params.instancingUniformLoc, kInstanceSourceUniform);
     }
 }
 
-bool Renderer::EnsureInstanceBufferSize(std::size_t instanceCount)
+GLintptr Renderer::UploadInstanceIndices(const std::uint32_t* indices, std::size_t count)
 {
-    if (instanceCount == 0)
-    {
-        return true;
-    }
-
-    const GLsizeiptr requiredSize = static_cast<GLsizeiptr>(instanceCount * sizeof(glm::mat4));
-    if (requiredSize <= m_instanceBufferCapacity)
+    if (count == 0)
     {
-        return true;
+        return -1;
     }
 
-    glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
-    glBufferData(GL_ARRAY_BUFFER, requiredSize, nullptr, GL_DYNAMIC_DRAW);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    m_instanceBufferCapacity = requiredSize;
-    return true;
+    // Alinhado a um índice: o offset vira o baseInstance do atributo uint.
+    return m_instanceStream.Upload(indices,
+                                   static_cast<GLsizeiptr>(count * sizeof(std::uint32_t)),
+                                   static_cast<GLsizeiptr>(sizeof(std::uint32_t)));
 }
 
-void Renderer::UpdateInstanceBuffer(const std::vector<glm::mat4>& matrices)
+GLintptr Renderer::UploadInstanceMatrices(const std::vector<glm::mat4>& matrices)
 {
     if (matrices.empty())
     {
-        return;
-    }
-
-    if (!EnsureInstanceBufferSize(matrices.size()))
-    {
-        return;
+        return -1;
     }
 
-    glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
-    glBufferSubData(GL_ARRAY_BUFFER,
-                    0,
-                    static_cast<GLsizeiptr>(matrices.size() * sizeof(glm::mat4)),
-                    matrices.data());
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    // Alinhado a uma matriz: o offset vira um baseInstance exato no draw.
+    return m_instanceStream.Upload(matrices.data(),
+                                   static_cast<GLsizeiptr>(matrices.size() * sizeof(glm::mat4)),
+                                   static_cast<GLsizeiptr>(sizeof(glm::mat4)));
 }
 
 bool Renderer::EnsurePhysicsDebugResources()
@@ -1194,8 +2094,8 @@ bool Renderer::EnsurePhysicsDebugResources()
         return false;
     }
 
-    glBindVertexArray(m_physicsDebugVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, m_physicsDebugVBO);
+    m_stateCache.BindVertexArray(m_physicsDebugVAO);
+    m_stateCache.BindBuffer(GL_ARRAY_BUFFER, m_physicsDebugVBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(PhysicsDebugVertex) * 2, nullptr, GL_DYNAMIC_DRAW);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(PhysicsDebugVertex), reinterpret_cast<void*>(0));
@@ -1206,8 +2106,8 @@ bool Renderer::EnsurePhysicsDebugResources()
                           GL_FALSE,
                           sizeof(PhysicsDebugVertex),
                           reinterpret_cast<void*>(sizeof(glm::vec3)));
-    glBindVertexArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    m_stateCache.BindVertexArray(0);
+    m_stateCache.BindBuffer(GL_ARRAY_BUFFER, 0);
     return true;
 }
 
@@ -1215,12 +2115,12 @@ void Renderer::DestroyPhysicsDebugResources()
 {
     if (m_physicsDebugVBO != 0)
     {
-        glDeleteBuffers(1, &m_physicsDebugVBO);
+        m_stateCache.DeleteBuffer(m_physicsDebugVBO);
         m_physicsDebugVBO = 0;
     }
     if (m_physicsDebugVAO != 0)
     {
-        glDeleteVertexArrays(1, &m_physicsDebugVAO);
+        m_stateCache.DeleteVertexArray(m_physicsDebugVAO);
         m_physicsDebugVAO = 0;
     }
 }
@@ -1291,9 +2191,9 @@ bool Renderer::EnsureFramebufferSize(MultiRenderTargetFramebuffer& framebuffer,
             glGenTextures(1, &attachment);
         }
     }
-    if (framebuffer.depthBuffer == 0)
+    if (framebuffer.depthTexture == 0)
     {
-        glGenRenderbuffers(1, &framebuffer.depthBuffer);
+        glGenTextures(1, &framebuffer.depthTexture);
     }
 
     if (width == framebuffer.width && height == framebuffer.height)
@@ -1304,10 +2204,10 @@ bool Renderer::EnsureFramebufferSize(MultiRenderTargetFramebuffer& framebuffer,
     framebuffer.width = width;
     framebuffer.height = height;
 
-    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer.fbo);
+    m_stateCache.BindFramebuffer(GL_FRAMEBUFFER, framebuffer.fbo);
     for (std::size_t i = 0; i < framebuffer.colorAttachments.size(); ++i)
     {
-        glBindTexture(GL_TEXTURE_2D, framebuffer.colorAttachments[i]);
+        m_stateCache.BindTexture(GL_TEXTURE_2D, framebuffer.colorAttachments[i]);
         glTexImage2D(GL_TEXTURE_2D,
                      0,
                      GL_RGBA16F,
@@ -1327,17 +2227,28 @@ bool Renderer::EnsureFramebufferSize(MultiRenderTargetFramebuffer& framebuffer,
                                framebuffer.colorAttachments[i],
                                0);
     }
-    glBindTexture(GL_TEXTURE_2D, 0);
 
-    glBindRenderbuffer(GL_RENDERBUFFER, framebuffer.depthBuffer);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, framebuffer.width, framebuffer.height);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, framebuffer.depthBuffer);
-    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    m_stateCache.BindTexture(GL_TEXTURE_2D, framebuffer.depthTexture);
+    glTexImage2D(GL_TEXTURE_2D,
+                 0,
+                 GL_DEPTH24_STENCIL8,
+                 framebuffer.width,
+                 framebuffer.height,
+                 0,
+                 GL_DEPTH_STENCIL,
+                 GL_UNSIGNED_INT_24_8,
+                 nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, framebuffer.depthTexture, 0);
+    m_stateCache.BindTexture(GL_TEXTURE_2D, 0);
 
     const GLuint attachments[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
     glDrawBuffers(2, attachments);
     bool isComplete = (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    m_stateCache.BindFramebuffer(GL_FRAMEBUFFER, 0);
     return isComplete;
 }
 
@@ -1345,21 +2256,21 @@ void Renderer::DestroyFramebuffer(MultiRenderTargetFramebuffer& framebuffer)
 {
     if (framebuffer.fbo != 0)
     {
-        glDeleteFramebuffers(1, &framebuffer.fbo);
+        m_stateCache.DeleteFramebuffer(framebuffer.fbo);
         framebuffer.fbo = 0;
     }
     for (GLuint& attachment : framebuffer.colorAttachments)
     {
         if (attachment != 0)
         {
-            glDeleteTextures(1, &attachment);
+            m_stateCache.DeleteTexture(attachment);
             attachment = 0;
         }
     }
-    if (framebuffer.depthBuffer != 0)
+    if (framebuffer.depthTexture != 0)
     {
-        glDeleteRenderbuffers(1, &framebuffer.depthBuffer);
-        framebuffer.depthBuffer = 0;
+        m_stateCache.DeleteTexture(framebuffer.depthTexture);
+        framebuffer.depthTexture = 0;
     }
     framebuffer.width = 0;
     framebuffer.height = 0;
@@ -1386,6 +2297,81 @@ void Renderer::ToggleMetricsOverlay()
     m_forceOverlayUpdate = true;
 }
 
+void Renderer::ToggleAutoInstancing()
+{
+    m_autoInstancingEnabled = !m_autoInstancingEnabled;
+    PushOverlayStatus(m_autoInstancingEnabled ? "Instancing automático ligado (F3)" : "Instancing automático desligado (F3)");
+}
+
+void Renderer::TogglePointShadowMode()
+{
+    m_pointShadowMode = m_pointShadowMode == PointShadowMode::GeometryShader ? PointShadowMode::PerFaceCulled
+                                                                             : PointShadowMode::GeometryShader;
+    PushOverlayStatus(std::string("Sombra pontual: ") + GetPointShadowModeLabel() + " (P)");
+}
+
+void Renderer::CycleDepthPrepassMode()
+{
+    switch (m_depthPrepassMode)
+    {
+    case DepthPrepassMode::Auto:
+        m_depthPrepassMode = DepthPrepassMode::AlwaysOn;
+        break;
+    case DepthPrepassMode::AlwaysOn:
+        m_depthPrepassMode = DepthPrepassMode::AlwaysOff;
+        break;
+    default:
+        m_depthPrepassMode = DepthPrepassMode::Auto;
+        break;
+    }
+    PushOverlayStatus(std::string("Pré-passe de depth ") + GetDepthPrepassModeLabel() + " (F6)");
+}
+
+void Renderer::ToggleShadowCache()
+{
+    m_shadowCacheEnabled = !m_shadowCacheEnabled;
+    InvalidateShadowCache();
+    PushOverlayStatus(m_shadowCacheEnabled ? "Cache de sombras estáticas ligado (C)" : "Cache de sombras estáticas desligado (C)");
+}
+
+void Renderer::ToggleOcclusionCulling()
+{
+    if (!m_hiZAvailable)
+    {
+        PushOverlayStatus("Oclusão Hi-Z indisponível (F8)");
+        return;
+    }
+    m_occlusionCullingEnabled = !m_occlusionCullingEnabled;
+    // Religar não deve reaproveitar uma depth de muitos frames atrás.
+    m_hiZOcclusion.Invalidate();
+    PushOverlayStatus(m_occlusionCullingEnabled ? "Oclusão Hi-Z ligada (F8)" : "Oclusão Hi-Z desligada (F8)");
+}
+
+void Renderer::ToggleSoftwareOcclusion()
+{
+    m_softwareOcclusionEnabled = !m_softwareOcclusionEnabled;
+    PushOverlayStatus(m_softwareOcclusionEnabled ? "Oclusão por software ligada (F9)" : "Oclusão por software desligada (F9)");
+}
+
+void Renderer::ToggleOcclusionQueries()
+{
+    m_occlusionQueriesEnabled = !m_occlusionQueriesEnabled;
+    PushOverlayStatus(m_occlusionQueriesEnabled ? "Queries de oclusão ligadas (F10)" : "Queries de oclusão desligadas (F10)");
+}
+
+void Renderer::ToggleGpuDriven()
+{
+    if (!m_gpuDrivenAvailable)
+    {
+        PushOverlayStatus("GPU-driven indisponível (requer GL 4.3) (F7)");
+        return;
+    }
+    m_gpuDrivenEnabled = !m_gpuDrivenEnabled;
+    // Os dois caminhos rasterizam os mesmos casters, mas o cache não precisa apostar nisso.
+    InvalidateShadowCache();
+    PushOverlayStatus(m_gpuDrivenEnabled ? "GPU-driven ligado (F7)" : "GPU-driven desligado (F7)");
+}
+
 void Renderer::ClearDebugMessages()
 {
     const std::size_t removed = m_debugMessages.size();
@@ -1503,6 +2489,80 @@ void Renderer::UpdateOverlayTitle(GLFWwindow* window, float currentTime)
            << "Post " << m_gpuTimingSummary.postProcessMs << "ms"
            << " (Total " << m_gpuTimingSummary.Total() << "ms)";
 
+        ss << " | Queue " << m_lastQueueStats.draws << " draws ("
+           << m_lastQueueStats.instancedDraws << " inst/" << m_lastQueueStats.instances << " obj), "
+           << m_lastQueueStats.skippedBinds << " binds evitados, " << m_lastQueueStats.vertexArrayBinds << " VAOs";
+
+        const GeometryPoolStats& geometryStats = GeometryPool::Get().GetStats();
+        ss << " | Geometria " << geometryStats.allocations << " meshes (" << geometryStats.quantizedAllocations
+           << " quantizados, " << geometryStats.shortIndexAllocations << " índices 16 bits), vértices "
+           << geometryStats.vertexBytesUsed / 1024 << "/" << geometryStats.vertexBytesCapacity / 1024 << "KB, índices "
+           << geometryStats.indexBytesUsed / 1024 << "/" << geometryStats.indexBytesCapacity / 1024 << "KB";
+
+        ss << " | Estado GL " << m_lastStateStats.issuedCalls << " chamadas, " << m_lastStateStats.skippedCalls
+           << " redundantes filtradas";
+
+        if (m_gpuDrivenReady)
+        {
+            ss << " | GPU-driven " << m_lastGpuDrivenStats.objects << " objs, " << m_lastGpuDrivenStats.commands
+               << " cmds, " << m_lastGpuDrivenStats.multiDraws << " MDI, " << m_lastGpuDrivenStats.cullDispatches
+               << " dispatches";
+        }
+
+        ss << " | Variantes cena " << m_sceneShaderVariants.GetCompiledCount() << ", prepass "
+           << m_prepassShaderVariants.GetCompiledCount() << " (" << m_lastQueueStats.programBinds << " trocas de programa)";
+
+        ss << " | Stream " << (m_instanceStream.IsPersistent() ? "persist " : "orphan ")
+           << std::setprecision(1)
+           << static_cast<float>(m_lastStreamStats.bytesUploaded) / 1024.0f << "KB, "
+           << m_lastStreamStats.fenceWaits << " esperas";
+        if (m_staticInstances.IsReady())
+        {
+            ss << ", instâncias estáticas " << static_cast<float>(m_staticInstances.GetResidentBytes()) / 1024.0f
+               << "KB residentes";
+        }
+
+        ss << " | Culled Dir " << m_directionalCullStats.culled << "/" << m_directionalCullStats.tested
+           << ", Point[" << GetPointShadowModeLabel() << "] " << m_pointCullStats.culled << "/" << m_pointCullStats.tested
+           << ", Scene " << m_sceneCullStats.culled << "/" << m_sceneCullStats.tested;
+
+        ss << " | Hi-Z " << (m_occlusionCullingEnabled ? "on " : "off ") << m_sceneCullStats.occlusionCulled << "/"
+           << m_sceneCullStats.occlusionTested << " ocultos";
+
+        const SoftwareOcclusionStats& softwareStats = m_softwareOcclusion.GetStats();
+        ss << " | SW oclusão " << (m_softwareOcclusionEnabled ? "on " : "off ") << softwareStats.occluders
+           << " oclusoras, " << softwareStats.triangles << " tris, " << softwareStats.culled << "/" << softwareStats.tested
+           << " caixas ocultas, " << m_sceneCullStats.softwareOcclusionCulled << " draws evitados, " << std::setprecision(2)
+           << softwareStats.cullMs << "ms";
+
+        const OcclusionQueryStats& queryStats = m_occlusionQueries.GetStats();
+        ss << " | Queries " << (m_occlusionQueriesEnabled ? "on" : "off")
+           << (m_occlusionQueries.IsConservative() ? " (conservativa) " : " ") << queryStats.queries << "/"
+           << queryStats.candidates << " caixas, " << queryStats.skippedDraws << " draws pulados, " << queryStats.pending
+           << " sem resultado";
+
+        ss << " | Prepass " << (m_depthPrepassActive ? "on" : "off") << " [" << GetDepthPrepassModeLabel() << "]";
+        if (m_scenePassMsAverageValid[0] && m_scenePassMsAverageValid[1])
+        {
+            ss << std::setprecision(2) << " (sem " << m_scenePassMsAverage[0] << "ms / com " << m_scenePassMsAverage[1]
+               << "ms)";
+        }
+
+        const LightClusterStats& clusterStats = m_lightClusters.GetStats();
+        ss << " | Clusters " << LightClusterGrid::kTilesX << "x" << LightClusterGrid::kTilesY << "x"
+           << LightClusterGrid::kSlicesZ << ": " << clusterStats.lights << " luzes, " << clusterStats.lightReferences
+           << " refs, max " << clusterStats.maxLightsInCluster << "/cluster, " << std::setprecision(2)
+           << clusterStats.assignMs << "ms CPU";
+        if (clusterStats.overflowedClusters > 0)
+        {
+            ss << " (" << clusterStats.overflowedClusters << " cheios)";
+        }
+
+        ss << " | CSM " << m_cascadeCount << "x" << m_cascadeResolution;
+
+        ss << " | Shadow cache " << (m_shadowCacheEnabled ? "on" : "off")
+           << " (rebuilds Dir " << m_directionalCacheRebuilds << ", Point " << m_pointCacheRebuilds << ")";
+
         ss << " | GL msgs " << m_debugMessages.size();
 
         if (!m_overlayStatusMessage.empty())
@@ -1570,12 +2630,13 @@ void Renderer::DestroyGpuTimers()
     m_gpuTimersAvailable = false;
 }
 
-void Renderer::BeginGpuTimer(GpuTimer& timer)
+void Renderer::BeginGpuTimer(GpuTimer& timer, int tag)
 {
     if (!m_gpuTimersAvailable)
     {
         return;
     }
+    timer.tags[timer.writeIndex] = tag;
     glQueryCounter(timer.startQueries[timer.writeIndex], GL_TIMESTAMP);
 }
 
@@ -1596,6 +2657,7 @@ void Renderer::AdvanceGpuTimer(GpuTimer& timer)
     }
 
     const int readIndex = 1 - timer.writeIndex;
+    timer.hasNewResult = false;
     if (timer.primed)
     {
         GLint available = 0;
@@ -1609,6 +2671,8 @@ void Renderer::AdvanceGpuTimer(GpuTimer& timer)
             if (endTime > startTime)
             {
                 timer.lastResultMs = static_cast<double>(endTime - startTime) / 1000000.0;
+                timer.lastResultTag = timer.tags[readIndex];
+                timer.hasNewResult = true;
             }
         }
     }
@@ -4,6 +4,7 @@
 #include <GLFW/glfw3.h>
 
 #include <array>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <limits>
@@ -11,11 +12,22 @@
 #include <glm/glm.hpp>
 
 #include "camera.h"
+#include "gpu_driven_scene.h"
+#include "hiz_occlusion.h"
+#include "light_clusters.h"
 #include "light_manager.h"
 #include "material.h"
 #include "model.h"
+#include "render_queue.h"
+#include "render_state.h"
 #include "texture.h"
 #include "scene.h"
+#include "shader_program.h"
+#include "occlusion_queries.h"
+#include "software_occlusion.h"
+#include "static_instance_buffer.h"
+#include "streaming_buffer.h"
+#include "uniform_buffer.h"
 
 class PhysicsSystem;
 
@@ -28,22 +40,49 @@ enum class TextureOverrideMode
     Highlight
 };
 
-struct ShaderProgram
+/// @brief Como o cubemap da luz pontual é preenchido.
+enum class PointShadowMode
 {
-    GLuint program = 0;
+    GeometryShader = 0, ///< Um draw por caster; o GS replica cada triângulo nas seis faces.
+    PerFaceCulled       ///< Casters testados contra cada face; só desenhados nas faces que tocam.
+};
+
+/// @brief Limite de cascatas do shadow map direcional (tamanho dos arrays em FrameData).
+constexpr int kMaxShadowCascades = 4;
+
+/// @brief Quando a passada de cena roda a pré-passe de depth antes do shading.
+enum class DepthPrepassMode
+{
+    Auto = 0, ///< Decide por frame comparando o tempo de GPU medido com e sem a pré-passe.
+    AlwaysOn,
+    AlwaysOff
+};
 
-    bool Create(const std::string& vertexPath,
-                const std::string& fragmentPath,
-                const std::string& geometryPath = "");
-    void Use() const;
-    void Destroy();
+/// @brief Layout std140 do bloco FrameData (vertex.glsl, fragment.glsl e directional_depth_vertex.glsl).
+struct FrameUniformBlock
+{
+    glm::mat4 view{ 1.0f };
+    glm::mat4 projection{ 1.0f };
+    glm::mat4 cascadeMatrices[kMaxShadowCascades]{};
+    glm::vec4 cascadeSplits{ 0.0f };      ///< Profundidade de vista (positiva) onde cada cascata termina.
+    glm::vec4 cascadeDepthScales{ 0.0f }; ///< Converte distância em unidades de mundo para depth de cada cascata.
+    glm::vec3 viewPos{ 0.0f };
+    int cascadeCount = 0;
+};
+
+/// @brief Layout std140 do bloco PointShadowData (depth_geometry.glsl e depth_fragment.glsl).
+struct PointShadowUniformBlock
+{
+    glm::mat4 shadowMatrices[6];
+    glm::vec3 lightPos{ 0.0f };
+    float farPlane = 0.0f;
 };
 
 struct MultiRenderTargetFramebuffer
 {
     GLuint fbo = 0;
     std::array<GLuint, 2> colorAttachments{ 0, 0 };
-    GLuint depthBuffer = 0;
+    GLuint depthTexture = 0; ///< Textura (não renderbuffer) para a pirâmide Hi-Z poder amostrá-la.
     int width = 0;
     int height = 0;
 };
@@ -66,6 +105,42 @@ struct CpuFrameStats
     float maxMs = 0.0f;
 };
 
+struct PassCullingStats
+{
+    std::size_t tested = 0;
+    std::size_t culled = 0;
+    std::size_t occlusionTested = 0; ///< Sobreviventes do frustum testados contra a pirâmide Hi-Z.
+    std::size_t occlusionCulled = 0;
+    std::size_t softwareOcclusionCulled = 0; ///< Descartados pela depth das oclusoras rasterizada na CPU.
+};
+
+/// @brief Quais objetos da cena entram num draw; o cache de sombras separa estáticos de dinâmicos.
+enum class CasterFilter
+{
+    All = 0,
+    StaticOnly,
+    DynamicOnly
+};
+
+struct SceneDrawParams
+{
+    GLint modelLocation = -1;
+    GLint normalMatrixLocation = -1; ///< Inversa transposta calculada na CPU por objeto; -1 em passadas de depth.
+    GLuint program = 0;
+    GLuint fallbackTexture = 0;
+    GLint instancingUniformLoc = -1;
+    GLuint instancedProgram = 0; ///< Variante compilada com INSTANCED=1; 0 usa instancingUniformLoc em program.
+    GLuint transformIndexProgram = 0; ///< INSTANCED + INSTANCE_TRANSFORM_BUFFER: batches com matrizes residentes.
+    const Frustum* frustum = nullptr;
+    const glm::vec3* cameraPos = nullptr;
+    PassCullingStats* cullingStats = nullptr;
+    const HiZOcclusion* occlusion = nullptr; ///< Só na câmera: a depth lida é do ponto de vista dela.
+    const SoftwareOcclusionCuller* softwareOcclusion = nullptr; ///< Também só na câmera, com resultados do frame.
+    OcclusionQuerySet* occlusionQueries = nullptr; ///< Câmera: draws condicionais e caixas a testar no fim da passada.
+    CasterFilter casterFilter = CasterFilter::All;
+    bool depthOnly = false; ///< Stream só de posições, sem material/textura (sombras e pré-passe).
+};
+
 struct GpuTimingSummary
 {
     double directionalShadowMs = 0.0;
@@ -83,8 +158,11 @@ struct GpuTimer
 {
     std::array<GLuint, 2> startQueries{ 0, 0 };
     std::array<GLuint, 2> endQueries{ 0, 0 };
+    std::array<int, 2> tags{ 0, 0 }; ///< Identifica a variante medida em cada query (ex.: com/sem pré-passe).
     int writeIndex = 0;
     bool primed = false;
+    bool hasNewResult = false;
+    int lastResultTag = 0;
     double lastResultMs = 0.0;
 };
 
@@ -103,6 +181,23 @@ public:
     TextureOverrideMode GetOverrideMode() const { return m_overrideMode; }
     void SetWindowTitleBase(const std::string& title);
     void ToggleMetricsOverlay();
+    void ToggleAutoInstancing();
+    bool IsAutoInstancingEnabled() const { return m_autoInstancingEnabled; }
+    void TogglePointShadowMode();
+    void ToggleShadowCache();
+    bool IsShadowCacheEnabled() const { return m_shadowCacheEnabled; }
+    void CycleDepthPrepassMode();
+    DepthPrepassMode GetDepthPrepassMode() const { return m_depthPrepassMode; }
+    PointShadowMode GetPointShadowMode() const { return m_pointShadowMode; }
+    /// @brief Alterna entre a submissão pela CPU (fila + instancing) e o caminho GPU-driven (GL 4.3).
+    void ToggleGpuDriven();
+    bool IsGpuDrivenEnabled() const { return m_gpuDrivenEnabled; }
+    void ToggleOcclusionCulling();
+    bool IsOcclusionCullingEnabled() const { return m_occlusionCullingEnabled; }
+    void ToggleSoftwareOcclusion();
+    bool IsSoftwareOcclusionEnabled() const { return m_softwareOcclusionEnabled; }
+    void ToggleOcclusionQueries();
+    bool IsOcclusionQueriesEnabled() const { return m_occlusionQueriesEnabled; }
     bool IsMetricsOverlayEnabled() const { return m_metricsOverlayEnabled; }
     void ClearDebugMessages();
     void PushDebugMessage(GLenum source, GLenum type, GLuint id, GLenum severity, const std::string& message);
@@ -112,44 +207,73 @@ private:
     bool EnsureOffscreenSize(int width, int height);
     bool CreateShaders();
     void DestroyShaders();
+    /// @brief Shaders e buffers do caminho GPU-driven; false (sem erro fatal) se o contexto não tem GL 4.3.
+    bool SetupGpuDriven();
+    bool CreateUniformBuffers();
+    void DestroyUniformBuffers();
     bool CreateFullscreenQuad();
     void DestroyFullscreenQuad();
     void SetupLights();
     bool SetupShadowResources();
+    void DestroyShadowResources();
+    void InvalidateShadowCache();
+    std::uint64_t ComputeStaticCasterSignature() const;
+    bool ApplyShadowSettings(const SceneShadowSettings& settings);
+    void CopyShadowDepth(GLuint source,
+                         GLuint destination,
+                         GLenum target,
+                         GLsizei width,
+                         GLsizei height,
+                         GLint firstLayer,
+                         GLsizei layers);
     void UpdateOrbitingPointLight(float currentTime);
-    glm::mat4 ComputeDirectionalLightMatrix() const;
-    void RenderDirectionalShadowPass(const glm::mat4& lightSpaceMatrix);
+    void UpdateShadowCascades(const Camera& camera, float aspectRatio, FrameUniformBlock& frameBlock);
+    void RenderDirectionalShadowPass();
+    void RenderDirectionalShadowCasters(GLuint framebuffer,
+                                        GLuint depthArray,
+                                        int cascade,
+                                        const Frustum& casterVolume,
+                                        CasterFilter filter,
+                                        bool clear);
     void RenderPointShadowPass(const glm::vec3& lightPos);
+    void RenderPointShadowCasters(GLuint layeredFramebuffer,
+                                  GLuint cubemap,
+                                  const PointShadowUniformBlock& shadowBlock,
+                                  CasterFilter filter,
+                                  bool clear);
+    void RenderPointShadowFaces(GLuint layeredFramebuffer,
+                                GLuint cubemap,
+                                const PointShadowUniformBlock& shadowBlock,
+                                CasterFilter filter,
+                                bool clear);
+    const char* GetPointShadowModeLabel() const;
+    bool ChooseDepthPrepass();
+    void RecordScenePassTiming();
+    const char* GetDepthPrepassModeLabel() const;
     void RenderScenePass(const Camera& camera,
                          const glm::mat4& projection,
-                         const glm::mat4& lightSpaceMatrix,
                          int viewportWidth,
                          int viewportHeight,
                          float currentTime);
     void RenderPostProcessPass(int viewportWidth, int viewportHeight);
     void RenderPhysicsDebugOverlay(const glm::mat4& viewProjection);
-    void DrawSceneObjects(GLint modelLocation,
-                          GLuint program,
-                          GLuint fallbackTexture,
-                          const Frustum* frustum,
-                          const glm::vec3* cameraPos);
-    void DrawInstancedBatches(GLint modelLocation,
-                              GLuint program,
-                              GLuint fallbackTexture,
-                              GLint instancingUniformLoc,
-                              const Frustum* frustum);
+    /// @brief Chave da variante do shader de cena para o estado de luzes/sombras do frame (sem o bit de instancing).
+    ShaderVariantKey BuildSceneVariantKey(const LightUniformBlock& lightBlock) const;
+    void DrawSceneObjects(const SceneDrawParams& params);
+    void DrawInstancedBatches(const SceneDrawParams& params);
     void ApplyOverrideMode(TextureOverrideMode mode);
     bool EnsureFramebufferSize(MultiRenderTargetFramebuffer& framebuffer, int width, int height);
     void DestroyFramebuffer(MultiRenderTargetFramebuffer& framebuffer);
-    bool EnsureInstanceBufferSize(std::size_t instanceCount);
-    void UpdateInstanceBuffer(const std::vector<glm::mat4>& matrices);
+    /// @brief Sub-aloca as matrizes no ring de streaming do frame; retorna o offset em bytes ou -1.
+    GLintptr UploadInstanceMatrices(const std::vector<glm::mat4>& matrices);
+    GLintptr UploadInstanceIndices(const std::uint32_t* indices, std::size_t count);
     bool EnsurePhysicsDebugResources();
     void DestroyPhysicsDebugResources();
     void RecordCpuFrameTime(float deltaTimeSeconds);
     void UpdateOverlayTitle(GLFWwindow* window, float currentTime);
     bool SetupGpuTimers();
     void DestroyGpuTimers();
-    void BeginGpuTimer(GpuTimer& timer);
+    void BeginGpuTimer(GpuTimer& timer, int tag = 0);
     void EndGpuTimer(GpuTimer& timer);
     void AdvanceGpuTimer(GpuTimer& timer);
     void RefreshGpuTimingSummary();
@@ -162,18 +286,52 @@ private:
     Scene* m_scene = nullptr;
     PhysicsSystem* m_physicsSystem = nullptr;
 
-    ShaderProgram m_sceneShader;
+    ShaderVariantCache m_sceneShaderVariants;
     ShaderProgram m_directionalDepthShader;
     ShaderProgram m_pointDepthShader;
+    ShaderProgram m_pointFaceDepthShader;
+    ShaderVariantCache m_prepassShaderVariants;
+    ShaderVariantCache m_gpuSceneShaderVariants;
+    ShaderVariantCache m_gpuDepthShaderVariants;
     ShaderProgram m_postProcessShader;
     ShaderProgram m_physicsDebugShader;
 
     MultiRenderTargetFramebuffer m_sceneFramebuffer;
 
+    // Cascatas da luz direcional: uma camada do array de depth por cascata.
     GLuint m_depthMapFBO = 0;
     GLuint m_depthMap = 0;
+    SceneShadowSettings m_shadowSettings{};
+    int m_cascadeCount = 0;
+    GLsizei m_cascadeResolution = 0;
+    std::array<glm::mat4, kMaxShadowCascades> m_cascadeMatrices{};
+    /// Janela de cada cascata no espaço da luz (centro alinhado a texels e meia extensão); ver UpdateShadowCascades.
+    std::array<glm::vec3, kMaxShadowCascades> m_cascadeWindowCenters{};
+    std::array<float, kMaxShadowCascades> m_cascadeWindowExtents{};
+    glm::vec3 m_cascadeLightDirection{ 0.0f };
     GLuint m_pointDepthMapFBO = 0;
     GLuint m_pointDepthCubemap = 0;
+    GLuint m_pointFaceFBO = 0;
+
+    // Cache de sombras: depth só dos casters estáticos, copiado para os mapas vivos a cada frame.
+    GLuint m_staticDepthMapFBO = 0;
+    GLuint m_staticDepthMap = 0;
+    GLuint m_staticPointDepthMapFBO = 0;
+    GLuint m_staticPointDepthCubemap = 0;
+    GLuint m_shadowCopyReadFBO = 0;
+    GLuint m_shadowCopyDrawFBO = 0;
+    bool m_shadowCacheEnabled = true;
+    std::array<bool, kMaxShadowCascades> m_cascadeCacheValid{};
+    std::array<glm::mat4, kMaxShadowCascades> m_cachedCascadeMatrices{};
+    std::array<std::uint64_t, kMaxShadowCascades> m_cascadeCacheSignatures{};
+    bool m_pointCacheValid = false;
+    glm::vec3 m_cachedPointLightPos{ std::numeric_limits<float>::max() };
+    std::uint64_t m_staticCasterSignature = 0;
+    std::uint64_t m_pointCacheSignature = 0;
+    std::size_t m_directionalCacheRebuilds = 0;
+    std::size_t m_pointCacheRebuilds = 0;
+    PointShadowMode m_pointShadowMode = PointShadowMode::GeometryShader;
+    bool m_pointShadowLayeredFaces = false;
 
     GLuint m_quadVAO = 0;
     GLuint m_quadVBO = 0;
@@ -182,6 +340,7 @@ private:
 
     DirectionalLightManager m_directionalLights;
     PointLightManager m_pointLights;
+    LightClusterGrid m_lightClusters;
     int m_shadowPointIndex = -1;
 
     SceneObject* m_characterObject = nullptr;
@@ -203,35 +362,65 @@ private:
 
     DirectionalLight m_primarySun{};
 
-    GLint m_modelLoc = -1;
-    GLint m_viewLoc = -1;
-    GLint m_projectionLoc = -1;
-    GLint m_viewPosLoc = -1;
-    GLint m_lightSpaceLoc = -1;
-    GLint m_shadowMapLoc = -1;
-    GLint m_pointShadowMapLoc = -1;
-    GLint m_pointShadowLightPosLoc = -1;
-    GLint m_pointShadowFarPlaneLoc = -1;
-    GLint m_shadowPointIndexLoc = -1;
-
     GLint m_dirDepthModelLoc = -1;
-    GLint m_dirDepthLightSpaceLoc = -1;
+    GLint m_dirDepthCascadeLoc = -1;
 
     GLint m_pointDepthModelLoc = -1;
-    GLint m_pointDepthLightPosLoc = -1;
-    GLint m_pointDepthFarPlaneLoc = -1;
-    std::array<GLint, 6> m_pointDepthShadowMatricesLoc{};
+    GLint m_pointFaceModelLoc = -1;
+    GLint m_pointFaceInstanceFlagLoc = -1;
+    GLint m_pointFaceIndexLoc = -1;
+
+    UniformBuffer m_frameUniforms;
+    UniformBuffer m_lightUniforms;
+    UniformBuffer m_pointShadowUniforms;
 
     GLint m_postSceneColorLoc = -1;
     GLint m_postHighlightsLoc = -1;
     GLint m_postExposureLoc = -1;
     GLint m_postBloomLoc = -1;
-    GLint m_sceneInstanceFlagLoc = -1;
     GLint m_dirDepthInstanceFlagLoc = -1;
     GLint m_pointDepthInstanceFlagLoc = -1;
 
-    GLuint m_instanceVBO = 0;
-    GLsizeiptr m_instanceBufferCapacity = 0;
+    struct VisibleSceneObject
+    {
+        Model* model = nullptr;
+        glm::mat4 modelMatrix{ 1.0f };
+        float viewDepth = 0.0f;
+        GLuint conditionQuery = 0;
+    };
+
+    RenderQueue m_renderQueue;
+    RenderQueueStats m_lastQueueStats{};
+    RenderStateCache m_stateCache;
+    RenderStateStats m_lastStateStats{};
+    GpuDrivenStats m_lastGpuDrivenStats{};
+    std::vector<VisibleSceneObject> m_visibleObjects;
+    std::vector<glm::mat4> m_autoInstanceMatrices;
+    std::vector<std::uint32_t> m_visibleInstanceIndices;
+    std::vector<glm::mat4> m_culledInstanceTransforms;
+    StaticInstanceBuffer m_staticInstances;
+    bool m_autoInstancingEnabled = true;
+
+    // Caminho GPU-driven: culling em compute e multi-draw indireto; ready só quando Prepare teve sucesso no frame.
+    GpuDrivenScene m_gpuScene;
+    GLint m_gpuDepthCascadeLoc = -1;
+    bool m_gpuDrivenAvailable = false;
+    bool m_gpuDrivenEnabled = false;
+    bool m_gpuDrivenReady = false;
+
+    // Oclusão Hi-Z: pirâmide da depth da cena, testada pela CPU no frame seguinte.
+    HiZOcclusion m_hiZOcclusion;
+    bool m_hiZAvailable = false;
+    bool m_occlusionCullingEnabled = true;
+
+    // Oclusão por software: oclusoras rasterizadas na CPU numa thread paralela às passadas de sombra.
+    SoftwareOcclusionCuller m_softwareOcclusion;
+    bool m_softwareOcclusionEnabled = true;
+    OcclusionQuerySet m_occlusionQueries;
+    bool m_occlusionQueriesEnabled = true;
+
+    StreamingBuffer m_instanceStream;
+    StreamingBufferStats m_lastStreamStats{};
     GLuint m_physicsDebugVAO = 0;
     GLuint m_physicsDebugVBO = 0;
     GLint m_physicsDebugViewProjLoc = -1;
@@ -256,6 +445,18 @@ private:
     GpuTimer m_sceneTimer;
     GpuTimer m_postProcessTimer;
     GpuTimingSummary m_gpuTimingSummary;
+
+    // Pré-passe de depth: médias do tempo da passada de cena sem [0] e com [1] a pré-passe.
+    DepthPrepassMode m_depthPrepassMode = DepthPrepassMode::Auto;
+    bool m_depthPrepassActive = false;
+    bool m_depthPrepassPreferred = false;
+    std::array<double, 2> m_scenePassMsAverage{ 0.0, 0.0 };
+    std::array<bool, 2> m_scenePassMsAverageValid{ false, false };
+    int m_depthPrepassFramesUntilProbe = 0;
+    int m_depthPrepassProbeFramesLeft = 0;
+    PassCullingStats m_directionalCullStats{};
+    PassCullingStats m_pointCullStats{};
+    PassCullingStats m_sceneCullStats{};
     std::string m_overlayStatusMessage;
     float m_lastFps = 0.0f;
 };
@@ -1,5 +1,7 @@
 #include "renderer_controller.h"
 
+#include <iostream>
+
 void RendererController::Initialize(Renderer* renderer)
 {
     m_renderer = renderer;
@@ -8,6 +10,29 @@ void RendererController::Initialize(Renderer* renderer)
     m_key3Held = false;
     m_f1Held = false;
     m_f2Held = false;
+    m_f3Held = false;
+    m_pHeld = false;
+    m_cHeld = false;
+    m_f6Held = false;
+    m_f7Held = false;
+    m_f8Held = false;
+    m_f9Held = false;
+    m_f10Held = false;
+}
+
+void RendererController::PrintShortcuts() const
+{
+    std::cout << "  1/2/3  texturas importadas / xadrez / destaque\n"
+              << "  F1     overlay de métricas\n"
+              << "  F2     limpar mensagens de debug\n"
+              << "  F3     instancing automático\n"
+              << "  F6     modo do depth pre-pass\n"
+              << "  F7     caminho GPU-driven\n"
+              << "  F8     oclusão Hi-Z\n"
+              << "  F9     oclusão por software\n"
+              << "  F10    occlusion queries\n"
+              << "  P      modo da sombra pontual\n"
+              << "  C      cache de sombras estáticas" << std::endl;
 }
 
 void RendererController::ProcessShortcuts(GLFWwindow* window)
@@ -46,5 +71,38 @@ void RendererController::ProcessShortcuts(GLFWwindow* window)
     handleToggle(GLFW_KEY_F2, m_f2Held, [&]() {
         m_renderer->ClearDebugMessages();
     });
+
+    handleToggle(GLFW_KEY_F3, m_f3Held, [&]() {
+        m_renderer->ToggleAutoInstancing();
+    });
+
+    // F4 e F5 são da Application (debug de física e recarga da cena).
+    handleToggle(GLFW_KEY_P, m_pHeld, [&]() {
+        m_renderer->TogglePointShadowMode();
+    });
+
+    handleToggle(GLFW_KEY_C, m_cHeld, [&]() {
+        m_renderer->ToggleShadowCache();
+    });
+
+    handleToggle(GLFW_KEY_F6, m_f6Held, [&]() {
+        m_renderer->CycleDepthPrepassMode();
+    });
+
+    handleToggle(GLFW_KEY_F7, m_f7Held, [&]() {
+        m_renderer->ToggleGpuDriven();
+    });
+
+    handleToggle(GLFW_KEY_F8, m_f8Held, [&]() {
+        m_renderer->ToggleOcclusionCulling();
+    });
+
+    handleToggle(GLFW_KEY_F9, m_f9Held, [&]() {
+        m_renderer->ToggleSoftwareOcclusion();
+    });
+
+    handleToggle(GLFW_KEY_F10, m_f10Held, [&]() {
+        m_renderer->ToggleOcclusionQueries();
+    });
 }
 
@@ -10,6 +10,8 @@ class RendererController
 public:
     void Initialize(Renderer* renderer);
     void ProcessShortcuts(GLFWwindow* window);
+    /// @brief Lista no console as teclas tratadas por ProcessShortcuts.
+    void PrintShortcuts() const;
 
 private:
     Renderer* m_renderer = nullptr;
@@ -18,5 +20,13 @@ private:
     bool m_key3Held = false;
     bool m_f1Held = false;
     bool m_f2Held = false;
+    bool m_f3Held = false;
+    bool m_pHeld = false;
+    bool m_cHeld = false;
+    bool m_f6Held = false;
+    bool m_f7Held = false;
+    bool m_f8Held = false;
+    bool m_f9Held = false;
+    bool m_f10Held = false;
 };
 
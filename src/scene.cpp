@@ -1,5 +1,5 @@
 #include "scene.h"
-
+#include "asset_cache.h"
 #include <algorithm>
 #include <iostream>
 #include <fstream>
@@ -269,6 +269,13 @@ void SceneObject::SetBounds(const glm::vec3& center, float radius)
     m_hasBounds = true;
 }
 
+void SceneObject::SetOccluderBox(const glm::vec3& center, const glm::vec3& halfExtents)
+{
+    m_occluderCenter = center;
+    m_occluderHalfExtents = glm::abs(halfExtents);
+    m_isOccluder = true;
+}
+
 void SceneObject::SetLODLevels(std::vector<SceneObjectLOD>&& lods)
 {
     m_lodLevels = std::move(lods);
@@ -308,22 +315,33 @@ bool Scene::Initialize()
         return false;
     }
 
+    const AssetCacheStats& modelStats = ModelCache::Get().GetStats();
+    const AssetCacheStats& textureStats = TextureCache::Get().GetStats();
+    std::cout << "Cache de assets: modelos " << modelStats.hits << " acertos/" << modelStats.misses
+              << " faltas, texturas " << textureStats.hits << " acertos/" << textureStats.misses << " faltas; "
+              << (modelStats.bytesSaved + textureStats.bytesSaved) / 1024 << "KB de GPU poupados" << std::endl;
+
     ApplyBaseMaterials();
     if (!LoadSceneDefinition("assets/scenes/final_scene.json"))
     {
         return false;
     }
     BuildInstancedBatches();
+    ++m_revision;
 
     m_modelPointers.clear();
     for (auto& model : m_fishLodModels)
     {
         m_modelPointers.push_back(&model);
     }
-    m_modelPointers.push_back(&m_floorModel);
-    m_modelPointers.push_back(&m_carModel);
-    m_modelPointers.push_back(&m_pillarModel);
-    m_modelPointers.push_back(&m_sphereModel);
+    // Modelos compartilhados pelo ModelCache entram uma vez só.
+    for (Model* model : { m_floorModel.get(), m_carModel.get(), m_pillarModel.get(), m_sphereModel.get() })
+    {
+        if (std::find(m_modelPointers.begin(), m_modelPointers.end(), model) == m_modelPointers.end())
+        {
+            m_modelPointers.push_back(model);
+        }
+    }
     return true;
 }
 
@@ -348,6 +366,20 @@ void Scene::Update(float currentTime)
     }
 }
 
+bool Scene::IsDynamicObject(const SceneObject& object) const
+{
+    if (&object == m_characterObject || &object == m_carObject)
+    {
+        return true;
+    }
+    if (!object.HasPhysicsDefinition())
+    {
+        return false;
+    }
+    const SceneObjectPhysics& physics = object.GetPhysicsDefinition();
+    return physics.enabled && physics.mass > 0.0f;
+}
+
 bool Scene::LoadModels()
 {
     static const std::array<const char*, 6> kFishNodes = {
@@ -369,19 +401,7 @@ bool Scene::LoadModels()
     };
 
     const std::string fishPath = "assets/models/Fish.glb";
-    Assimp::Importer fishImporter;
-    unsigned int fishImportFlags =
-        aiProcess_Triangulate |
-        aiProcess_GenSmoothNormals |
-        aiProcess_OptimizeMeshes;
-
-    const aiScene* fishScene = fishImporter.ReadFile(fishPath, fishImportFlags);
-    if (!fishScene || fishScene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !fishScene->mRootNode)
-    {
-        std::cerr << "Falha ao carregar modelo do peixe (Fish.glb): "
-                  << fishImporter.GetErrorString() << std::endl;
-        return false;
-    }
+    const unsigned int fishImportFlags = Model::GetImportFlags(true);
 
     std::string fishDirectory;
     const size_t fishLastSlash = fishPath.find_last_of("/\\");
@@ -390,84 +410,122 @@ bool Scene::LoadModels()
         fishDirectory = fishPath.substr(0, fishLastSlash);
     }
 
+    // Um bake por LOD; o Fish.glb só é importado se algum faltar ou estiver desatualizado.
+    std::array<BakedModelKey, 6> fishKeys;
+    std::array<bool, 6> fishLodBaked{};
+    bool needsImport = false;
     for (std::size_t i = 0; i < kFishNodes.size(); ++i)
     {
-        const std::vector<std::string> identifiers{ kFishNodes[i], kFishMeshes[i] };
-        if (!m_fishLodModels[i].LoadFromScene(fishScene, fishDirectory, identifiers) || !m_fishLodModels[i].HasMeshes())
+        fishKeys[i] = BakedModelFile::MakeKey(fishPath, fishImportFlags, { kFishNodes[i], kFishMeshes[i] });
+        fishLodBaked[i] = m_fishLodModels[i].LoadFromBakedCache(fishKeys[i]);
+        needsImport = needsImport || !fishLodBaked[i];
+    }
+
+    Assimp::Importer fishImporter;
+    RecordingIOSystem* fishFiles = new RecordingIOSystem();
+    fishImporter.SetIOHandler(fishFiles);
+    const aiScene* fishScene = nullptr;
+    if (needsImport)
+    {
+        fishScene = fishImporter.ReadFile(fishPath, fishImportFlags);
+        if (!fishScene || fishScene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !fishScene->mRootNode)
         {
-            std::cerr << "Falha ao carregar LOD " << i << " do peixe (" << kFishNodes[i] << ")." << std::endl;
+            std::cerr << "Falha ao carregar modelo do peixe (Fish.glb): "
+                      << fishImporter.GetErrorString() << std::endl;
             return false;
         }
+    }
+
+    for (std::size_t i = 0; i < kFishNodes.size(); ++i)
+    {
+        if (!fishLodBaked[i])
+        {
+            const std::vector<std::string> identifiers{ kFishNodes[i], kFishMeshes[i] };
+            if (!m_fishLodModels[i].LoadFromScene(fishScene, fishDirectory, identifiers) || !m_fishLodModels[i].HasMeshes())
+            {
+                std::cerr << "Falha ao carregar LOD " << i << " do peixe (" << kFishNodes[i] << ")." << std::endl;
+                return false;
+            }
+            m_fishLodModels[i].WriteBakedCache(fishKeys[i], fishFiles->GetOpenedFiles());
+            m_fishLodModels[i].ReleaseImportData();
+        }
         RegisterModel("FishLOD" + std::to_string(i), &m_fishLodModels[i]);
     }
     RegisterModel("Fish", &m_fishLodModels[0]);
     RegisterModel("HeroFish", &m_fishLodModels[0]);
 
-    if (!m_floorModel.LoadFromFile("assets/models/cube.gltf") || !m_floorModel.HasMeshes())
+    ModelCache& models = ModelCache::Get();
+    m_floorModel = models.Load("assets/models/cube.gltf");
+    if (!m_floorModel)
     {
         std::cerr << "Falha ao carregar modelo do chão (cube.gltf)." << std::endl;
         return false;
     }
-    RegisterModel("Floor", &m_floorModel);
+    RegisterModel("Floor", m_floorModel.get());
 
-    if (!m_carModel.LoadFromFile("assets/models/car.glb") || !m_carModel.HasMeshes())
+    m_carModel = models.Load("assets/models/car.glb");
+    if (!m_carModel)
     {
         std::cerr << "Falha ao carregar modelo do carro (car.glb)." << std::endl;
         return false;
     }
-    RegisterModel("Car", &m_carModel);
+    RegisterModel("Car", m_carModel.get());
 
-    if (!m_pillarModel.LoadFromFile("assets/models/cube.gltf") || !m_pillarModel.HasMeshes())
+    m_pillarModel = models.Load("assets/models/cube.gltf");
+    if (!m_pillarModel)
     {
         std::cerr << "Falha ao carregar modelo para instancing (cube.gltf)." << std::endl;
         return false;
     }
-    RegisterModel("Pillar", &m_pillarModel);
+    RegisterModel("Pillar", m_pillarModel.get());
 
-    if (!m_sphereModel.LoadFromFile("assets/models/Sphere.glb") || !m_sphereModel.HasMeshes())
+    m_sphereModel = models.Load("assets/models/Sphere.glb");
+    if (!m_sphereModel)
     {
         std::cerr << "Falha ao carregar modelo da esfera (Sphere.glb)." << std::endl;
         return false;
     }
-    RegisterModel("Sphere", &m_sphereModel);
+    RegisterModel("Sphere", m_sphereModel.get());
 
     return true;
 }
 
 bool Scene::LoadTextures()
 {
-    if (!m_floorTexture.LoadFromFile("assets/models/CubeTexture.jpg"))
+    TextureCache& textures = TextureCache::Get();
+    m_floorTexture = textures.LoadFromFile("assets/models/CubeTexture.jpg");
+    if (!m_floorTexture)
     {
         std::cerr << "Falha ao carregar textura do chão (CubeTexture.jpg)." << std::endl;
     }
 
-    if (!m_sphereTexture.LoadFromFile("assets/texture.png"))
+    m_sphereTexture = textures.LoadFromFile("assets/texture.png");
+    if (!m_sphereTexture)
     {
         std::cerr << "Falha ao carregar textura das esferas (texture.png)." << std::endl;
     }
-
     return true;
 }
 
 void Scene::ApplyBaseMaterials()
 {
-    if (m_floorTexture.GetID() != 0)
+    if (m_floorTexture)
     {
-        m_floorModel.ApplyTextureIfMissing(&m_floorTexture);
-        m_pillarModel.ApplyTextureIfMissing(&m_floorTexture);
+        m_floorModel->ApplyTextureIfMissing(m_floorTexture.get());
+        m_pillarModel->ApplyTextureIfMissing(m_floorTexture.get());
     }
 
-    if (m_sphereTexture.GetID() != 0)
+    if (m_sphereTexture)
     {
-        m_sphereModel.ApplyTextureIfMissing(&m_sphereTexture);
+        m_sphereModel->ApplyTextureIfMissing(m_sphereTexture.get());
     }
 
-    m_sphereModel.ForEachMaterial([](Material& material) {
+    m_sphereModel->ForEachMaterial([](Material& material) {
         material.SetSpecular(glm::vec3(0.0f));
         material.SetShininess(1.0f);
     });
 
-    m_carModel.ForEachMaterial([](Material& material) {
+    m_carModel->ForEachMaterial([](Material& material) {
         material.SetSpecular(glm::vec3(0.0f));
         material.SetShininess(1.0f);
     });
@@ -510,8 +568,18 @@ bool Scene::LoadSceneDefinition(const std::string& path)
     const json lightingNode = document.value("lighting", json::object());
     m_lightingSetup.directionalLights.clear();
     m_lightingSetup.pointLights.clear();
+    m_lightingSetup.shadows = SceneShadowSettings{};
     if (lightingNode.is_object())
     {
+        if (const auto shadowsIt = lightingNode.find("shadows"); shadowsIt != lightingNode.end() && shadowsIt->is_object())
+        {
+            SceneShadowSettings& shadows = m_lightingSetup.shadows;
+            shadows.cascadeCount = shadowsIt->value("cascades", shadows.cascadeCount);
+            shadows.resolution = shadowsIt->value("resolution", shadows.resolution);
+            shadows.maxDistance = shadowsIt->value("maxDistance", shadows.maxDistance);
+            shadows.splitLambda = shadowsIt->value("splitLambda", shadows.splitLambda);
+        }
+
         if (const auto dirsIt = lightingNode.find("directional"); dirsIt != lightingNode.end() && dirsIt->is_array())
         {
             for (const auto& dirJson : *dirsIt)
@@ -619,6 +687,26 @@ bool Scene::LoadSceneDefinition(const std::string& path)
             }
         }
 
+        // "occluder": true usa a caixa do modelo; um objeto com center/halfExtents dá uma caixa simplificada
+        // em espaço local. Em ambos os casos a caixa precisa caber dentro da geometria visível.
+        if (const auto occluderIt = objectJson.find("occluder"); occluderIt != objectJson.end())
+        {
+            const glm::vec3 modelCenter = model->HasBounds() ? model->GetBoundingCenter() : glm::vec3(0.0f);
+            const glm::vec3 modelHalfExtents = model->GetBoundingHalfExtents();
+            if (occluderIt->is_boolean() && occluderIt->get<bool>())
+            {
+                created.SetOccluderBox(modelCenter, modelHalfExtents);
+            }
+            else if (occluderIt->is_object())
+            {
+                created.SetOccluderBox(ParseVec3(occluderIt->value("center", json::object()), modelCenter),
+                                       ParseVec3(occluderIt->value("halfExtents", json::object()), modelHalfExtents));
+            }
+        }
+
+        // Meshes caros que costumam ficar escondidos: a query da caixa decide no frame seguinte se eles desenham.
+        created.SetUsesOcclusionQuery(objectJson.value("occlusionQuery", false));
+
         const std::string role = objectJson.value("role", "");
         if (role == "hero")
         {
@@ -687,6 +775,7 @@ bool Scene::Reload()
         return false;
     }
     BuildInstancedBatches();
+    ++m_revision;
     return true;
 }
 
@@ -734,6 +823,16 @@ void Scene::BuildInstancedBatches()
             }
         }
 
+        batch.bounds.Resize(batch.transforms.size());
+        for (std::size_t i = 0; i < batch.transforms.size(); ++i)
+        {
+            const glm::mat4& transform = batch.transforms[i];
+            const float maxScale = std::max({ glm::length(glm::vec3(transform[0])),
+                                              glm::length(glm::vec3(transform[1])),
+                                              glm::length(glm::vec3(transform[2])) });
+            batch.bounds.Assign(i, glm::vec3(transform[3]), batch.baseRadius * maxScale);
+        }
+
         m_instancedBatches.push_back(std::move(batch));
     }
 }
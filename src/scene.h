@@ -2,6 +2,8 @@
 
 #include <vector>
 #include <array>
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <glm/glm.hpp>
@@ -9,6 +11,7 @@
 #include <glm/gtc/quaternion.hpp>
 #include <glm/gtx/euler_angles.hpp>
 
+#include "frustum.h"
 #include "material.h"
 #include "model.h"
 #include "texture.h"
@@ -40,10 +43,27 @@ struct ScenePointLightDefinition
     } orbit;
 };
 
+/// @brief Configuração das cascatas de sombra da luz direcional principal (bloco "lighting.shadows").
+struct SceneShadowSettings
+{
+    int cascadeCount = 3;
+    int resolution = 2048;
+    float maxDistance = 60.0f;
+    float splitLambda = 0.75f;
+
+    bool operator==(const SceneShadowSettings& other) const
+    {
+        return cascadeCount == other.cascadeCount && resolution == other.resolution &&
+               maxDistance == other.maxDistance && splitLambda == other.splitLambda;
+    }
+    bool operator!=(const SceneShadowSettings& other) const { return !(*this == other); }
+};
+
 struct SceneLightingSetup
 {
     std::vector<DirectionalLight> directionalLights;
     std::vector<ScenePointLightDefinition> pointLights;
+    SceneShadowSettings shadows;
 };
 
 struct SceneObjectTransform
@@ -64,6 +84,8 @@ struct SceneInstancedBatch
     Model* model = nullptr;
     std::vector<glm::mat4> transforms;
     float baseRadius = 1.0f;
+    /// Esfera de cada instância (baseRadius x maior escala), pré-calculada junto com as transforms.
+    SphereBoundsSoA bounds;
 };
 
 struct InstancedBatchConfig
@@ -135,6 +157,15 @@ public:
     void SetBounds(const glm::vec3& center, float radius);
     void SetLODLevels(std::vector<SceneObjectLOD>&& lods);
     Model* ResolveModelForDistance(float distance) const;
+    const std::vector<SceneObjectLOD>& GetLODLevels() const { return m_lodLevels; }
+    /// @brief Caixa oclusora em espaço local (bloco "occluder" do JSON), rasterizada pela oclusão por software.
+    bool IsOccluder() const { return m_isOccluder; }
+    glm::vec3 GetOccluderCenter() const { return m_occluderCenter; }
+    glm::vec3 GetOccluderHalfExtents() const { return m_occluderHalfExtents; }
+    void SetOccluderBox(const glm::vec3& center, const glm::vec3& halfExtents);
+    /// @brief "occlusionQuery" no JSON: desenho condicionado a uma query de hardware da caixa do modelo.
+    bool UsesOcclusionQuery() const { return m_usesOcclusionQuery; }
+    void SetUsesOcclusionQuery(bool enabled) { m_usesOcclusionQuery = enabled; }
 
     void ResetToBase();
     void ApplyTransform(const SceneObjectTransform& transform);
@@ -154,6 +185,10 @@ private:
     float m_boundsRadius = 1.0f;
     bool m_hasBounds = false;
     std::vector<SceneObjectLOD> m_lodLevels;
+    bool m_isOccluder = false;
+    glm::vec3 m_occluderCenter{ 0.0f };
+    glm::vec3 m_occluderHalfExtents{ 0.0f };
+    bool m_usesOcclusionQuery = false;
     SceneObjectPhysics m_physicsDefinition{};
     bool m_hasPhysicsDefinition = false;
 };
@@ -173,6 +208,10 @@ public:
     const std::vector<SceneInstancedBatch>& GetInstancedBatches() const { return m_instancedBatches; }
     const SceneCameraSettings& GetCameraSettings() const { return m_cameraSettings; }
     const SceneLightingSetup& GetLightingSetup() const { return m_lightingSetup; }
+    /// @brief Incrementada a cada Initialize/Reload; invalida caches derivados da cena.
+    std::uint64_t GetRevision() const { return m_revision; }
+    /// @brief true para objetos que se movem em runtime (personagem, carro e corpos físicos dinâmicos).
+    bool IsDynamicObject(const SceneObject& object) const;
 
 private:
     bool LoadModels();
@@ -184,15 +223,17 @@ private:
     void RegisterModel(const std::string& key, Model* model);
 
     std::array<Model, 6> m_fishLodModels;
-    Model m_floorModel;
-    Model m_carModel;
-    Model m_pillarModel;
-    Model m_sphereModel;
+    /// Vêm do ModelCache: chão e pilares usam o mesmo cube.gltf e dividem o Model.
+    std::shared_ptr<Model> m_floorModel;
+    std::shared_ptr<Model> m_carModel;
+    std::shared_ptr<Model> m_pillarModel;
+    std::shared_ptr<Model> m_sphereModel;
 
-    Texture m_floorTexture;
-    Texture m_sphereTexture;
+    std::shared_ptr<Texture> m_floorTexture;
+    std::shared_ptr<Texture> m_sphereTexture;
 
     std::vector<SceneObject> m_objects;
+    std::uint64_t m_revision = 0;
     std::vector<SceneInstancedBatch> m_instancedBatches;
     SceneObject* m_characterObject = nullptr;
     SceneObject* m_carObject = nullptr;
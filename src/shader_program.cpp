@@ -0,0 +1,266 @@
+#include "shader_program.h"
+
+#include "render_state.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <utility>
+
+namespace
+{
+bool LoadShaderFile(const std::string& path, std::string& source)
+{
+    std::ifstream file(path);
+    if (!file.is_open())
+    {
+        std::cerr << "Erro ao abrir arquivo shader: " << path << std::endl;
+        return false;
+    }
+
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    source = buffer.str();
+    return true;
+}
+
+/// A diretiva #version precisa ser a primeira do arquivo: os defines entram na linha seguinte.
+std::string InjectDefines(const std::string& source, const std::string& defines)
+{
+    if (defines.empty())
+    {
+        return source;
+    }
+    const std::size_t versionPos = source.find("#version");
+    if (versionPos == std::string::npos)
+    {
+        return defines + source;
+    }
+    const std::size_t lineEnd = source.find('\n', versionPos);
+    if (lineEnd == std::string::npos)
+    {
+        return source + "\n" + defines;
+    }
+    return source.substr(0, lineEnd + 1) + defines + source.substr(lineEnd + 1);
+}
+
+GLuint CompileShaderSource(const std::string& source, GLenum type, const std::string& label)
+{
+    GLuint shader = glCreateShader(type);
+    const char* sourcePtr = source.c_str();
+    glShaderSource(shader, 1, &sourcePtr, nullptr);
+    glCompileShader(shader);
+
+    GLint success = 0;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success)
+    {
+        char infoLog[512];
+        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+        std::cerr << "Erro ao compilar shader " << label << ": " << infoLog << std::endl;
+        glDeleteShader(shader);
+        return 0;
+    }
+
+    return shader;
+}
+
+GLuint LoadAndCompileShader(const std::string& path, GLenum type)
+{
+    std::string source;
+    if (!LoadShaderFile(path, source))
+    {
+        return 0;
+    }
+    return CompileShaderSource(source, type, path);
+}
+
+/// Linka e descarta os shaders (já copiados para o programa); zeros são ignorados. Retorna 0 em caso de erro.
+GLuint LinkProgram(GLuint vertexShader, GLuint fragmentShader, GLuint geometryShader)
+{
+    const GLuint shaders[] = { vertexShader, fragmentShader, geometryShader };
+    GLuint program = glCreateProgram();
+    for (GLuint shader : shaders)
+    {
+        if (shader != 0)
+        {
+            glAttachShader(program, shader);
+        }
+    }
+    glLinkProgram(program);
+
+    for (GLuint shader : shaders)
+    {
+        if (shader != 0)
+        {
+            glDeleteShader(shader);
+        }
+    }
+
+    GLint success = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        char infoLog[512];
+        glGetProgramInfoLog(program, 512, nullptr, infoLog);
+        std::cerr << "Erro ao linkar programa shader: " << infoLog << std::endl;
+        RenderStateCache::Get().DeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+}
+
+bool ShaderProgram::Create(const std::string& vertexPath,
+                           const std::string& fragmentPath,
+                           const std::string& geometryPath)
+{
+    GLuint vertexShader = LoadAndCompileShader(vertexPath, GL_VERTEX_SHADER);
+    if (vertexShader == 0)
+    {
+        return false;
+    }
+
+    GLuint fragmentShader = LoadAndCompileShader(fragmentPath, GL_FRAGMENT_SHADER);
+    if (fragmentShader == 0)
+    {
+        glDeleteShader(vertexShader);
+        return false;
+    }
+
+    GLuint geometryShader = 0;
+    if (!geometryPath.empty())
+    {
+        geometryShader = LoadAndCompileShader(geometryPath, GL_GEOMETRY_SHADER);
+        if (geometryShader == 0)
+        {
+            glDeleteShader(vertexShader);
+            glDeleteShader(fragmentShader);
+            return false;
+        }
+    }
+
+    Destroy();
+    program = LinkProgram(vertexShader, fragmentShader, geometryShader);
+    return program != 0;
+}
+
+bool ShaderProgram::CreateFromSources(const std::string& vertexSource,
+                                      const std::string& fragmentSource,
+                                      const std::string& defines,
+                                      const std::string& label)
+{
+    GLuint vertexShader = CompileShaderSource(InjectDefines(vertexSource, defines), GL_VERTEX_SHADER, label + " (vertex)");
+    if (vertexShader == 0)
+    {
+        return false;
+    }
+
+    GLuint fragmentShader =
+        CompileShaderSource(InjectDefines(fragmentSource, defines), GL_FRAGMENT_SHADER, label + " (fragment)");
+    if (fragmentShader == 0)
+    {
+        glDeleteShader(vertexShader);
+        return false;
+    }
+
+    Destroy();
+    program = LinkProgram(vertexShader, fragmentShader, 0);
+    return program != 0;
+}
+
+bool ShaderProgram::CreateCompute(const std::string& computePath)
+{
+    GLuint computeShader = LoadAndCompileShader(computePath, GL_COMPUTE_SHADER);
+    if (computeShader == 0)
+    {
+        return false;
+    }
+
+    Destroy();
+    program = LinkProgram(computeShader, 0, 0);
+    return program != 0;
+}
+
+void ShaderProgram::Use() const
+{
+    RenderStateCache::Get().UseProgram(program);
+}
+
+void ShaderProgram::Destroy()
+{
+    if (program != 0)
+    {
+        RenderStateCache::Get().DeleteProgram(program);
+        program = 0;
+    }
+}
+
+ShaderVariantCache::~ShaderVariantCache()
+{
+    Destroy();
+}
+
+bool ShaderVariantCache::Initialize(const std::string& vertexPath,
+                                    const std::string& fragmentPath,
+                                    DefineBuilder defineBuilder,
+                                    ProgramSetup setup)
+{
+    Destroy();
+    if (!LoadShaderFile(vertexPath, m_vertexSource) || !LoadShaderFile(fragmentPath, m_fragmentSource))
+    {
+        return false;
+    }
+    m_vertexPath = vertexPath;
+    m_defineBuilder = std::move(defineBuilder);
+    m_setup = std::move(setup);
+    return true;
+}
+
+void ShaderVariantCache::Destroy()
+{
+    for (auto& entry : m_variants)
+    {
+        entry.second.shader.Destroy();
+    }
+    m_variants.clear();
+    m_failedKeys.clear();
+}
+
+const ShaderVariant* ShaderVariantCache::Get(ShaderVariantKey key)
+{
+    const auto it = m_variants.find(key);
+    if (it != m_variants.end())
+    {
+        return &it->second;
+    }
+    if (m_vertexSource.empty() || m_failedKeys.count(key) != 0)
+    {
+        return nullptr;
+    }
+
+    const std::string defines = m_defineBuilder ? m_defineBuilder(key) : std::string();
+    std::ostringstream label;
+    label << m_vertexPath << " [variante 0x" << std::hex << key << "]";
+
+    ShaderVariant variant;
+    if (!variant.shader.CreateFromSources(m_vertexSource, m_fragmentSource, defines, label.str()))
+    {
+        m_failedKeys[key] = true;
+        return nullptr;
+    }
+
+    // Preserva o programa corrente: variantes podem ser criadas no meio de uma passada.
+    RenderStateCache& state = RenderStateCache::Get();
+    const GLuint previousProgram = state.GetProgram();
+    variant.shader.Use();
+    variant.modelLocation = glGetUniformLocation(variant.shader.program, "model");
+    variant.normalMatrixLocation = glGetUniformLocation(variant.shader.program, "normalMatrix");
+    if (m_setup)
+    {
+        m_setup(variant.shader.program);
+    }
+    state.UseProgram(previousProgram);
+
+    return &m_variants.emplace(key, variant).first->second;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+
+struct ShaderProgram
+{
+    GLuint program = 0;
+
+    bool Create(const std::string& vertexPath,
+                const std::string& fragmentPath,
+                const std::string& geometryPath = "");
+    /// @brief Compila a partir do código já carregado; defines são inseridos logo após a linha #version.
+    bool CreateFromSources(const std::string& vertexSource,
+                           const std::string& fragmentSource,
+                           const std::string& defines,
+                           const std::string& label);
+    /// @brief Programa de compute (GL 4.3) com um único estágio.
+    bool CreateCompute(const std::string& computePath);
+    void Use() const;
+    void Destroy();
+};
+
+using ShaderVariantKey = std::uint32_t;
+
+/// @brief Programa especializado de um par vertex/fragment e as localizações dos uniforms "model" e "normalMatrix".
+struct ShaderVariant
+{
+    ShaderProgram shader;
+    GLint modelLocation = -1;
+    GLint normalMatrixLocation = -1;
+};
+
+/// @brief Cache de permutações de um shader: cada chave vira um bloco de #defines e o programa é compilado
+/// na primeira vez que a chave é pedida. Falhas também ficam em cache para não recompilar a cada frame.
+class ShaderVariantCache
+{
+public:
+    using DefineBuilder = std::function<std::string(ShaderVariantKey)>;
+    using ProgramSetup = std::function<void(GLuint program)>;
+
+    ShaderVariantCache() = default;
+    ~ShaderVariantCache();
+
+    ShaderVariantCache(const ShaderVariantCache&) = delete;
+    ShaderVariantCache& operator=(const ShaderVariantCache&) = delete;
+
+    /// @brief Lê os arquivos uma vez. setup roda com o programa ativo logo após cada link
+    /// (bind de uniform blocks, unidades de sampler).
+    bool Initialize(const std::string& vertexPath,
+                    const std::string& fragmentPath,
+                    DefineBuilder defineBuilder,
+                    ProgramSetup setup);
+    void Destroy();
+
+    /// @brief Variante da chave, compilada sob demanda; nullptr se a compilação falhou.
+    const ShaderVariant* Get(ShaderVariantKey key);
+
+    std::size_t GetCompiledCount() const { return m_variants.size(); }
+
+private:
+    std::string m_vertexPath;
+    std::string m_vertexSource;
+    std::string m_fragmentSource;
+    DefineBuilder m_defineBuilder;
+    ProgramSetup m_setup;
+    std::unordered_map<ShaderVariantKey, ShaderVariant> m_variants;
+    std::unordered_map<ShaderVariantKey, bool> m_failedKeys;
+};
@@ -0,0 +1,125 @@
+#include "software_occlusion.h"
+
+#include "scene.h"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+SoftwareOcclusionCuller::~SoftwareOcclusionCuller()
+{
+    WaitForResults();
+}
+
+void SoftwareOcclusionCuller::BeginCull(const Scene& scene, const glm::mat4& viewProjection)
+{
+    WaitForResults();
+    m_hasResults = false;
+    m_viewProjection = viewProjection;
+    m_job = std::async(std::launch::async, [this, &scene]() { CullScene(scene); });
+}
+
+void SoftwareOcclusionCuller::WaitForResults()
+{
+    if (m_job.valid())
+    {
+        m_job.get();
+        m_hasResults = true;
+    }
+}
+
+bool SoftwareOcclusionCuller::IsObjectVisible(std::size_t objectIndex) const
+{
+    return !m_hasResults || objectIndex >= m_objectVisible.size() || m_objectVisible[objectIndex] != 0;
+}
+
+bool SoftwareOcclusionCuller::IsInstanceClusterVisible(std::size_t batchIndex, std::size_t clusterIndex) const
+{
+    if (!m_hasResults || batchIndex >= m_clusterVisible.size())
+    {
+        return true;
+    }
+    const std::vector<std::uint8_t>& clusters = m_clusterVisible[batchIndex];
+    return clusterIndex >= clusters.size() || clusters[clusterIndex] != 0;
+}
+
+void SoftwareOcclusionCuller::CullScene(const Scene& scene)
+{
+    const auto startTime = std::chrono::steady_clock::now();
+    m_stats = {};
+    m_depthBuffer.Clear(m_viewProjection);
+
+    const auto& objects = scene.GetObjects();
+    for (const auto& object : objects)
+    {
+        if (object.IsOccluder() && object.GetModel() != nullptr)
+        {
+            m_depthBuffer.RasterizeBox(object.GetModelMatrix(), object.GetOccluderCenter(), object.GetOccluderHalfExtents());
+            ++m_stats.occluders;
+        }
+    }
+    m_stats.triangles = m_depthBuffer.GetTriangleCount();
+
+    const auto& batches = scene.GetInstancedBatches();
+    m_objectVisible.assign(objects.size(), 1);
+    m_clusterVisible.resize(batches.size());
+    for (std::size_t batchIndex = 0; batchIndex < batches.size(); ++batchIndex)
+    {
+        const std::size_t clusterCount =
+            (batches[batchIndex].transforms.size() + kInstanceClusterSize - 1) / kInstanceClusterSize;
+        m_clusterVisible[batchIndex].assign(clusterCount, 1);
+    }
+    if (m_stats.occluders == 0)
+    {
+        m_stats.cullMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+        return;
+    }
+
+    for (std::size_t i = 0; i < objects.size(); ++i)
+    {
+        const SceneObject& object = objects[i];
+        const Model* model = object.GetModel();
+        if (model == nullptr)
+        {
+            continue;
+        }
+        // Caixa do modelo quando conhecida; senão o cubo que envolve a esfera local.
+        const glm::vec3 halfExtents =
+            model->HasBounds() ? model->GetBoundingHalfExtents() : glm::vec3(object.GetLocalBoundsRadius());
+        ++m_stats.tested;
+        if (!m_depthBuffer.IsBoxVisible(object.GetModelMatrix(), object.GetLocalBoundsCenter(), halfExtents))
+        {
+            m_objectVisible[i] = 0;
+            ++m_stats.culled;
+        }
+    }
+
+    const glm::mat4 identity(1.0f);
+    for (std::size_t batchIndex = 0; batchIndex < batches.size(); ++batchIndex)
+    {
+        const SceneInstancedBatch& batch = batches[batchIndex];
+        std::vector<std::uint8_t>& clusters = m_clusterVisible[batchIndex];
+        for (std::size_t cluster = 0; cluster < clusters.size(); ++cluster)
+        {
+            const std::size_t first = cluster * kInstanceClusterSize;
+            const std::size_t last = std::min(first + kInstanceClusterSize, batch.transforms.size());
+            glm::vec3 boundsMin(std::numeric_limits<float>::max());
+            glm::vec3 boundsMax(-std::numeric_limits<float>::max());
+            for (std::size_t i = first; i < last; ++i)
+            {
+                const glm::vec3 instanceCenter = batch.bounds.GetCenter(i);
+                const glm::vec3 reach(batch.bounds.radius[i]);
+                boundsMin = glm::min(boundsMin, instanceCenter - reach);
+                boundsMax = glm::max(boundsMax, instanceCenter + reach);
+            }
+            ++m_stats.tested;
+            if (!m_depthBuffer.IsBoxVisible(identity, (boundsMin + boundsMax) * 0.5f, (boundsMax - boundsMin) * 0.5f))
+            {
+                clusters[cluster] = 0;
+                ++m_stats.culled;
+            }
+        }
+    }
+
+    m_stats.cullMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include "occlusion_rasterizer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <vector>
+
+class Scene;
+
+struct SoftwareOcclusionStats
+{
+    std::size_t occluders = 0;
+    std::size_t triangles = 0; ///< Triângulos rasterizados após o recorte no near plane.
+    std::size_t tested = 0;    ///< Caixas de objetos + clusters de instâncias testados.
+    std::size_t culled = 0;
+    double cullMs = 0.0;
+};
+
+/// @brief Oclusão por software: as caixas oclusoras da cena ("occluder" no JSON) são rasterizadas numa
+/// OcclusionDepthBuffer e as caixas dos objetos e dos clusters de instâncias são testadas contra ela.
+/// Não toca no GL: BeginCull roda numa thread de trabalho enquanto o main thread envia as passadas de sombra.
+class SoftwareOcclusionCuller
+{
+public:
+    /// Instâncias consecutivas de um batch testadas juntas por uma AABB comum.
+    static constexpr std::size_t kInstanceClusterSize = 16;
+
+    SoftwareOcclusionCuller() = default;
+    ~SoftwareOcclusionCuller();
+
+    SoftwareOcclusionCuller(const SoftwareOcclusionCuller&) = delete;
+    SoftwareOcclusionCuller& operator=(const SoftwareOcclusionCuller&) = delete;
+
+    /// @brief Agenda numa thread de trabalho a rasterização das oclusoras e o teste de objetos e clusters.
+    /// A cena não pode ser alterada até WaitForResults.
+    void BeginCull(const Scene& scene, const glm::mat4& viewProjection);
+    void WaitForResults();
+    /// @brief true se o último BeginCull terminou; índices fora dos resultados contam como visíveis.
+    bool HasResults() const { return m_hasResults; }
+    bool IsObjectVisible(std::size_t objectIndex) const;
+    bool IsInstanceClusterVisible(std::size_t batchIndex, std::size_t clusterIndex) const;
+    const OcclusionDepthBuffer& GetDepthBuffer() const { return m_depthBuffer; }
+    const SoftwareOcclusionStats& GetStats() const { return m_stats; }
+
+private:
+    void CullScene(const Scene& scene);
+
+    OcclusionDepthBuffer m_depthBuffer;
+    glm::mat4 m_viewProjection{ 1.0f };
+    std::future<void> m_job;
+    bool m_hasResults = false;
+    std::vector<std::uint8_t> m_objectVisible;
+    std::vector<std::vector<std::uint8_t>> m_clusterVisible;
+    SoftwareOcclusionStats m_stats{};
+};
@@ -0,0 +1,111 @@
+#include "static_instance_buffer.h"
+
+#include "render_state.h"
+#include "scene.h"
+
+#include <iostream>
+
+namespace
+{
+constexpr std::size_t kTexelsPerMatrix = 4;
+}
+
+StaticInstanceBuffer::~StaticInstanceBuffer()
+{
+    Destroy();
+}
+
+bool StaticInstanceBuffer::Create()
+{
+    Destroy();
+    if (glTexBuffer == nullptr)
+    {
+        std::cerr << "Texture buffers indisponíveis; instâncias voltam a enviar matrizes por frame." << std::endl;
+        return false;
+    }
+
+    glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &m_maxTexels);
+    RenderStateCache& state = RenderStateCache::Get();
+    glGenBuffers(1, &m_buffer);
+    glGenTextures(1, &m_texture);
+    if (m_buffer == 0 || m_texture == 0)
+    {
+        std::cerr << "Falha ao criar o buffer estático de instâncias." << std::endl;
+        Destroy();
+        return false;
+    }
+    state.BindBuffer(GL_TEXTURE_BUFFER, m_buffer);
+    glBufferData(GL_TEXTURE_BUFFER, 16, nullptr, GL_STATIC_DRAW);
+    state.BindTexture(GL_TEXTURE_BUFFER, m_texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, m_buffer);
+    return true;
+}
+
+void StaticInstanceBuffer::Destroy()
+{
+    RenderStateCache& state = RenderStateCache::Get();
+    state.DeleteTexture(m_texture);
+    state.DeleteBuffer(m_buffer);
+    m_texture = 0;
+    m_buffer = 0;
+    m_built = false;
+    m_ready = false;
+    m_firstIndices.clear();
+    m_residentBytes = 0;
+}
+
+bool StaticInstanceBuffer::Prepare(const Scene& scene)
+{
+    if (m_buffer == 0)
+    {
+        return false;
+    }
+    if (m_built && scene.GetRevision() == m_sceneRevision)
+    {
+        return m_ready;
+    }
+    m_built = true;
+    m_sceneRevision = scene.GetRevision();
+
+    const auto& batches = scene.GetInstancedBatches();
+    m_firstIndices.assign(batches.size(), 0);
+    std::size_t matrixCount = 0;
+    for (std::size_t i = 0; i < batches.size(); ++i)
+    {
+        m_firstIndices[i] = static_cast<std::uint32_t>(matrixCount);
+        matrixCount += batches[i].transforms.size();
+    }
+    m_ready = matrixCount > 0 && matrixCount * kTexelsPerMatrix <= static_cast<std::size_t>(m_maxTexels);
+    if (!m_ready)
+    {
+        if (matrixCount > 0)
+        {
+            std::cerr << matrixCount << " instâncias excedem o texture buffer (" << m_maxTexels
+                      << " texels); matrizes seguem enviadas por frame." << std::endl;
+        }
+        m_residentBytes = 0;
+        return false;
+    }
+
+    // Mesmo layout da lista de batches: a primeira matriz de cada um fica em m_firstIndices.
+    m_residentBytes = matrixCount * sizeof(glm::mat4);
+    RenderStateCache::Get().BindBuffer(GL_TEXTURE_BUFFER, m_buffer);
+    glBufferData(GL_TEXTURE_BUFFER, static_cast<GLsizeiptr>(m_residentBytes), nullptr, GL_STATIC_DRAW);
+    for (std::size_t i = 0; i < batches.size(); ++i)
+    {
+        if (batches[i].transforms.empty())
+        {
+            continue;
+        }
+        glBufferSubData(GL_TEXTURE_BUFFER,
+                        static_cast<GLintptr>(m_firstIndices[i] * sizeof(glm::mat4)),
+                        static_cast<GLsizeiptr>(batches[i].transforms.size() * sizeof(glm::mat4)),
+                        batches[i].transforms.data());
+    }
+    return true;
+}
+
+void StaticInstanceBuffer::Bind() const
+{
+    RenderStateCache::Get().BindTextureUnit(GL_TEXTURE0 + kTextureUnit, GL_TEXTURE_BUFFER, m_texture);
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Scene;
+
+/// @brief Matrizes de todos os batches instanciados num único buffer estático, lido pelo vertex shader como
+/// texture buffer (RGBA32F, quatro texels por matriz). Só é reenviado quando a cena muda de revisão; a cada
+/// passada sobe apenas a lista compacta de índices visíveis (4 bytes por instância em vez de 64).
+class StaticInstanceBuffer
+{
+public:
+    /// Unidade do sampler instanceTransforms (depois das três dos clusters de luz).
+    static constexpr GLint kTextureUnit = 6;
+
+    StaticInstanceBuffer() = default;
+    ~StaticInstanceBuffer();
+
+    StaticInstanceBuffer(const StaticInstanceBuffer&) = delete;
+    StaticInstanceBuffer& operator=(const StaticInstanceBuffer&) = delete;
+
+    bool Create();
+    void Destroy();
+
+    /// @brief Reempacota as matrizes se a revisão da cena mudou. false se não há instâncias ou se elas
+    /// não cabem em GL_MAX_TEXTURE_BUFFER_SIZE (o chamador volta a enviar as matrizes por frame).
+    bool Prepare(const Scene& scene);
+    void Bind() const;
+
+    bool IsReady() const { return m_ready; }
+    /// @brief Índice da primeira matriz do batch no buffer: somado aos índices locais das instâncias.
+    std::uint32_t GetFirstIndex(std::size_t batchIndex) const { return m_firstIndices[batchIndex]; }
+    std::size_t GetResidentBytes() const { return m_residentBytes; }
+
+private:
+    GLuint m_buffer = 0;
+    GLuint m_texture = 0;
+    GLint m_maxTexels = 0;
+    bool m_built = false;
+    bool m_ready = false;
+    std::uint64_t m_sceneRevision = 0;
+    std::vector<std::uint32_t> m_firstIndices;
+    std::size_t m_residentBytes = 0;
+};
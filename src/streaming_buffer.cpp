@@ -0,0 +1,237 @@
+#include "streaming_buffer.h"
+
+#include "render_state.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace
+{
+constexpr GLsizeiptr kCapacityGranularity = 256;
+constexpr GLuint64 kFenceTimeoutNs = 1000000000ull;
+
+GLsizeiptr AlignUp(GLsizeiptr value, GLsizeiptr alignment)
+{
+    if (alignment <= 1)
+    {
+        return value;
+    }
+    return ((value + alignment - 1) / alignment) * alignment;
+}
+
+bool SupportsPersistentMapping()
+{
+    // Ponteiros só são carregados pelo glad quando a versão/extensão existe no contexto.
+    return glBufferStorage != nullptr && glFenceSync != nullptr && glClientWaitSync != nullptr &&
+           glDeleteSync != nullptr;
+}
+}
+
+StreamingBuffer::~StreamingBuffer()
+{
+    Destroy();
+}
+
+bool StreamingBuffer::Create(GLsizeiptr frameCapacity)
+{
+    Destroy();
+    return Allocate(std::max(frameCapacity, kCapacityGranularity));
+}
+
+void StreamingBuffer::Destroy()
+{
+    Release();
+    m_frameCapacity = 0;
+    m_cursor = 0;
+    m_region = 0;
+}
+
+bool StreamingBuffer::Allocate(GLsizeiptr frameCapacity)
+{
+    m_frameCapacity = AlignUp(frameCapacity, kCapacityGranularity);
+    m_cursor = 0;
+    m_region = 0;
+
+    glGenBuffers(1, &m_buffer);
+    if (m_buffer == 0)
+    {
+        std::cerr << "Falha ao criar buffer de streaming." << std::endl;
+        return false;
+    }
+    RenderStateCache::Get().BindBuffer(GL_ARRAY_BUFFER, m_buffer);
+
+    m_persistent = false;
+    if (SupportsPersistentMapping())
+    {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        const GLsizeiptr totalSize = m_frameCapacity * kFramesInFlight;
+        glBufferStorage(GL_ARRAY_BUFFER, totalSize, nullptr, flags);
+        m_mapped = static_cast<unsigned char*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, totalSize, flags));
+        if (m_mapped != nullptr)
+        {
+            m_persistent = true;
+        }
+        else
+        {
+            // Storage imutável não aceita glBufferData: recomeça com um buffer novo para o fallback.
+            std::cerr << "Mapeamento persistente indisponível; usando orphaning no buffer de streaming." << std::endl;
+            RenderStateCache::Get().DeleteBuffer(m_buffer);
+            glGenBuffers(1, &m_buffer);
+            RenderStateCache::Get().BindBuffer(GL_ARRAY_BUFFER, m_buffer);
+        }
+    }
+
+    if (!m_persistent)
+    {
+        glBufferData(GL_ARRAY_BUFFER, m_frameCapacity, nullptr, GL_STREAM_DRAW);
+    }
+    return true;
+}
+
+void StreamingBuffer::Release()
+{
+    for (GLsync& fence : m_fences)
+    {
+        if (fence != nullptr)
+        {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+
+    if (m_buffer != 0)
+    {
+        if (m_mapped != nullptr)
+        {
+            RenderStateCache::Get().BindBuffer(GL_ARRAY_BUFFER, m_buffer);
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+            m_mapped = nullptr;
+        }
+        RenderStateCache::Get().DeleteBuffer(m_buffer);
+        m_buffer = 0;
+    }
+    m_persistent = false;
+}
+
+void StreamingBuffer::BeginFrame()
+{
+    if (m_buffer == 0)
+    {
+        return;
+    }
+
+    m_cursor = 0;
+    if (m_persistent)
+    {
+        m_region = (m_region + 1) % kFramesInFlight;
+        WaitForRegion(m_region);
+        return;
+    }
+
+    RenderStateCache::Get().BindBuffer(GL_ARRAY_BUFFER, m_buffer);
+    glBufferData(GL_ARRAY_BUFFER, m_frameCapacity, nullptr, GL_STREAM_DRAW);
+    ++m_stats.orphans;
+}
+
+void StreamingBuffer::EndFrame()
+{
+    if (!m_persistent)
+    {
+        return;
+    }
+
+    GLsync& fence = m_fences[m_region];
+    if (fence != nullptr)
+    {
+        glDeleteSync(fence);
+    }
+    fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void StreamingBuffer::WaitForRegion(int region)
+{
+    GLsync& fence = m_fences[region];
+    if (fence == nullptr)
+    {
+        return;
+    }
+
+    GLenum status = glClientWaitSync(fence, 0, 0);
+    if (status == GL_TIMEOUT_EXPIRED)
+    {
+        ++m_stats.fenceWaits;
+        do
+        {
+            status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, kFenceTimeoutNs);
+        } while (status == GL_TIMEOUT_EXPIRED);
+    }
+    if (status == GL_WAIT_FAILED)
+    {
+        std::cerr << "glClientWaitSync falhou no buffer de streaming." << std::endl;
+    }
+
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+GLintptr StreamingBuffer::Upload(const void* data, GLsizeiptr size, GLsizeiptr alignment)
+{
+    if (m_buffer == 0 || data == nullptr || size <= 0)
+    {
+        return -1;
+    }
+
+    GLsizeiptr offset = AlignUp(m_cursor, alignment);
+    if (offset + size > m_frameCapacity)
+    {
+        if (!m_persistent && size <= m_frameCapacity)
+        {
+            // Sem storage persistente basta um novo orphan: draws anteriores seguem com o storage antigo.
+            RenderStateCache::Get().BindBuffer(GL_ARRAY_BUFFER, m_buffer);
+            glBufferData(GL_ARRAY_BUFFER, m_frameCapacity, nullptr, GL_STREAM_DRAW);
+            ++m_stats.orphans;
+        }
+        else
+        {
+            // O driver mantém o buffer antigo vivo até os draws já enviados terminarem.
+            const GLsizeiptr newCapacity = std::max(m_frameCapacity * 2, AlignUp(size, kCapacityGranularity));
+            Release();
+            if (!Allocate(newCapacity))
+            {
+                return -1;
+            }
+            ++m_stats.growths;
+        }
+        offset = 0;
+    }
+
+    GLintptr bufferOffset = static_cast<GLintptr>(offset);
+    if (m_persistent)
+    {
+        bufferOffset += static_cast<GLintptr>(m_region) * static_cast<GLintptr>(m_frameCapacity);
+        std::memcpy(m_mapped + bufferOffset, data, static_cast<std::size_t>(size));
+    }
+    else
+    {
+        RenderStateCache::Get().BindBuffer(GL_ARRAY_BUFFER, m_buffer);
+        void* target = glMapBufferRange(GL_ARRAY_BUFFER,
+                                        bufferOffset,
+                                        size,
+                                        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        if (target != nullptr)
+        {
+            std::memcpy(target, data, static_cast<std::size_t>(size));
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+        }
+        else
+        {
+            glBufferSubData(GL_ARRAY_BUFFER, bufferOffset, size, data);
+        }
+    }
+
+    m_cursor = offset + size;
+    m_stats.bytesUploaded += static_cast<std::size_t>(size);
+    ++m_stats.allocations;
+    return bufferOffset;
+}
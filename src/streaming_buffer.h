@@ -0,0 +1,62 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <array>
+#include <cstddef>
+
+struct StreamingBufferStats
+{
+    std::size_t bytesUploaded = 0;
+    std::size_t allocations = 0;
+    std::size_t fenceWaits = 0;
+    std::size_t orphans = 0;
+    std::size_t growths = 0;
+};
+
+/// @brief Ring buffer para dados que mudam a cada frame (ex.: matrizes de instância).
+/// Com ARB_buffer_storage usa mapeamento persistente dividido em kFramesInFlight regiões protegidas
+/// por fences; no GL 3.3 puro recorre a orphaning + glMapBufferRange não sincronizado.
+class StreamingBuffer
+{
+public:
+    static constexpr int kFramesInFlight = 3;
+
+    StreamingBuffer() = default;
+    ~StreamingBuffer();
+
+    StreamingBuffer(const StreamingBuffer&) = delete;
+    StreamingBuffer& operator=(const StreamingBuffer&) = delete;
+
+    bool Create(GLsizeiptr frameCapacity);
+    void Destroy();
+
+    /// @brief Avança para a próxima região, esperando a GPU liberá-la se necessário.
+    void BeginFrame();
+    /// @brief Insere a fence da região escrita neste frame.
+    void EndFrame();
+
+    /// @brief Copia size bytes para o buffer e retorna o offset em bytes (múltiplo de alignment), ou -1.
+    /// Se a região do frame estourar o buffer é recriado maior: use o offset antes da próxima chamada.
+    GLintptr Upload(const void* data, GLsizeiptr size, GLsizeiptr alignment);
+
+    GLuint GetID() const { return m_buffer; }
+    bool IsValid() const { return m_buffer != 0; }
+    bool IsPersistent() const { return m_persistent; }
+    const StreamingBufferStats& GetStats() const { return m_stats; }
+    void ResetStats() { m_stats = {}; }
+
+private:
+    bool Allocate(GLsizeiptr frameCapacity);
+    void Release();
+    void WaitForRegion(int region);
+
+    GLuint m_buffer = 0;
+    bool m_persistent = false;
+    unsigned char* m_mapped = nullptr;
+    GLsizeiptr m_frameCapacity = 0;
+    GLsizeiptr m_cursor = 0;
+    int m_region = 0;
+    std::array<GLsync, kFramesInFlight> m_fences{};
+    StreamingBufferStats m_stats{};
+};
@@ -1,4 +1,5 @@
 #include "texture.h"
+#include "render_state.h"
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 #include <iostream>
@@ -110,17 +111,14 @@ void Texture::Bind(GLenum textureUnit) const
         return;
     }
 
-    // Ativa a unidade de textura
-    glActiveTexture(textureUnit);
-
-    // Vincula a textura
-    glBindTexture(GL_TEXTURE_2D, m_textureID);
+    // Ativa a unidade e vincula; nada é enviado se a textura já estiver nessa unidade
+    RenderStateCache::Get().BindTextureUnit(textureUnit, GL_TEXTURE_2D, m_textureID);
 }
 
 /// @brief Desvincula a textura
 void Texture::Unbind() const
 {
-    glBindTexture(GL_TEXTURE_2D, 0);
+    RenderStateCache::Get().BindTexture(GL_TEXTURE_2D, 0);
 }
 
 /// @brief Define os parâmetros de wrapping (repetição) da textura
@@ -157,7 +155,7 @@ void Texture::SetFiltering(GLenum minFilter, GLenum magFilter)
 void Texture::Cleanup()
 {
     if (m_textureID != 0) {
-        glDeleteTextures(1, &m_textureID);
+        RenderStateCache::Get().DeleteTexture(m_textureID);
         m_textureID = 0;
         m_width = 0;
         m_height = 0;
@@ -186,11 +184,10 @@ bool Texture::UploadToGPU(const unsigned char* data, int width, int height, int
     m_channels = channels;
 
     glGenTextures(1, &m_textureID);
-    glBindTexture(GL_TEXTURE_2D, m_textureID);
+    RenderStateCache::Get().BindTexture(GL_TEXTURE_2D, m_textureID);
     SetWrapping(GL_REPEAT, GL_REPEAT);
     SetFiltering(GL_LINEAR, GL_LINEAR);
     glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
     glGenerateMipmap(GL_TEXTURE_2D);
-    glBindTexture(GL_TEXTURE_2D, 0);
     return true;
 }
@@ -54,6 +54,10 @@ public:
     /// @return Altura em pixels
     int GetHeight() const { return m_height; }
 
+    /// @brief Obtém o número de canais de cor
+    /// @return Canais (RGB=3, RGBA=4)
+    int GetChannels() const { return m_channels; }
+
 private:
     GLuint m_textureID;  ///< ID OpenGL da textura
     int m_width;         ///< Largura da textura em pixels
@@ -0,0 +1,116 @@
+#include "uniform_buffer.h"
+
+#include "render_state.h"
+
+#include <cstring>
+#include <iostream>
+
+UniformBuffer::~UniformBuffer()
+{
+    Destroy();
+}
+
+bool UniformBuffer::Create(GLsizeiptr size, UniformBlockBinding binding)
+{
+    Destroy();
+    if (size <= 0)
+    {
+        return false;
+    }
+
+    glGenBuffers(1, &m_buffer);
+    if (m_buffer == 0)
+    {
+        std::cerr << "Falha ao criar uniform buffer." << std::endl;
+        return false;
+    }
+
+    RenderStateCache::Get().BindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+    glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+
+    m_binding = static_cast<GLuint>(binding);
+    m_shadowCopy.assign(static_cast<std::size_t>(size), 0);
+    m_hasContents = false;
+    m_uploadCount = 0;
+    return true;
+}
+
+void UniformBuffer::Destroy()
+{
+    if (m_buffer != 0)
+    {
+        RenderStateCache::Get().DeleteBuffer(m_buffer);
+        m_buffer = 0;
+    }
+    m_shadowCopy.clear();
+    m_hasContents = false;
+}
+
+bool UniformBuffer::Update(const void* data, GLsizeiptr size)
+{
+    if (m_buffer == 0 || data == nullptr || size <= 0)
+    {
+        return false;
+    }
+
+    const std::size_t byteCount = static_cast<std::size_t>(size);
+    if (byteCount > m_shadowCopy.size())
+    {
+        std::cerr << "Uniform buffer menor que o bloco enviado (" << byteCount << " > "
+                  << m_shadowCopy.size() << " bytes)." << std::endl;
+        return false;
+    }
+
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    std::size_t first = 0;
+    std::size_t last = byteCount;
+    if (m_hasContents)
+    {
+        while (first < byteCount && bytes[first] == m_shadowCopy[first])
+        {
+            ++first;
+        }
+        if (first == byteCount)
+        {
+            return false;
+        }
+        while (last > first && bytes[last - 1] == m_shadowCopy[last - 1])
+        {
+            --last;
+        }
+    }
+
+    std::memcpy(m_shadowCopy.data() + first, bytes + first, last - first);
+    RenderStateCache::Get().BindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+    glBufferSubData(GL_UNIFORM_BUFFER,
+                    static_cast<GLintptr>(first),
+                    static_cast<GLsizeiptr>(last - first),
+                    bytes + first);
+    m_hasContents = true;
+    ++m_uploadCount;
+    return true;
+}
+
+void UniformBuffer::Bind() const
+{
+    if (m_buffer != 0)
+    {
+        RenderStateCache::Get().BindBufferBase(GL_UNIFORM_BUFFER, m_binding, m_buffer);
+    }
+}
+
+bool UniformBuffer::BindBlock(GLuint program, const char* blockName, UniformBlockBinding binding)
+{
+    if (program == 0 || blockName == nullptr)
+    {
+        return false;
+    }
+
+    const GLuint blockIndex = glGetUniformBlockIndex(program, blockName);
+    if (blockIndex == GL_INVALID_INDEX)
+    {
+        return false;
+    }
+    glUniformBlockBinding(program, blockIndex, static_cast<GLuint>(binding));
+    return true;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <vector>
+
+/// @brief Pontos de binding fixos dos uniform blocks std140 compartilhados pelos shaders.
+enum class UniformBlockBinding : GLuint
+{
+    Frame = 0,
+    Lights = 1,
+    Material = 2,
+    PointShadow = 3
+};
+
+/// @brief Uniform Buffer Object std140 com cópia espelhada na CPU.
+/// Update compara com o último conteúdo enviado e só chama o driver para o intervalo que mudou.
+class UniformBuffer
+{
+public:
+    UniformBuffer() = default;
+    ~UniformBuffer();
+
+    UniformBuffer(const UniformBuffer&) = delete;
+    UniformBuffer& operator=(const UniformBuffer&) = delete;
+
+    bool Create(GLsizeiptr size, UniformBlockBinding binding);
+    void Destroy();
+
+    /// @brief Atualiza o conteúdo do buffer. Retorna true se algo foi enviado à GPU.
+    bool Update(const void* data, GLsizeiptr size);
+
+    /// @brief Vincula o buffer ao seu ponto de binding (glBindBufferBase).
+    void Bind() const;
+
+    bool IsValid() const { return m_buffer != 0; }
+    GLuint GetID() const { return m_buffer; }
+    std::size_t GetUploadCount() const { return m_uploadCount; }
+
+    /// @brief Associa o uniform block do programa ao ponto de binding. Blocos ausentes são ignorados.
+    static bool BindBlock(GLuint program, const char* blockName, UniformBlockBinding binding);
+
+private:
+    GLuint m_buffer = 0;
+    GLuint m_binding = 0;
+    std::vector<unsigned char> m_shadowCopy;
+    bool m_hasContents = false;
+    std::size_t m_uploadCount = 0;
+};
@@ -0,0 +1,153 @@
+#include "vertex_format.h"
+
+#include <glm/gtc/packing.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+// Limites de aceitação: meio texel a 512px nas UVs e ~2 graus nas normais. A posição SNORM16 erra no máximo
+// 1/65534 da AABB do mesh e nunca reprova.
+constexpr float kMaxTexCoordError = 1.0f / 1024.0f;
+constexpr float kMaxNormalErrorDegrees = 2.0f;
+
+constexpr float kSnorm16Max = 32767.0f;
+constexpr float kSnorm10Max = 511.0f;
+
+// Conversão SNORM do GL 4.2+ (c / (2^(b-1) - 1), limitada a -1); a regra antiga do 3.3 difere em meio passo.
+std::int16_t EncodeSnorm16(float value)
+{
+    return static_cast<std::int16_t>(std::lround(glm::clamp(value, -1.0f, 1.0f) * kSnorm16Max));
+}
+
+float DecodeSnorm16(std::int16_t value)
+{
+    return std::max(static_cast<float>(value) / kSnorm16Max, -1.0f);
+}
+
+std::uint32_t PackSnorm10(int value)
+{
+    return static_cast<std::uint32_t>(value) & 0x3FFu;
+}
+
+glm::vec2 SignNotZero(const glm::vec2& value)
+{
+    return glm::vec2(value.x >= 0.0f ? 1.0f : -1.0f, value.y >= 0.0f ? 1.0f : -1.0f);
+}
+
+glm::vec2 OctahedralEncode(const glm::vec3& normal)
+{
+    const glm::vec3 n = normal / (std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z));
+    glm::vec2 encoded(n.x, n.y);
+    if (n.z < 0.0f)
+    {
+        encoded = (glm::vec2(1.0f) - glm::abs(glm::vec2(encoded.y, encoded.x))) * SignNotZero(encoded);
+    }
+    return encoded;
+}
+
+// Mesma expressão do DecodeNormal dos shaders.
+glm::vec3 OctahedralDecode(const glm::vec2& encoded)
+{
+    glm::vec3 n(encoded.x, encoded.y, 1.0f - std::abs(encoded.x) - std::abs(encoded.y));
+    const float t = std::max(-n.z, 0.0f);
+    n.x += n.x >= 0.0f ? -t : t;
+    n.y += n.y >= 0.0f ? -t : t;
+    return glm::normalize(n);
+}
+
+// Entre os quatro arredondamentos vizinhos em 10 bits, o de menor erro angular.
+std::uint32_t PackNormal(const glm::vec3& normal, float& errorDegrees)
+{
+    const float length = glm::length(normal);
+    const glm::vec3 unit = length > 0.0f ? normal / length : glm::vec3(0.0f, 0.0f, 1.0f);
+    const glm::vec2 scaled = OctahedralEncode(unit) * kSnorm10Max;
+
+    float bestCosine = -2.0f;
+    int bestX = 0;
+    int bestY = 0;
+    for (int candidate = 0; candidate < 4; ++candidate)
+    {
+        const int x = static_cast<int>((candidate & 1) != 0 ? std::ceil(scaled.x) : std::floor(scaled.x));
+        const int y = static_cast<int>((candidate & 2) != 0 ? std::ceil(scaled.y) : std::floor(scaled.y));
+        const glm::vec2 decoded(std::max(static_cast<float>(x) / kSnorm10Max, -1.0f),
+                                std::max(static_cast<float>(y) / kSnorm10Max, -1.0f));
+        const float cosine = glm::dot(OctahedralDecode(decoded), unit);
+        if (cosine > bestCosine)
+        {
+            bestCosine = cosine;
+            bestX = x;
+            bestY = y;
+        }
+    }
+    errorDegrees = glm::degrees(std::acos(glm::clamp(bestCosine, -1.0f, 1.0f)));
+    return PackSnorm10(bestX) | (PackSnorm10(bestY) << 10);
+}
+}
+
+QuantizedVertices QuantizeVertices(const std::vector<Vertex>& vertices, VertexQuantizationError& error)
+{
+    error = {};
+    QuantizedVertices quantized;
+    if (vertices.empty())
+    {
+        return quantized;
+    }
+
+    glm::vec3 minimum(std::numeric_limits<float>::max());
+    glm::vec3 maximum(std::numeric_limits<float>::lowest());
+    for (const Vertex& vertex : vertices)
+    {
+        minimum = glm::min(minimum, vertex.position);
+        maximum = glm::max(maximum, vertex.position);
+    }
+    const glm::vec3 center = (minimum + maximum) * 0.5f;
+    glm::vec3 halfExtents = (maximum - minimum) * 0.5f;
+    // Eixo degenerado (mesh plano): qualquer escala reproduz o centro exatamente.
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        if (halfExtents[axis] <= 0.0f)
+        {
+            halfExtents[axis] = 1.0f;
+        }
+    }
+    quantized.decode.positionScale = glm::vec4(halfExtents, 1.0f);
+    quantized.decode.positionBias = center;
+
+    quantized.vertices.resize(vertices.size());
+    quantized.positions.resize(vertices.size());
+    for (std::size_t i = 0; i < vertices.size(); ++i)
+    {
+        const Vertex& source = vertices[i];
+        PackedVertex& packed = quantized.vertices[i];
+
+        const glm::vec3 normalized = (source.position - center) / halfExtents;
+        glm::vec3 decodedPosition;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            packed.position[axis] = EncodeSnorm16(normalized[axis]);
+            decodedPosition[axis] = DecodeSnorm16(packed.position[axis]) * halfExtents[axis] + center[axis];
+        }
+        std::copy(std::begin(packed.position), std::end(packed.position), quantized.positions[i].position);
+        error.position = std::max(error.position, glm::length(decodedPosition - source.position));
+
+        float normalError = 0.0f;
+        packed.normal = PackNormal(source.normal, normalError);
+        error.normalDegrees = std::max(error.normalDegrees, normalError);
+
+        for (int component = 0; component < 2; ++component)
+        {
+            packed.texCoords[component] = glm::packHalf1x16(source.texCoords[component]);
+            const float decoded = glm::unpackHalf1x16(packed.texCoords[component]);
+            error.texCoord = std::max(error.texCoord, std::abs(decoded - source.texCoords[component]));
+        }
+    }
+    return quantized;
+}
+
+bool IsQuantizationAcceptable(const VertexQuantizationError& error)
+{
+    return error.texCoord <= kMaxTexCoordError && error.normalDegrees <= kMaxNormalErrorDegrees;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct Vertex
+{
+    glm::vec3 position{ 0.0f };
+    glm::vec3 normal{ 0.0f };
+    glm::vec2 texCoords{ 0.0f };
+};
+
+/// @brief Formatos de vértice do pool de geometria; cada um tem os seus buffers e VAOs.
+enum class VertexFormat
+{
+    Float,     ///< Vertex: 32 bytes de floats (posições de depth em 12 bytes).
+    Quantized, ///< PackedVertex: 16 bytes (posições de depth em 8 bytes).
+};
+
+constexpr std::size_t kVertexFormatCount = 2;
+
+/// @brief Vértice quantizado: posição SNORM16 relativa à AABB do mesh, normal octaédrica em
+/// GL_INT_2_10_10_10_REV (x, y) e UV em half float.
+struct PackedVertex
+{
+    std::int16_t position[4] = { 0, 0, 0, 0 }; ///< w só alinha a 8 bytes.
+    std::uint32_t normal = 0;
+    std::uint16_t texCoords[2] = { 0, 0 };
+};
+
+static_assert(sizeof(PackedVertex) == 16, "PackedVertex deve ocupar 16 bytes");
+
+/// @brief Posição quantizada do stream de depth (mesmo SNORM16 de PackedVertex).
+struct PackedPosition
+{
+    std::int16_t position[4] = { 0, 0, 0, 0 };
+};
+
+/// @brief Decodificação por mesh que o vertex shader aplica: posição = aPos * scale + bias.
+/// positionScale.w = 1 indica normal octaédrica. O padrão é a identidade do formato float.
+struct VertexDecode
+{
+    glm::vec4 positionScale{ 1.0f, 1.0f, 1.0f, 0.0f };
+    glm::vec3 positionBias{ 0.0f };
+
+    bool operator==(const VertexDecode& other) const
+    {
+        return positionScale == other.positionScale && positionBias == other.positionBias;
+    }
+    bool operator!=(const VertexDecode& other) const { return !(*this == other); }
+};
+
+struct QuantizedVertices
+{
+    std::vector<PackedVertex> vertices;
+    std::vector<PackedPosition> positions;
+    VertexDecode decode;
+};
+
+/// @brief Pior erro medido decodificando os vértices quantizados como o shader faz.
+struct VertexQuantizationError
+{
+    float position = 0.0f;      ///< Distância em unidades do modelo.
+    float normalDegrees = 0.0f; ///< Ângulo entre a normal original e a decodificada.
+    float texCoord = 0.0f;      ///< Diferença absoluta por componente de UV.
+};
+
+/// @brief Quantiza os vértices de um mesh e mede o erro introduzido.
+QuantizedVertices QuantizeVertices(const std::vector<Vertex>& vertices, VertexQuantizationError& error);
+
+/// @brief false se o erro passa dos limites aceitos (UVs muito repetidas perdem precisão em half float);
+/// o mesh então fica no formato float.
+bool IsQuantizationAcceptable(const VertexQuantizationError& error);
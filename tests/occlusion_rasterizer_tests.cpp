@@ -0,0 +1,128 @@
+#include "occlusion_rasterizer.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cstdio>
+
+// Testes de comportamento do OcclusionDepthBuffer, sem GL. Câmera na origem olhando para -Z.
+
+namespace
+{
+int g_failures = 0;
+
+void Check(bool condition, const char* test, const char* what)
+{
+    if (!condition)
+    {
+        std::printf("FALHOU %s: %s\n", test, what);
+        ++g_failures;
+    }
+}
+
+glm::mat4 MakeViewProjection()
+{
+    const glm::mat4 projection = glm::perspective(glm::radians(60.0f), 2.0f, 0.1f, 100.0f);
+    const glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    return projection * view;
+}
+
+const glm::mat4 kIdentity(1.0f);
+
+/// Parede larga em z = -5 que cobre o centro da tela.
+void RasterizeWall(OcclusionDepthBuffer& buffer)
+{
+    buffer.RasterizeBox(kIdentity, glm::vec3(0.0f, 0.0f, -5.0f), glm::vec3(3.0f, 3.0f, 0.1f));
+}
+
+bool IsCleared(const OcclusionDepthBuffer& buffer)
+{
+    for (int y = 0; y < OcclusionDepthBuffer::kHeight; ++y)
+    {
+        for (int x = 0; x < OcclusionDepthBuffer::kWidth; ++x)
+        {
+            if (buffer.GetDepth(x, y) != 1.0f)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void TestClear()
+{
+    OcclusionDepthBuffer buffer;
+    Check(IsCleared(buffer), "Clear", "buffer novo deveria estar no far");
+
+    buffer.Clear(MakeViewProjection());
+    RasterizeWall(buffer);
+    Check(!IsCleared(buffer), "Clear", "a parede deveria escrever depth");
+    Check(buffer.GetTriangleCount() > 0, "Clear", "a parede deveria contar triângulos");
+
+    buffer.Clear(MakeViewProjection());
+    Check(IsCleared(buffer), "Clear", "Clear deveria voltar tudo para 1");
+    Check(buffer.GetTriangleCount() == 0, "Clear", "Clear deveria zerar os triângulos");
+}
+
+void TestOccludedBox()
+{
+    OcclusionDepthBuffer buffer;
+    buffer.Clear(MakeViewProjection());
+    RasterizeWall(buffer);
+    Check(!buffer.IsBoxVisible(kIdentity, glm::vec3(0.0f, 0.0f, -10.0f), glm::vec3(0.5f)),
+          "OccludedBox", "caixa atrás da parede deveria ser oculta");
+
+    // O transform também vale para a caixa testada.
+    const glm::mat4 transform = glm::translate(kIdentity, glm::vec3(0.5f, -0.5f, -12.0f));
+    Check(!buffer.IsBoxVisible(transform, glm::vec3(0.0f), glm::vec3(0.5f)),
+          "OccludedBox", "caixa transformada atrás da parede deveria ser oculta");
+}
+
+void TestVisibleBox()
+{
+    OcclusionDepthBuffer buffer;
+    buffer.Clear(MakeViewProjection());
+    Check(buffer.IsBoxVisible(kIdentity, glm::vec3(0.0f, 0.0f, -10.0f), glm::vec3(0.5f)),
+          "VisibleBox", "sem oclusoras tudo é visível");
+
+    RasterizeWall(buffer);
+    Check(buffer.IsBoxVisible(kIdentity, glm::vec3(0.0f, 0.0f, -3.0f), glm::vec3(0.5f)),
+          "VisibleBox", "caixa na frente da parede deveria ser visível");
+    Check(buffer.IsBoxVisible(kIdentity, glm::vec3(7.0f, 0.0f, -10.0f), glm::vec3(1.0f)),
+          "VisibleBox", "caixa que passa da borda da parede deveria ser visível");
+    Check(buffer.IsBoxVisible(kIdentity, glm::vec3(0.0f, 0.0f, 10.0f), glm::vec3(0.5f)),
+          "VisibleBox", "caixa atrás da câmera fica para o frustum");
+}
+
+void TestNearPlaneCrossing()
+{
+    OcclusionDepthBuffer buffer;
+    buffer.Clear(MakeViewProjection());
+    RasterizeWall(buffer);
+    Check(buffer.IsBoxVisible(kIdentity, glm::vec3(0.0f, 0.0f, -0.05f), glm::vec3(0.5f)),
+          "NearPlane", "caixa cruzando o near plane deveria ser visível");
+
+    // Oclusora cruzando o near plane é recortada, não descartada: ainda esconde o que está atrás.
+    buffer.Clear(MakeViewProjection());
+    buffer.RasterizeBox(kIdentity, glm::vec3(0.0f, 0.0f, -2.0f), glm::vec3(50.0f, 50.0f, 2.5f));
+    Check(buffer.GetTriangleCount() > 0, "NearPlane", "oclusora recortada deveria gerar triângulos");
+    Check(!buffer.IsBoxVisible(kIdentity, glm::vec3(0.0f, 0.0f, -10.0f), glm::vec3(0.5f)),
+          "NearPlane", "caixa atrás de oclusora recortada deveria ser oculta");
+}
+}
+
+int main()
+{
+    TestClear();
+    TestOccludedBox();
+    TestVisibleBox();
+    TestNearPlaneCrossing();
+
+    if (g_failures != 0)
+    {
+        std::printf("%d verificações falharam\n", g_failures);
+        return 1;
+    }
+    std::printf("Todos os testes de oclusão passaram\n");
+    return 0;
+}